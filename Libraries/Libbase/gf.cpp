@@ -27,10 +27,33 @@
 #include <cstdlib>
 #include <string>
 
+// Vector multiply-add is compiled for SSSE3 regardless of the compiler flags
+// where the compiler allows per-function targets, and selected at run-time
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) \
+   && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define GF_SSSE3 __attribute__((target("ssse3")))
+#  define GF_SSSE3_DISPATCH
+#  include <tmmintrin.h>
+#elif defined(__SSSE3__)
+#  define GF_SSSE3
+#  include <tmmintrin.h>
+#endif
+
 namespace libbase {
 
 using std::cerr;
 
+// Static members
+
+template <int m, int poly>
+int *gf<m, poly>::log_lut;
+template <int m, int poly>
+int *gf<m, poly>::pow_lut;
+template <int m, int poly>
+bool gf<m, poly>::lutready = false;
+template <int m, int poly>
+bool gf<m, poly>::simd = true;
+
 // Internal functions
 
 /*!
@@ -66,11 +89,10 @@ gf<m, poly>::operator std::string() const
    return sTemp;
    }
 
-// Arithmetic operations
+// Arithmetic tables
 
 /*!
- * \brief Multiplication
- * \param   x  Field element we want to multiply to this one (ie. multiplicand).
+ * \brief Polynomial multiplication of two field elements
  * 
  * Multiplication within extensions of a field is the multiplication of the polynomials
  * representing the two values. This can be done by the usual long-multiplication
@@ -80,13 +102,13 @@ gf<m, poly>::operator std::string() const
  * [cf. Gladman, "A Specification for Rijndael, the AES Algorithm", 2003, pp.3-4]
  */
 template <int m, int poly>
-gf<m, poly>& gf<m, poly>::operator*=(const gf<m, poly>& x)
+int gf<m, poly>::multiply_serial(int a, int b)
    {
    // Copy the multiplier (A) and multiplicand (B)
-   int32u A = value;
-   int32u B = x.value;
+   int32u A = a;
+   int32u B = b;
    // Initialize result
-   value = 0;
+   int32u value = 0;
    // Loop over all bits in multiplicand
    for (int i = 0; i < m && B != 0; i++)
       {
@@ -101,30 +123,198 @@ gf<m, poly>& gf<m, poly>::operator*=(const gf<m, poly>& x)
       if (A & (1 << m))
          A ^= poly;
       }
-   return *this;
+   return value;
+   }
+
+/*!
+ * \brief Set up logarithm and anti-logarithm tables
+ * 
+ * The base used is the smallest generator of the multiplicative group; this
+ * is the element {2} when the modular polynomial is primitive, but not
+ * otherwise (e.g. for the Rijndael field, where the base is {3}).
+ */
+template <int m, int poly>
+void gf<m, poly>::buildlut()
+   {
+   const int q = elements();
+   // find a generator
+   int g = (q > 2) ? 2 : 1;
+   for (;; g++)
+      {
+      assertalways(g < q);
+      int order = 1;
+      for (int x = g; x != 1; x = multiply_serial(x, g))
+         order++;
+      if (order == q - 1)
+         break;
+      }
+   // fill tables
+   int *logs = new int[q];
+   int *pows = new int[2 * q];
+   logs[0] = 0;
+   int x = 1;
+   for (int i = 0; i < q - 1; i++)
+      {
+      pows[i] = pows[i + q - 1] = x;
+      logs[x] = i;
+      x = multiply_serial(x, g);
+      }
+   log_lut = logs;
+   pow_lut = pows;
+   lutready = true;
    }
 
+// Arithmetic operations
+
 /*!
  * \brief Multiplicative inverse
  * 
  * The multiplicative inverse \f$ b^{-1} \f$ of \f$ b \f$ is such that:
  * \f[ b^{-1} a = 1 \f]
  * 
- * In this implementation, we use the brute force search method.
+ * In this implementation, we negate the logarithm of \f$ b \f$.
  */
 template <int m, int poly>
 gf<m, poly> gf<m, poly>::inverse() const
    {
-   gf<m, poly> I = 1;
-   gf<m, poly> r = 1;
-   for (int i = 1; i < elements(); i++)
+   assert(value != 0);
+   return gf<m, poly> (pow_lut[elements() - 1 - log_lut[value]]);
+   }
+
+// Bulk operations
+
+#ifdef GF_SSSE3
+
+/*!
+ * \brief Vector multiply and accumulate, for fields up to \f$ GF(2^8) \f$
+ * \param   y  Accumulator elements
+ * \param   x  Multiplicand elements
+ * \param   n  Number of elements
+ * \param   lo Products of the multiplier with each low nibble value
+ * \param   hi Products of the multiplier with each high nibble value
+ * \return  Number of elements processed (a multiple of sixteen)
+ *
+ * Since multiplication distributes over addition, the product is the sum of
+ * the products of the low and high nibbles, each of which is read from a
+ * 16-entry table with a byte shuffle.
+ */
+GF_SSSE3 static int multiply_add_ssse3(int32u *y, const int32u *x,
+      const int n, const int8u *lo, const int8u *hi)
+   {
+   const __m128i tlo = _mm_loadu_si128((const __m128i *) lo);
+   const __m128i thi = _mm_loadu_si128((const __m128i *) hi);
+   const __m128i mask = _mm_set1_epi8(0x0f);
+   const __m128i zero = _mm_setzero_si128();
+   int k = 0;
+   for (; k + 16 <= n; k += 16)
       {
-      if (r * *this == I)
-         break;
-      r *= 2;
+      // pack sixteen elements into bytes
+      const __m128i *px = (const __m128i *) (x + k);
+      const __m128i b = _mm_packus_epi16(_mm_packs_epi32(_mm_loadu_si128(px),
+            _mm_loadu_si128(px + 1)), _mm_packs_epi32(_mm_loadu_si128(px + 2),
+            _mm_loadu_si128(px + 3)));
+      // look up products for each nibble
+      const __m128i p = _mm_xor_si128(_mm_shuffle_epi8(tlo, _mm_and_si128(b,
+            mask)), _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(b, 4),
+            mask)));
+      // unpack and accumulate
+      const __m128i plo = _mm_unpacklo_epi8(p, zero);
+      const __m128i phi = _mm_unpackhi_epi8(p, zero);
+      __m128i *py = (__m128i *) (y + k);
+      _mm_storeu_si128(py, _mm_xor_si128(_mm_loadu_si128(py),
+            _mm_unpacklo_epi16(plo, zero)));
+      _mm_storeu_si128(py + 1, _mm_xor_si128(_mm_loadu_si128(py + 1),
+            _mm_unpackhi_epi16(plo, zero)));
+      _mm_storeu_si128(py + 2, _mm_xor_si128(_mm_loadu_si128(py + 2),
+            _mm_unpacklo_epi16(phi, zero)));
+      _mm_storeu_si128(py + 3, _mm_xor_si128(_mm_loadu_si128(py + 3),
+            _mm_unpackhi_epi16(phi, zero)));
       }
-   assert(r * *this == I);
-   return r;
+   return k;
+   }
+
+#endif
+
+/*!
+ * \brief Check whether bulk operations can use vector instructions
+ *
+ * This is true for fields up to \f$ GF(2^8) \f$, when the SSSE3 code path
+ * is compiled in and (where selected at run-time) the processor supports it.
+ */
+template <int m, int poly>
+bool gf<m, poly>::simd_supported()
+   {
+#if defined(GF_SSSE3_DISPATCH)
+   return m <= 8 && __builtin_cpu_supports("ssse3");
+#elif defined(GF_SSSE3)
+   return m <= 8;
+#else
+   return false;
+#endif
+   }
+
+/*!
+ * \brief Multiply and accumulate: \f$ y_k = y_k + a x_k \f$ for \f$ k < n \f$
+ * 
+ * Where supported (see simd_supported()) and enabled (see set_simd()),
+ * sixteen elements are multiplied at once using split-nibble table lookup;
+ * any remaining elements use the logarithm tables.
+ */
+template <int m, int poly>
+void gf<m, poly>::multiply_add(gf *y, const gf& a, const gf *x, const int n)
+   {
+   if (a.value == 0)
+      return;
+   const int la = log_lut[a.value];
+   int k = 0;
+#ifdef GF_SSSE3
+   if (simd && n >= 16 && simd_supported())
+      {
+      assert(sizeof(gf) == sizeof(int32u));
+      // tables of products with each nibble value
+      int8u lo[16], hi[16];
+      lo[0] = hi[0] = 0;
+      for (int i = 1; i < 16; i++)
+         {
+         lo[i] = (i < elements()) ? int8u(pow_lut[la + log_lut[i]]) : 0;
+         hi[i] = ((i << 4) < elements()) ? int8u(pow_lut[la + log_lut[i
+               << 4]]) : 0;
+         }
+      k = multiply_add_ssse3(reinterpret_cast<int32u *> (y),
+            reinterpret_cast<const int32u *> (x), n, lo, hi);
+      }
+#endif
+   for (; k < n; k++)
+      if (x[k].value != 0)
+         y[k].value ^= pow_lut[la + log_lut[x[k].value]];
+   }
+
+/*!
+ * \brief Element-wise product: \f$ y_k = y_k x_k \f$ for \f$ k < n \f$
+ */
+template <int m, int poly>
+void gf<m, poly>::multiply(gf *y, const gf *x, const int n)
+   {
+   for (int k = 0; k < n; k++)
+      {
+      if (y[k].value != 0 && x[k].value != 0)
+         y[k].value = pow_lut[log_lut[y[k].value] + log_lut[x[k].value]];
+      else
+         y[k].value = 0;
+      }
+   }
+
+/*!
+ * \brief Inner product: \f$ \sum_{k < n} a_k b_k \f$
+ */
+template <int m, int poly>
+gf<m, poly> gf<m, poly>::dot(const gf *a, const gf *b, const int n)
+   {
+   int result = 0;
+   for (int k = 0; k < n; k++)
+      if (a[k].value != 0 && b[k].value != 0)
+         result ^= pow_lut[log_lut[a[k].value] + log_lut[b[k].value]];
+   return gf<m, poly> (result);
    }
 
 // Explicit Realizations
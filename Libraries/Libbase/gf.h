@@ -55,8 +55,15 @@ namespace libbase {
  * For example:
  * \f[ x^6 + x^4 + x^2 + x^1 + 1 = \{ 01010111 \}_2 = \{ 57 \}_16 = \{ 87 \}_10 \f]
  *
+ * Multiplication and inversion use logarithm and anti-logarithm tables,
+ * built when the first element is created, with respect to a generator of
+ * the multiplicative group (the element {2} where \c poly is primitive).
+ * Bulk operations over arrays of field elements are also provided; for fields
+ * up to \f$ GF(2^8) \f$, on processors with SSSE3, multiplication by a
+ * constant uses split-nibble table lookup on sixteen elements at a time.
+ *
  * \warning Due to the internal representation, this class is limited to
- * \f$ GF(2^31) \f$.
+ * \f$ GF(2^31) \f$; the tables further limit practical use to small fields.
  */
 
 template <int m, int poly>
@@ -82,6 +89,18 @@ private:
    int value;
    // @}
 
+   /*! \name Arithmetic tables */
+   static int *log_lut; //!< Logarithm of each non-zero element
+   static int *pow_lut; //!< Element for each power, over two periods
+   static bool lutready;
+   static void buildlut();
+   static int multiply_serial(int a, int b);
+   // @}
+
+   /*! \name Bulk operation settings */
+   static bool simd; //!< Flag to use vector instructions where supported
+   // @}
+
    /*! \name Internal functions */
    /*!
     * \brief Initialization
@@ -103,10 +122,14 @@ public:
    //! Principal constructor
    gf(int value = 0)
       {
+      if (!lutready)
+         buildlut();
       init(value);
       }
    gf(const char *s)
       {
+      if (!lutready)
+         buildlut();
       init(s);
       }
    // @}
@@ -166,8 +189,39 @@ public:
    gf inverse() const;
    // @}
 
+   /*! \name Bulk operations */
+   static void multiply_add(gf *y, const gf& a, const gf *x, const int n);
+   static void multiply(gf *y, const gf *x, const int n);
+   static gf dot(const gf *a, const gf *b, const int n);
+   static bool simd_supported();
+   //! Enable or disable use of vector instructions in bulk operations
+   static void set_simd(bool flag)
+      {
+      simd = flag;
+      }
+   // @}
+
 };
 
+/*!
+ * \brief Multiplication
+ * \param   x  Field element we want to multiply to this one (ie. multiplicand).
+ *
+ * The product of two non-zero elements is obtained by adding their
+ * logarithms; the table of powers covers two periods, so no modulo is
+ * needed. There is no need to check that the tables are ready, since they
+ * are built when the first element is created.
+ */
+template <int m, int poly>
+inline gf<m, poly>& gf<m, poly>::operator*=(const gf<m, poly>& x)
+   {
+   if (value != 0 && x.value != 0)
+      value = pow_lut[log_lut[value] + log_lut[x.value]];
+   else
+      value = 0;
+   return *this;
+   }
+
 /*! \name Arithmetic operations */
 
 template <int m, int poly>
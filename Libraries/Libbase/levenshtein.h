@@ -28,6 +28,8 @@
 #include "config.h"
 #include "vector.h"
 #include "matrix.h"
+#include <vector>
+#include <algorithm>
 
 namespace libbase {
 
@@ -75,6 +77,148 @@ int levenshtein(const vector<T>& s, const vector<T>& t)
    return d(m, n);
    }
 
+/*!
+ * \brief   Bit-Parallel Levenshtein Distance
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Computes the same distance as levenshtein(), using the bit-vector algorithm
+ * of Myers (J. ACM, 1999) in the formulation of Hyyro for edit distance. Each
+ * column of the table is held as vertical differences, packed 64 rows to a
+ * word, and is updated a word at a time. Templatized for any type for which
+ * equality and ordering are defined.
+ *
+ * An optional bound k restricts the computation to the diagonal band
+ * |i-j| <= k; words that lie entirely outside the band are not updated. The
+ * result is exact if the distance does not exceed k, and greater than k
+ * otherwise. For sequences of equal length the Hamming distance is such a
+ * bound.
+ *
+ * Working space is kept between calls, so that repeated use with blocks of
+ * the same size does not allocate memory. Objects of this class must not be
+ * shared between threads.
+ */
+
+template <class T>
+class levenshtein_bitparallel {
+private:
+   typedef int64u word;
+   static const int bits = 64;
+private:
+   /*! \name Working space */
+   std::vector<T> symbols; //!< Distinct symbols in first sequence, sorted
+   std::vector<word> peq; //!< Match vectors for each symbol (and no match)
+   std::vector<word> P; //!< Positive vertical differences
+   std::vector<word> M; //!< Negative vertical differences
+   std::vector<int> score; //!< Value at bottom row of each word
+   // @}
+private:
+   /*! \brief Update one word of the column for the next text symbol
+    * \param[in,out] Pv   Positive vertical differences
+    * \param[in,out] Mv   Negative vertical differences
+    * \param[in]     Eq   Match vector for the text symbol
+    * \param[in]     high Mask for the last row in this word
+    * \param[in]     hin  Horizontal difference at the row above this word
+    * \return Horizontal difference at the last row in this word
+    */
+   static int advance(word& Pv, word& Mv, word Eq, const word high,
+         const int hin)
+      {
+      const word Xv = Eq | Mv;
+      if (hin < 0)
+         Eq |= 1;
+      const word Xh = (((Eq & Pv) + Pv) ^ Pv) | Eq;
+      word Ph = Mv | ~(Xh | Pv);
+      word Mh = Pv & Xh;
+      int hout = 0;
+      if (Ph & high)
+         hout = 1;
+      else if (Mh & high)
+         hout = -1;
+      Ph <<= 1;
+      Mh <<= 1;
+      if (hin < 0)
+         Mh |= 1;
+      else if (hin > 0)
+         Ph |= 1;
+      Pv = Mh | ~(Xv | Ph);
+      Mv = Ph & Xv;
+      return hout;
+      }
+public:
+   /*! \brief Compute distance between sequences
+    * \param s First sequence
+    * \param t Second sequence
+    * \param k Bound on the distance (negative for none)
+    */
+   int distance(const vector<T>& s, const vector<T>& t, int k = -1)
+      {
+      const int m = s.size();
+      const int n = t.size();
+      if (m == 0)
+         return n;
+      if (n == 0)
+         return m;
+      if (k < 0 || k > std::max(m, n))
+         k = std::max(m, n);
+      assert(abs(m - n) <= k);
+      const int W = (m + bits - 1) / bits;
+      // set up symbol classes, with the last entry for symbols not in s
+      symbols.assign(&s(0), &s(0) + m);
+      std::sort(symbols.begin(), symbols.end());
+      symbols.erase(std::unique(symbols.begin(), symbols.end()),
+            symbols.end());
+      const int q = symbols.size();
+      peq.assign((q + 1) * W, 0);
+      for (int i = 0; i < m; i++)
+         {
+         const int c = int(std::lower_bound(symbols.begin(), symbols.end(),
+               s(i)) - symbols.begin());
+         peq[c * W + i / bits] |= word(1) << (i % bits);
+         }
+      P.assign(W, ~word(0));
+      M.assign(W, 0);
+      score.assign(W, 0);
+      // mask for last row in last word
+      const word lasthigh = word(1) << ((m - 1) % bits);
+      // words [first,last] are within the band for the current column
+      int first = 0;
+      int last = -1;
+      for (int j = 1; j <= n; j++)
+         {
+         // bring in words whose top row enters the band
+         while (last + 1 < W && bits * (last + 1) + 1 <= j + k)
+            {
+            last++;
+            score[last] = (last > 0 ? score[last - 1] : 0) + std::min(bits, m
+                  - bits * last);
+            }
+         // drop words whose bottom row has left the band
+         while (first < last && bits * (first + 1) < j - k)
+            first++;
+         // determine match vectors for this text symbol
+         const typename std::vector<T>::iterator it = std::lower_bound(
+               symbols.begin(), symbols.end(), t(j - 1));
+         const int c = (it != symbols.end() && *it == t(j - 1)) ? int(it
+               - symbols.begin()) : q;
+         const word *Eq = &peq[c * W];
+         // update the column; above the band, values increase by one
+         int h = 1;
+         for (int w = first; w <= last; w++)
+            {
+            const word high = (w == W - 1) ? lasthigh : word(1) << (bits - 1);
+            h = advance(P[w], M[w], Eq[w], high, h);
+            score[w] += h;
+            }
+         }
+      return score[W - 1];
+      }
+};
+
 } // end namespace
 
 #endif /* LEVENSHTEIN_H_ */
@@ -276,15 +276,18 @@ template <class GF_q, class real> void linear_code_utils<GF_q, real>::encode_cw(
 
    assertalways(dim_k == source.size().length());
 
+   //accumulate the rows of the generator matrix, weighted by the source
+   array1gfq_t val;
+   val.init(length_n);
+   val = GF_q(0);
+   for (int j = 0; j < dim_k; j++)
+      {
+      GF_q::multiply_add(&val(0), GF_q(source(j)), mat_G.row(j), length_n);
+      }
    encoded.init(length_n);
    for (int i = 0; i < length_n; i++)
       {
-      GF_q val = GF_q(0);
-      for (int j = 0; j < dim_k; j++)
-         {
-         val += GF_q(source(j)) * mat_G(j, i);
-         }
-      encoded(i) = val;
+      encoded(i) = val(i);
       }
 #if DEBUG>=2
    libbase::trace << std::endl << "finished encoding";
@@ -307,11 +310,7 @@ template <class GF_q, class real> bool linear_code_utils<GF_q, real>::compute_sy
 
    for (int rows = 0; rows < dim_m; rows++)
       {
-      tmp_val = GF_q(0);
-      for (int cols = 0; cols < length_n; cols++)
-         {
-         tmp_val += parMat(rows, cols) * received_word_hd(cols);
-         }
+      tmp_val = GF_q::dot(parMat.row(rows), &received_word_hd(0), length_n);
       if (tmp_val != GF_q(0))
          {
          //the syndrome is non-zero
@@ -462,16 +461,23 @@ template <class GF_q, class real> void linear_code_utils<GF_q, real>::compute_kr
 }
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 
 namespace libbase {
 using libbase::mpreal;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 template class linear_code_utils<gf<1, 0x3> > ;
+template class linear_code_utils<gf<1, 0x3> , logfixed16> ;
+template class linear_code_utils<gf<1, 0x3> , logfixed8> ;
 template class linear_code_utils<gf<2, 0x7> > ;
 template class linear_code_utils<gf<3, 0xB> > ;
 template class linear_code_utils<gf<3, 0xB> , mpreal> ;
 template class linear_code_utils<gf<4, 0x13> > ;
 template class linear_code_utils<gf<4, 0x13> , mpreal> ;
+template class linear_code_utils<gf<4, 0x13> , logfixed16> ;
+template class linear_code_utils<gf<4, 0x13> , logfixed8> ;
 template class linear_code_utils<gf<5, 0x25> > ;
 template class linear_code_utils<gf<6, 0x43> > ;
 template class linear_code_utils<gf<7, 0x89> > ;
@@ -0,0 +1,88 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "logfixed.h"
+#include <algorithm>
+
+namespace libbase {
+
+template <class T, int F>
+const typename logfixed<T, F>::tables logfixed<T, F>::lut;
+
+// LUT constructor
+
+/*!
+ * The correction tables cover differences up to 16 nats, beyond which both
+ * corrections are below the resolution of any realization in use. Entries
+ * for same-sign addition are negative, since the result magnitude increases.
+ *
+ * The exponential tables are indexed by the logarithm offset by (maxlog+1),
+ * a multiple of 2^F, so that the offset value is never negative. Mantissa
+ * logarithms are taken at the centre of each interval.
+ */
+template <class T, int F>
+logfixed<T, F>::tables::tables()
+   {
+   const double step = 1 << F;
+   for (int i = 0; i < lutsize; i++)
+      {
+      const double d = i / step;
+      entry[0][i] = -int(round(log(1 + exp(-d)) * step));
+      // entry for zero difference is not used (exact cancellation)
+      entry[1][i] = (i == 0) ? 0 : int(round(-log(1 - exp(-d)) * step));
+      }
+   assert(entry[0][lutsize - 1] == 0 && entry[1][lutsize - 1] == 0);
+   const int offset = (maxlog + 1) >> F;
+   for (int i = 0; i < expsize; i++)
+      expint[i] = exp(double(offset - i));
+   for (int i = 0; i < (1 << F); i++)
+      expfrac[i] = exp(-i / step);
+   for (int i = 0; i < (1 << mbits); i++)
+      logmant[i] = -log(1 + (i + 0.5) / (1 << mbits)) * step;
+   logexp = -log(2.0) * step;
+   }
+
+// conversion
+
+/*!
+ * Zero and NaN are held as zero; infinite values, and any others outside the
+ * representable range, saturate at the smallest or largest magnitude.
+ */
+template <class T, int F>
+T logfixed<T, F>::convertspecial(const double m)
+   {
+   // (m != m) holds only for NaN
+   if (m == 0 || m != m)
+      return T(zero);
+   const double x = -log(fabs(m)) * (1 << F);
+   return pack(saturate(int(round(std::max(std::min(x, double(maxlog)),
+         double(-maxlog))))), (m < 0) ? 1 : 0);
+   }
+
+// Explicit Realizations
+
+template class logfixed<int16s, 4> ;
+template class logfixed<int8s, 2> ;
+
+} // end namespace
@@ -0,0 +1,337 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __logfixed_h
+#define __logfixed_h
+
+#include "config.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+
+namespace libbase {
+
+/*!
+ * \brief   Fixed-Point Logarithm Arithmetic.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Implements log-scale arithmetic with the logarithm held as a saturating
+ * fixed-point integer, with 'F' fractional bits. This models the metric
+ * representation of a hardware decoder: multiplication is a saturating
+ * integer addition, while addition is the max* operation, where the
+ * correction term is read from a small table indexed by the (integer)
+ * difference between the operands.
+ *
+ * Each value is packed into a single signed integer of type 'T' (8 or 16
+ * bits): the sign is held in the least significant bit, and the remaining
+ * bits hold -log|x| scaled by 2^F. The largest representable logarithm is
+ * reserved for zero, which only results from a zero operand or the exact
+ * cancellation of two values. Results outside the representable range
+ * saturate at the smallest or largest magnitude; in particular, small values
+ * never underflow to zero, so that normalization remains possible.
+ *
+ * Arithmetic works directly on the packed integers, with zero operands and
+ * exact cancellation handled by selection rather than branching. Addition of
+ * values with opposite signs uses a second correction table, for
+ * -log(1-exp(-d)); this is needed by the transform-domain sum-product
+ * algorithm. Conversion to and from 'double' also uses tables, rather than
+ * calls to exp() and log(); the conversion from 'double' uses the leading
+ * 10 bits of the mantissa, so that quantizer thresholds are within 0.01 of
+ * a step from their exact position. All tables are built once, at program
+ * start.
+ *
+ * \note Comparison operators are provided between variables of this kind,
+ * so that hard decisions do not need a conversion to double.
+ *
+ * \note This type is meant for modelling the implementation loss of a
+ * fixed-point decoder, not for throughput: on a typical turbo code, decoding
+ * is still slower than with 'double' metrics, mostly due to the conversions
+ * at the decoder interface.
+ */
+
+template <class T, int F>
+class logfixed {
+   static const int lutsize = 16 << F;
+   static const int maxlog = ((1 << (8 * sizeof(T) - 1)) - 1) >> 1;
+   static const int zero = 2 * maxlog;
+   static const int mbits = 10;
+   static const int expsize = (2 * maxlog >> F) + 2;
+   //! Tables for addition and conversion
+   struct tables {
+      int entry[2][lutsize]; //!< Corrections for same/opposite-sign addition
+      double expint[expsize]; //!< exp(-n), for integer part n of logarithm
+      double expfrac[1 << F]; //!< exp(-f), for fractional part f of logarithm
+      double logmant[1 << mbits]; //!< -log(mantissa), scaled by 2^F
+      double logexp; //!< -log(2), scaled by 2^F
+      tables();
+   };
+   static const tables lut;
+private:
+   T value; //!< -log|x| scaled by 2^F, shifted left by one, with the sign bit
+   static int saturate(const int x);
+   static T pack(const int logval, const int sign)
+      {
+      return T(2 * logval + sign);
+      }
+   static T convertfromdouble(const double m);
+   static T convertspecial(const double m);
+   int logval() const
+      {
+      return int(value) >> 1;
+      }
+   int sign() const
+      {
+      return int(value) & 1;
+      }
+   bool iszero() const
+      {
+      return value == zero;
+      }
+   //! Monotonic integer key, for comparisons
+   int key() const
+      {
+      return sign() ? logval() - maxlog : maxlog - logval();
+      }
+public:
+   // construction
+   logfixed() :
+      value(T(zero))
+      {
+      }
+   logfixed(const double m) :
+      value(convertfromdouble(m))
+      {
+      }
+   // conversion
+   operator double() const;
+   logfixed& operator=(const double m)
+      {
+      value = convertfromdouble(m);
+      return *this;
+      }
+   // arithmetic - unary
+   logfixed operator-() const;
+   logfixed& operator+=(const logfixed& a);
+   logfixed& operator-=(const logfixed& a);
+   logfixed& operator*=(const logfixed& a);
+   logfixed& operator/=(const logfixed& a);
+   // comparison
+   bool operator==(const logfixed& a) const
+      {
+      return value == a.value;
+      }
+   bool operator!=(const logfixed& a) const
+      {
+      return value != a.value;
+      }
+   bool operator>=(const logfixed& a) const
+      {
+      return key() >= a.key();
+      }
+   bool operator<=(const logfixed& a) const
+      {
+      return key() <= a.key();
+      }
+   bool operator>(const logfixed& a) const
+      {
+      return key() > a.key();
+      }
+   bool operator<(const logfixed& a) const
+      {
+      return key() < a.key();
+      }
+};
+
+// Realizations in common use
+
+//! 16-bit metrics, with a resolution of 1/16 nat
+typedef logfixed<int16s, 4> logfixed16;
+//! 8-bit metrics, with a resolution of 1/4 nat
+typedef logfixed<int8s, 2> logfixed8;
+
+// private helper functions
+
+template <class T, int F>
+inline int logfixed<T, F>::saturate(const int x)
+   {
+   return std::min(std::max(x, -maxlog), maxlog - 1);
+   }
+
+// conversion operations
+
+/*!
+ * Zero is common (eg. when clearing accumulators), so it is handled first.
+ * Other values with an exponent of zero or all ones in their 'double'
+ * representation (subnormal, infinite or NaN) are left to convertspecial();
+ * the logarithm of the rest is obtained from their exponent and leading
+ * mantissa bits.
+ */
+template <class T, int F>
+inline T logfixed<T, F>::convertfromdouble(const double m)
+   {
+   if (m == 0)
+      return T(zero);
+   int64u bits;
+   memcpy(&bits, &m, sizeof(bits));
+   const int e = int(bits >> 52) & 0x7ff;
+   if (e == 0 || e == 0x7ff)
+      return convertspecial(m);
+   const int k = int(bits >> (52 - mbits)) & ((1 << mbits) - 1);
+   const double x = (e - 1023) * lut.logexp + lut.logmant[k];
+   // x is well within the bias, so truncation gives the nearest integer
+   const int bias = 1 << 16;
+   return pack(saturate(int(x + bias + 0.5) - bias), int(bits >> 63));
+   }
+
+template <class T, int F>
+inline logfixed<T, F>::operator double() const
+   {
+   if (iszero())
+      return 0;
+   const int l = logval() + (maxlog + 1);
+   const double x = lut.expint[l >> F] * lut.expfrac[l & ((1 << F) - 1)];
+   return sign() ? -x : x;
+   }
+
+// arithmetic operations - unary
+
+template <class T, int F>
+inline logfixed<T, F> logfixed<T, F>::operator-() const
+   {
+   logfixed<T, F> result = *this;
+   result.value = iszero() ? value : T(value ^ 1);
+   return result;
+   }
+
+/*!
+ * The result takes the sign of the operand with the larger magnitude (ie the
+ * smaller logarithm), and its logarithm is corrected by the table entry for
+ * the difference between the operands; differences beyond the table use its
+ * last entry, which is zero.
+ */
+template <class T, int F>
+inline logfixed<T, F>& logfixed<T, F>::operator+=(const logfixed<T, F>& a)
+   {
+   const int la = logval();
+   const int lb = a.logval();
+   const int opposite = (value ^ a.value) & 1;
+   const int diff = std::min(abs(la - lb), lutsize - 1);
+   const T base = (la <= lb) ? value : a.value;
+   const T result = pack(saturate((int(base) >> 1)
+         + lut.entry[opposite][diff]), int(base) & 1);
+   value = a.iszero() ? value : iszero() ? a.value
+         : (opposite && diff == 0) ? T(zero) : result;
+   return *this;
+   }
+
+template <class T, int F>
+inline logfixed<T, F>& logfixed<T, F>::operator-=(const logfixed<T, F>& a)
+   {
+   return *this += -a;
+   }
+
+template <class T, int F>
+inline logfixed<T, F>& logfixed<T, F>::operator*=(const logfixed<T, F>& a)
+   {
+   const T result = pack(saturate(logval() + a.logval()), sign() ^ a.sign());
+   value = (iszero() || a.iszero()) ? T(zero) : result;
+   return *this;
+   }
+
+template <class T, int F>
+inline logfixed<T, F>& logfixed<T, F>::operator/=(const logfixed<T, F>& a)
+   {
+   // division by zero saturates to the largest magnitude
+   const T result = pack(a.iszero() ? -maxlog : saturate(logval()
+         - a.logval()), sign() ^ a.sign());
+   value = iszero() ? T(zero) : result;
+   return *this;
+   }
+
+// The following functions operate through the above - no need to make them friends
+
+template <class T, int F>
+inline logfixed<T, F> operator+(const logfixed<T, F>& a,
+      const logfixed<T, F>& b)
+   {
+   logfixed<T, F> result = a;
+   result += b;
+   return result;
+   }
+
+template <class T, int F>
+inline logfixed<T, F> operator-(const logfixed<T, F>& a,
+      const logfixed<T, F>& b)
+   {
+   logfixed<T, F> result = a;
+   result -= b;
+   return result;
+   }
+
+template <class T, int F>
+inline logfixed<T, F> operator*(const logfixed<T, F>& a,
+      const logfixed<T, F>& b)
+   {
+   logfixed<T, F> result = a;
+   result *= b;
+   return result;
+   }
+
+template <class T, int F>
+inline logfixed<T, F> operator/(const logfixed<T, F>& a,
+      const logfixed<T, F>& b)
+   {
+   logfixed<T, F> result = a;
+   result /= b;
+   return result;
+   }
+
+// stream I/O
+
+template <class T, int F>
+std::ostream& operator<<(std::ostream& sout, const logfixed<T, F>& x)
+   {
+   sout << double(x);
+   return sout;
+   }
+
+template <class T, int F>
+std::istream& operator>>(std::istream& sin, logfixed<T, F>& x)
+   {
+   double m;
+   sin >> m;
+   x = m;
+   return sin;
+   }
+
+} // end namespace
+
+#endif
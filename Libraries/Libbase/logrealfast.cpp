@@ -29,6 +29,8 @@ namespace libbase {
 const int logrealfast::lutsize = 1 << 17;
 const double logrealfast::lutrange = 12.0;
 double *logrealfast::lut;
+const int logrealfast::jacsize = 96;
+double *logrealfast::jac;
 bool logrealfast::lutready = false;
 #ifdef DEBUGFILE
 std::ofstream logrealfast::file;
@@ -36,11 +38,29 @@ std::ofstream logrealfast::file;
 
 // LUT constructor
 
+/*!
+ * The small table holds three coefficients per segment, for the quadratic
+ * through the end-points and mid-point of the segment. A final segment with
+ * zero coefficients covers differences at or beyond the table range.
+ */
 void logrealfast::buildlut()
    {
    lut = new double[lutsize];
    for (int i = 0; i < lutsize; i++)
       lut[i] = log(1 + exp(-lutrange * i / (lutsize - 1)));
+   const double h = lutrange / jacsize;
+   jac = new double[3 * (jacsize + 1)];
+   for (int i = 0; i < jacsize; i++)
+      {
+      const double f0 = log(1 + exp(-h * i));
+      const double f1 = log(1 + exp(-h * (i + 0.5)));
+      const double f2 = log(1 + exp(-h * (i + 1)));
+      const double c2 = 2 * (f2 - 2 * f1 + f0) / (h * h);
+      jac[3 * i] = f0;
+      jac[3 * i + 1] = 2 * (f1 - f0) / h - c2 * h / 2;
+      jac[3 * i + 2] = c2;
+      }
+   jac[3 * jacsize] = jac[3 * jacsize + 1] = jac[3 * jacsize + 2] = 0;
    lutready = true;
 #ifdef DEBUGFILE
    file.open("logrealfast-table.txt");
@@ -34,6 +34,7 @@
 #include <cmath>
 #include <cfloat>
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #ifdef DEBUGFILE
 #  include <fstream>
@@ -58,6 +59,12 @@ namespace libbase {
  * addition. The choice of LUT size and range is optimized at 128k entries
  * over [0,12].
  *
+ * A second, much smaller table holds a piecewise-quadratic approximation of
+ * the same correction term log(1+exp(-d)), with 96 segments over [0,12].
+ * This fits in a few cache lines and is accurate to within the resolution
+ * of the main LUT; it is used by the vector type logrealfast_v, where the
+ * main LUT's scattered accesses would dominate.
+ *
  * \note Constructor traps infinite values and NaN. Zero values are trapped
  * first; since zero is the default argument, there are many more calls
  * with this value than any other, so this should improve performance.
@@ -75,13 +82,16 @@ class logrealfast {
    static const int lutsize;
    static const double lutrange;
    static double *lut;
+   static const int jacsize;
+   static double *jac;
    static bool lutready;
 #ifdef DEBUGFILE
    static std::ofstream file;
 #endif
 private:
    double logval;
-   void buildlut();
+   static void buildlut();
+   static double jacobian(const double diff);
    static double convertfromdouble(const double m);
    static void ensurefinite(double& x);
    // define these as private to ensure no-one uses them
@@ -132,6 +142,9 @@ public:
    friend std::istream& operator>>(std::istream& sin, logrealfast& x);
    // specialized power function
    friend logrealfast pow(const logrealfast& a, const double b);
+   // vector realization
+   template <int N>
+   friend class logrealfast_v;
 };
 
 // private helper functions
@@ -165,12 +178,31 @@ inline void logrealfast::ensurefinite(double& x)
       }
    }
 
+/*!
+ * \brief Correction term log(1+exp(-diff)) from the small table
+ *
+ * The difference must be non-negative; values beyond the table range use
+ * the last entry, which is zero.
+ */
+inline double logrealfast::jacobian(const double diff)
+   {
+   static const double jacinvstep = jacsize / lutrange;
+   static const double jacstep = lutrange / jacsize;
+   const double d = std::min(diff, lutrange);
+   const int index = int(d * jacinvstep);
+   const double x = d - index * jacstep;
+   const double *c = jac + 3 * index;
+   return c[0] + x * (c[1] + x * c[2]);
+   }
+
 // construction operations
 
 inline logrealfast::logrealfast()
    {
    if (!lutready)
       buildlut();
+   // default value is zero, so that copies of default objects are defined
+   logval = DBL_MAX;
    }
 
 inline logrealfast::logrealfast(const double m)
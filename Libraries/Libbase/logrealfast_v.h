@@ -0,0 +1,203 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __logrealfast_v_h
+#define __logrealfast_v_h
+
+#include "logrealfast.h"
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+namespace libbase {
+
+/*!
+ * \brief   Fast Logarithm Arithmetic - Vector of N values.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Holds N logrealfast values, with element-wise addition and multiplication
+ * performed on all values at once. Addition uses the small piecewise-quadratic
+ * table of logrealfast rather than the main LUT, so results may differ from
+ * the scalar type by up to the resolution of the main LUT. Multiplication
+ * saturates in the same way as the scalar type, but without warnings.
+ *
+ * Values are moved in and out with load/store (from contiguous arrays) or
+ * get/set (element-wise, for gathering from arbitrary positions).
+ *
+ * \note When compiled with SSE2, pairs of values are processed in one
+ * register; only the table coefficients are gathered element-wise.
+ */
+
+template <int N>
+class logrealfast_v {
+private:
+   double logval[N];
+#ifdef __SSE2__
+   static __m128d jacobian(const __m128d d);
+#endif
+public:
+   //! Default constructor (values are undefined)
+   logrealfast_v()
+      {
+      if (!logrealfast::lutready)
+         logrealfast::buildlut();
+      }
+   //! Set all elements to zero
+   void zero()
+      {
+      for (int k = 0; k < N; k++)
+         logval[k] = DBL_MAX;
+      }
+   //! Copy elements from contiguous array
+   void load(const logrealfast* p)
+      {
+      for (int k = 0; k < N; k++)
+         logval[k] = p[k].logval;
+      }
+   //! Copy elements to contiguous array
+   void store(logrealfast* p) const
+      {
+      for (int k = 0; k < N; k++)
+         p[k].logval = logval[k];
+      }
+   //! Get element 'k'
+   logrealfast get(const int k) const
+      {
+      logrealfast result;
+      result.logval = logval[k];
+      return result;
+      }
+   //! Set element 'k'
+   void set(const int k, const logrealfast& a)
+      {
+      logval[k] = a.logval;
+      }
+   // arithmetic
+   logrealfast_v& operator+=(const logrealfast_v& a);
+   logrealfast_v& operator*=(const logrealfast_v& a);
+   logrealfast_v& operator*=(const logrealfast& a);
+};
+
+// private helper functions
+
+#ifdef __SSE2__
+/*!
+ * \brief Correction term log(1+exp(-d)) for a pair of non-negative values
+ *
+ * Mirrors logrealfast::jacobian(); differences are clamped to the table
+ * range before conversion to an index.
+ */
+template <int N>
+inline __m128d logrealfast_v<N>::jacobian(const __m128d d)
+   {
+   const __m128d range = _mm_set1_pd(logrealfast::lutrange);
+   const __m128d invstep = _mm_set1_pd(logrealfast::jacsize
+         / logrealfast::lutrange);
+   const __m128d step = _mm_set1_pd(logrealfast::lutrange
+         / logrealfast::jacsize);
+   const __m128d dc = _mm_min_pd(d, range);
+   const __m128i index = _mm_cvttpd_epi32(_mm_mul_pd(dc, invstep));
+   const __m128d x = _mm_sub_pd(dc, _mm_mul_pd(_mm_cvtepi32_pd(index), step));
+   const double *c0 = logrealfast::jac + 3 * _mm_cvtsi128_si32(index);
+   const double *c1 = logrealfast::jac + 3 * _mm_cvtsi128_si32(
+         _mm_shuffle_epi32(index, 1));
+   __m128d r = _mm_set_pd(c1[2], c0[2]);
+   r = _mm_add_pd(_mm_mul_pd(r, x), _mm_set_pd(c1[1], c0[1]));
+   r = _mm_add_pd(_mm_mul_pd(r, x), _mm_set_pd(c1[0], c0[0]));
+   return r;
+   }
+#endif
+
+// arithmetic operations
+
+template <int N>
+inline logrealfast_v<N>& logrealfast_v<N>::operator+=(const logrealfast_v<N>& a)
+   {
+   int k = 0;
+#ifdef __SSE2__
+   for (; k + 1 < N; k += 2)
+      {
+      const __m128d x = _mm_loadu_pd(logval + k);
+      const __m128d y = _mm_loadu_pd(a.logval + k);
+      const __m128d lo = _mm_min_pd(x, y);
+      const __m128d diff = _mm_sub_pd(_mm_max_pd(x, y), lo);
+      _mm_storeu_pd(logval + k, _mm_sub_pd(lo, jacobian(diff)));
+      }
+#endif
+   for (; k < N; k++)
+      {
+      const double lo = std::min(logval[k], a.logval[k]);
+      const double diff = std::max(logval[k], a.logval[k]) - lo;
+      logval[k] = lo - logrealfast::jacobian(diff);
+      }
+   return *this;
+   }
+
+template <int N>
+inline logrealfast_v<N>& logrealfast_v<N>::operator*=(const logrealfast_v<N>& a)
+   {
+   int k = 0;
+#ifdef __SSE2__
+   const __m128d hi = _mm_set1_pd(DBL_MAX);
+   const __m128d lo = _mm_set1_pd(-DBL_MAX);
+   for (; k + 1 < N; k += 2)
+      {
+      const __m128d x = _mm_add_pd(_mm_loadu_pd(logval + k), _mm_loadu_pd(
+            a.logval + k));
+      _mm_storeu_pd(logval + k, _mm_max_pd(_mm_min_pd(x, hi), lo));
+      }
+#endif
+   for (; k < N; k++)
+      logval[k] = std::max(std::min(logval[k] + a.logval[k], DBL_MAX),
+            -DBL_MAX);
+   return *this;
+   }
+
+template <int N>
+inline logrealfast_v<N>& logrealfast_v<N>::operator*=(const logrealfast& a)
+   {
+   int k = 0;
+#ifdef __SSE2__
+   const __m128d hi = _mm_set1_pd(DBL_MAX);
+   const __m128d lo = _mm_set1_pd(-DBL_MAX);
+   const __m128d y = _mm_set1_pd(a.logval);
+   for (; k + 1 < N; k += 2)
+      {
+      const __m128d x = _mm_add_pd(_mm_loadu_pd(logval + k), y);
+      _mm_storeu_pd(logval + k, _mm_max_pd(_mm_min_pd(x, hi), lo));
+      }
+#endif
+   for (; k < N; k++)
+      logval[k] = std::max(std::min(logval[k] + a.logval, DBL_MAX), -DBL_MAX);
+   return *this;
+   }
+
+} // end namespace
+
+#endif
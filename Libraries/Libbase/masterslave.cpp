@@ -488,6 +488,20 @@ void masterslave::resetslave(slave *s)
    s->state = slave::NEW;
    }
 
+/*!
+ * \brief Return given slave to the 'working' state
+ *
+ * This is used when the event read from a slave does not conclude its
+ * work (e.g. when the slave is streaming partial results back).
+ *
+ * \note Slave must be in the 'idle' state
+ */
+void masterslave::keepworking(slave *s)
+   {
+   assertalways(s->state == slave::IDLE);
+   s->state = slave::WORKING;
+   }
+
 /*!
  * \brief Reset all 'idle' slaves to the 'new' state
  */
@@ -186,6 +186,7 @@ public:
    bool anyoneworking() const;
    void waitforevent(const bool acceptnew = true, const double timeout = 0);
    void resetslave(slave *s);
+   void keepworking(slave *s);
    void resetslaves();
    // master -> slave communication
    bool send(slave *s, const void *buf, const size_t len);
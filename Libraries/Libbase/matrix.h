@@ -28,6 +28,7 @@
 #include "config.h"
 #include "size.h"
 #include "vector.h"
+#include "aligned_allocator.h"
 #include <cstdlib>
 #include <iostream>
 #include <algorithm>
@@ -144,8 +145,10 @@ template <class T>
 class matrix {
    friend class masked_matrix<T> ;
 private:
+   typedef aligned_allocator<T, 64> Allocator;
+   Allocator allocator;
    size_type<libbase::matrix> m_size;
-   T **m_data;
+   T *m_data;
 protected:
    /*! \name Memory allocation functions */
    void alloc(const int m, const int n);
@@ -232,6 +235,29 @@ public:
    const T& operator()(const int i, const int j) const;
    // @}
 
+   /*! \name Raw storage access (no boundary checking) */
+   /*! \brief Pointer to the first element of row 'i'
+    * Elements of a row are contiguous; successive rows are stride() elements
+    * apart.
+    */
+   T* row(const int i)
+      {
+      assert(i>=0 && i<m_size.rows());
+      return m_data + i * stride();
+      }
+   /*! \copydoc row() */
+   const T* row(const int i) const
+      {
+      assert(i>=0 && i<m_size.rows());
+      return m_data + i * stride();
+      }
+   //! Distance in elements between the start of successive rows
+   int stride() const
+      {
+      return m_size.cols();
+      }
+   // @}
+
    /*! \name Information functions */
    //! Matrix size in rows and columns
    size_type<libbase::matrix> size() const
@@ -350,14 +376,20 @@ inline void matrix<T>::free()
    {
    if (m_size > 0)
       {
-      for (int i = 0; i < m_size.rows(); i++)
-         delete[] m_data[i];
-      delete[] m_data;
+      // call destructor
+      const int n = m_size;
+      for (int i = 0; i < n; i++)
+         allocator.destroy(&m_data[i]);
+      // deallocate memory
+      allocator.deallocate(m_data, n);
       }
    }
 
 /*! \brief Allocates memory for (x,y) elements and updates sizes
  * \note Detects invalid size values (either x or y being 0, but not both)
+ *
+ * \note All elements are held in a single block, in row-major order, with
+ * the start of the block aligned to a 64-byte boundary.
  */
 template <class T>
 inline void matrix<T>::alloc(const int x, const int y)
@@ -371,10 +403,13 @@ inline void matrix<T>::alloc(const int x, const int y)
       {
       assertalways(x>0 && y>0);
       m_size = size_type<libbase::matrix> (x, y);
-      typedef T* Tp;
-      m_data = new Tp[x];
-      for (int i = 0; i < x; i++)
-         m_data[i] = new T[y];
+      // allocate memory for all elements
+      const int n = x * y;
+      m_data = allocator.allocate(n);
+      // call default constructor
+      const T element = T();
+      for (int i = 0; i < n; i++)
+         allocator.construct(&m_data[i], element);
       }
    }
 
@@ -384,9 +419,8 @@ template <class T>
 inline matrix<T>::matrix(const matrix<T>& x)
    {
    alloc(x.m_size.rows(), x.m_size.cols());
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] = x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] = x.m_data[i];
    }
 
 /*! \brief Set matrix to given size, freeing if and as required
@@ -424,7 +458,7 @@ inline matrix<T>& matrix<T>::copyfrom(const matrix<A>& x)
    const int cols = std::min(m_size.cols(), x.m_size.cols());
    for (int i = 0; i < rows; i++)
       for (int j = 0; j < cols; j++)
-         m_data[i][j] = x(i, j);
+         m_data[i * m_size.cols() + j] = x(i, j);
    return *this;
    }
 
@@ -437,7 +471,7 @@ inline matrix<T>& matrix<T>::copyfrom(const vector<A>& x)
    int k = 0;
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols() && k < x.size(); j++)
-         m_data[i][j] = x(k++);
+         m_data[i * m_size.cols() + j] = x(k++);
    return *this;
    }
 
@@ -447,7 +481,7 @@ inline matrix<T>& matrix<T>::operator=(const matrix<T>& x)
    init(x.size());
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] = x(i, j);
+         m_data[i * m_size.cols() + j] = x(i, j);
    return *this;
    }
 
@@ -460,7 +494,7 @@ inline matrix<T>& matrix<T>::operator=(const matrix<A>& x)
    init(x.size());
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] = x(i, j);
+         m_data[i * m_size.cols() + j] = x(i, j);
    return *this;
    }
 
@@ -472,16 +506,15 @@ inline matrix<T>& matrix<T>::operator=(const vector<A>& x)
    {
    init(x.size(), 1);
    for (int i = 0; i < m_size.rows(); i++)
-      m_data[i][0] = x(i);
+      m_data[i * m_size.cols()] = x(i);
    return *this;
    }
 
 template <class T>
 inline matrix<T>& matrix<T>::operator=(const T x)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] = x;
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] = x;
    return *this;
    }
 
@@ -491,9 +524,8 @@ inline vector<T> matrix<T>::rowmajor() const
    {
    vector<T> v(size());
    int k = 0;
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         v(k++) = m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      v(k++) = m_data[i];
    return v;
    }
 
@@ -505,7 +537,7 @@ inline vector<T> matrix<T>::colmajor() const
    int k = 0;
    for (int j = 0; j < m_size.cols(); j++)
       for (int i = 0; i < m_size.rows(); i++)
-         v(k++) = m_data[i][j];
+         v(k++) = m_data[i * m_size.cols() + j];
    return v;
    }
 
@@ -518,7 +550,7 @@ inline void matrix<T>::insertrow(const vector<T>& v, const int i)
    {
    assert(v.size() == m_size.cols());
    for (int j = 0; j < m_size.cols(); j++)
-      m_data[i][j] = v(j);
+      m_data[i * m_size.cols() + j] = v(j);
    }
 
 /*! \brief Insert vector into column 'j'
@@ -528,7 +560,7 @@ inline void matrix<T>::insertcol(const vector<T>& v, const int j)
    {
    assert(v.size() == m_size.rows());
    for (int i = 0; i < m_size.rows(); i++)
-      m_data[i][j] = v(i);
+      m_data[i * m_size.cols() + j] = v(i);
    }
 
 /*! \brief Extract row 'i' as a vector
@@ -542,7 +574,7 @@ inline void matrix<T>::extractrow(vector<T>& v, const int i) const
    assert(i>=0 && i<m_size.rows());
    v.init(m_size.cols());
    for (int j = 0; j < m_size.cols(); j++)
-      v(j) = m_data[i][j];
+      v(j) = m_data[i * m_size.cols() + j];
    }
 
 /*! \brief Extract column 'j' as a vector
@@ -556,7 +588,7 @@ inline void matrix<T>::extractcol(vector<T>& v, const int j) const
    assert(j>=0 && j<m_size.cols());
    v.init(m_size.rows());
    for (int i = 0; i < m_size.rows(); i++)
-      v(i) = m_data[i][j];
+      v(i) = m_data[i * m_size.cols() + j];
    }
 
 /*! \brief Extract row 'i' as a vector
@@ -586,7 +618,7 @@ inline T& matrix<T>::operator()(const int i, const int j)
    {
    assert(i>=0 && i<m_size.rows());
    assert(j>=0 && j<m_size.cols());
-   return m_data[i][j];
+   return m_data[i * m_size.cols() + j];
    }
 
 template <class T>
@@ -594,7 +626,7 @@ inline const T& matrix<T>::operator()(const int i, const int j) const
    {
    assert(i>=0 && i<m_size.rows());
    assert(j>=0 && j<m_size.cols());
-   return m_data[i][j];
+   return m_data[i * m_size.cols() + j];
    }
 
 /*! \brief Writes matrix data to output stream.
@@ -606,9 +638,9 @@ inline void matrix<T>::serialize(std::ostream& sout) const
    {
    for (int i = 0; i < m_size.rows(); i++)
       {
-      sout << m_data[i][0];
+      sout << m_data[i * m_size.cols()];
       for (int j = 1; j < m_size.cols(); j++)
-         sout << "\t" << m_data[i][j];
+         sout << "\t" << m_data[i * m_size.cols() + j];
       sout << std::endl;
       }
    }
@@ -622,9 +654,8 @@ inline void matrix<T>::serialize(std::ostream& sout) const
 template <class T>
 inline void matrix<T>::serialize(std::istream& sin)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         sin >> m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      sin >> m_data[i];
    }
 
 /*! \brief Writes matrix to output stream.
@@ -659,7 +690,7 @@ inline matrix<bool> matrix<T>::operator==(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] == x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) == x(i, j));
    return r;
    }
 
@@ -670,7 +701,7 @@ inline matrix<bool> matrix<T>::operator!=(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] != x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) != x(i, j));
    return r;
    }
 
@@ -681,7 +712,7 @@ inline matrix<bool> matrix<T>::operator<=(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] <= x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) <= x(i, j));
    return r;
    }
 
@@ -692,7 +723,7 @@ inline matrix<bool> matrix<T>::operator>=(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] >= x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) >= x(i, j));
    return r;
    }
 
@@ -703,7 +734,7 @@ inline matrix<bool> matrix<T>::operator<(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] < x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) < x(i, j));
    return r;
    }
 
@@ -714,7 +745,7 @@ inline matrix<bool> matrix<T>::operator>(const matrix<T>& x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] > x.m_data[i][j]);
+         r(i, j) = ((*this)(i, j) > x(i, j));
    return r;
    }
 
@@ -724,7 +755,7 @@ inline matrix<bool> matrix<T>::operator==(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] == x);
+         r(i, j) = ((*this)(i, j) == x);
    return r;
    }
 
@@ -734,7 +765,7 @@ inline matrix<bool> matrix<T>::operator!=(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] != x);
+         r(i, j) = ((*this)(i, j) != x);
    return r;
    }
 
@@ -744,7 +775,7 @@ inline matrix<bool> matrix<T>::operator<=(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] <= x);
+         r(i, j) = ((*this)(i, j) <= x);
    return r;
    }
 
@@ -754,7 +785,7 @@ inline matrix<bool> matrix<T>::operator>=(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] >= x);
+         r(i, j) = ((*this)(i, j) >= x);
    return r;
    }
 
@@ -764,7 +795,7 @@ inline matrix<bool> matrix<T>::operator<(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] < x);
+         r(i, j) = ((*this)(i, j) < x);
    return r;
    }
 
@@ -774,7 +805,7 @@ inline matrix<bool> matrix<T>::operator>(const T x) const
    matrix<bool> r(m_size);
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r(i, j) = (m_data[i][j] > x);
+         r(i, j) = ((*this)(i, j) > x);
    return r;
    }
 
@@ -785,10 +816,9 @@ inline bool matrix<T>::isequalto(const matrix<T>& x) const
    {
    if (x.m_size != m_size)
       return false;
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         if (m_data[i][j] != x.m_data[i][j])
-            return false;
+   for (int i = 0; i < int(m_size); i++)
+      if (m_data[i] != x.m_data[i])
+         return false;
    return true;
    }
 
@@ -804,9 +834,8 @@ template <class T>
 inline matrix<T>& matrix<T>::operator+=(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] += x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] += x.m_data[i];
    return *this;
    }
 
@@ -814,9 +843,8 @@ template <class T>
 inline matrix<T>& matrix<T>::operator-=(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] -= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] -= x.m_data[i];
    return *this;
    }
 
@@ -854,9 +882,8 @@ template <class T>
 inline matrix<T>& matrix<T>::multiplyby(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] *= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] *= x.m_data[i];
    return *this;
    }
 
@@ -870,45 +897,40 @@ template <class T>
 inline matrix<T>& matrix<T>::divideby(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] /= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] /= x.m_data[i];
    return *this;
    }
 
 template <class T>
 inline matrix<T>& matrix<T>::operator+=(const T x)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] += x;
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] += x;
    return *this;
    }
 
 template <class T>
 inline matrix<T>& matrix<T>::operator-=(const T x)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] -= x;
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] -= x;
    return *this;
    }
 
 template <class T>
 inline matrix<T>& matrix<T>::operator*=(const T x)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] *= x;
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] *= x;
    return *this;
    }
 
 template <class T>
 inline matrix<T>& matrix<T>::operator/=(const T x)
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] /= x;
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] /= x;
    return *this;
    }
 
@@ -948,9 +970,9 @@ inline matrix<T> matrix<T>::operator*(const matrix<T>& x) const
    for (int i = 0; i < r.m_size.rows(); i++)
       for (int j = 0; j < r.m_size.cols(); j++)
          {
-         r.m_data[i][j] = 0;
+         r(i, j) = 0;
          for (int k = 0; k < m_size.cols(); k++)
-            r.m_data[i][j] += m_data[i][k] * x.m_data[k][j];
+            r(i, j) += (*this)(i, k) * x(k, j);
          }
    return r;
    }
@@ -974,7 +996,7 @@ inline vector<T> matrix<T>::operator*(const vector<T>& x) const
       {
       r(i) = 0;
       for (int k = 0; k < m_size.rows(); k++)
-         r(i) += m_data[k][i] * x(k);
+         r(i) += m_data[k * m_size.cols() + i] * x(k);
       }
    return r;
    }
@@ -1001,9 +1023,8 @@ inline matrix<T> matrix<T>::multiply(const matrix<T>& x) const
    {
    assert(x.m_size == m_size);
    matrix<T> r(m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         r.m_data[i][j] = m_data[i][j] * x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      r.m_data[i] = m_data[i] * x.m_data[i];
    return r;
    }
 
@@ -1018,9 +1039,8 @@ inline matrix<T> matrix<T>::divide(const matrix<T>& x) const
    {
    assert(x.m_size == m_size);
    matrix<T> r(m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         r.m_data[i][j] = m_data[i][j] / x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      r.m_data[i] = m_data[i] / x.m_data[i];
    return r;
    }
 
@@ -1062,9 +1082,8 @@ template <class T>
 inline matrix<T>& matrix<T>::operator&=(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] &= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] &= x.m_data[i];
    return *this;
    }
 
@@ -1072,9 +1091,8 @@ template <class T>
 inline matrix<T>& matrix<T>::operator|=(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] |= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] |= x.m_data[i];
    return *this;
    }
 
@@ -1082,9 +1100,8 @@ template <class T>
 inline matrix<T>& matrix<T>::operator^=(const matrix<T>& x)
    {
    assert(x.m_size == m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] ^= x.m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] ^= x.m_data[i];
    return *this;
    }
 
@@ -1094,9 +1111,8 @@ template <class T>
 inline matrix<T> matrix<T>::operator!() const
    {
    matrix<T> r(m_size);
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         r.m_data[i][j] = !m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      r.m_data[i] = !m_data[i];
    return r;
    }
 
@@ -1132,9 +1148,8 @@ inline matrix<T> matrix<T>::operator^(const matrix<T>& x) const
 template <class T>
 inline matrix<T>& matrix<T>::apply(T f(T))
    {
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         m_data[i][j] = f(m_data[i][j]);
+   for (int i = 0; i < int(m_size); i++)
+      m_data[i] = f(m_data[i]);
    return *this;
    }
 
@@ -1311,7 +1326,7 @@ inline matrix<T> matrix<T>::transpose() const
    // copy over data
    for (int i = 0; i < m_size.rows(); i++)
       for (int j = 0; j < m_size.cols(); j++)
-         r.m_data[j][i] = m_data[i][j];
+         r(j, i) = (*this)(i, j);
    return r;
    }
 
@@ -1327,11 +1342,10 @@ template <class T>
 inline T matrix<T>::min() const
    {
    assert(m_size > 0);
-   T result = m_data[0][0];
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         if (m_data[i][j] < result)
-            result = m_data[i][j];
+   T result = m_data[0];
+   for (int i = 1; i < int(m_size); i++)
+      if (m_data[i] < result)
+         result = m_data[i];
    return result;
    }
 
@@ -1345,11 +1359,10 @@ template <class T>
 inline T matrix<T>::max() const
    {
    assert(m_size > 0);
-   T result = m_data[0][0];
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         if (m_data[i][j] > result)
-            result = m_data[i][j];
+   T result = m_data[0];
+   for (int i = 1; i < int(m_size); i++)
+      if (m_data[i] > result)
+         result = m_data[i];
    return result;
    }
 
@@ -1363,9 +1376,8 @@ inline T matrix<T>::sum() const
    {
    assert(m_size > 0);
    T result = 0;
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         result += m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      result += m_data[i];
    return result;
    }
 
@@ -1380,9 +1392,8 @@ inline T matrix<T>::sumsq() const
    {
    assert(m_size > 0);
    T result = 0;
-   for (int i = 0; i < m_size.rows(); i++)
-      for (int j = 0; j < m_size.cols(); j++)
-         result += m_data[i][j] * m_data[i][j];
+   for (int i = 0; i < int(m_size); i++)
+      result += m_data[i] * m_data[i];
    return result;
    }
 
@@ -1544,7 +1555,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator=(const T x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] = x;
+            (*m_data)(i, j) = x;
    return *this;
    }
 
@@ -1558,7 +1569,7 @@ inline masked_matrix<T>::operator vector<T>() const
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            v(k++) = m_data->m_data[i][j];
+            v(k++) = (*m_data)(i, j);
    return v;
    }
 
@@ -1571,7 +1582,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator+=(const matrix<T>& x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] += x.m_data[i][j];
+            (*m_data)(i, j) += x(i, j);
    return *this;
    }
 
@@ -1582,7 +1593,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator-=(const matrix<T>& x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] -= x.m_data[i][j];
+            (*m_data)(i, j) -= x(i, j);
    return *this;
    }
 
@@ -1604,7 +1615,7 @@ inline masked_matrix<T>& masked_matrix<T>::multiplyby(const matrix<T>& x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] *= x.m_data[i][j];
+            (*m_data)(i, j) *= x(i, j);
    return *this;
    }
 
@@ -1626,7 +1637,7 @@ inline masked_matrix<T>& masked_matrix<T>::divideby(const matrix<T>& x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] /= x.m_data[i][j];
+            (*m_data)(i, j) /= x(i, j);
    return *this;
    }
 
@@ -1636,7 +1647,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator+=(const T x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] += x;
+            (*m_data)(i, j) += x;
    return *this;
    }
 
@@ -1646,7 +1657,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator-=(const T x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] -= x;
+            (*m_data)(i, j) -= x;
    return *this;
    }
 
@@ -1656,7 +1667,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator*=(const T x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] *= x;
+            (*m_data)(i, j) *= x;
    return *this;
    }
 
@@ -1666,7 +1677,7 @@ inline masked_matrix<T>& masked_matrix<T>::operator/=(const T x)
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] /= x;
+            (*m_data)(i, j) /= x;
    return *this;
    }
 
@@ -1678,7 +1689,7 @@ inline masked_matrix<T>& masked_matrix<T>::apply(T f(T))
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            m_data->m_data[i][j] = f(m_data->m_data[i][j]);
+            (*m_data)(i, j) = f((*m_data)(i, j));
    return *this;
    }
 
@@ -1705,9 +1716,9 @@ inline T masked_matrix<T>::min() const
    bool initial = true;
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
-         if (m_mask(i, j) && (m_data->m_data[i][j] < result || initial))
+         if (m_mask(i, j) && ((*m_data)(i, j) < result || initial))
             {
-            result = m_data->m_data[i][j];
+            result = (*m_data)(i, j);
             initial = false;
             }
    return result;
@@ -1721,9 +1732,9 @@ inline T masked_matrix<T>::max() const
    bool initial = true;
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
-         if (m_mask(i, j) && (m_data->m_data[i][j] > result || initial))
+         if (m_mask(i, j) && ((*m_data)(i, j) > result || initial))
             {
-            result = m_data->m_data[i][j];
+            result = (*m_data)(i, j);
             initial = false;
             }
    return result;
@@ -1737,7 +1748,7 @@ inline T masked_matrix<T>::sum() const
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            result += m_data->m_data[i][j];
+            result += (*m_data)(i, j);
    return result;
    }
 
@@ -1749,7 +1760,7 @@ inline T masked_matrix<T>::sumsq() const
    for (int i = 0; i < m_data->m_size.rows(); i++)
       for (int j = 0; j < m_data->m_size.cols(); j++)
          if (m_mask(i, j))
-            result += m_data->m_data[i][j] * m_data->m_data[i][j];
+            result += (*m_data)(i, j) * (*m_data)(i, j);
    return result;
    }
 
@@ -0,0 +1,214 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "philox.h"
+
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
+namespace libbase {
+
+/*!
+ * \brief Compute a block of output values
+ * \param[in] key Bijection key
+ * \param[in] sub Substream number
+ * \param[in] ctr Block counter
+ * \param[out] out Output values
+ *
+ * Applies the Philox-4x32 bijection with ten rounds to the 128-bit counter
+ * value {ctr, sub, 0}; the constants are those of the reference
+ * implementation.
+ */
+inline void philox::compute(const int32u key[2], const int32u sub,
+      const int64u ctr, int32u out[4])
+   {
+   // multipliers and Weyl sequence key increments
+   const int64u M0 = 0xD2511F53;
+   const int64u M1 = 0xCD9E8D57;
+   const int32u W0 = 0x9E3779B9;
+   const int32u W1 = 0xBB67AE85;
+   int32u c0 = int32u(ctr);
+   int32u c1 = int32u(ctr >> 32);
+   int32u c2 = sub;
+   int32u c3 = 0;
+   int32u k0 = key[0];
+   int32u k1 = key[1];
+   for (int r = 0; r < 10; r++)
+      {
+      if (r > 0)
+         {
+         k0 += W0;
+         k1 += W1;
+         }
+      const int64u p0 = M0 * c0;
+      const int64u p1 = M1 * c2;
+      c0 = int32u(p1 >> 32) ^ c1 ^ k0;
+      c1 = int32u(p1);
+      c2 = int32u(p0 >> 32) ^ c3 ^ k1;
+      c3 = int32u(p0);
+      }
+   out[0] = c0;
+   out[1] = c1;
+   out[2] = c2;
+   out[3] = c3;
+   }
+
+#ifdef __SSE2__
+/*!
+ * \brief Compute four consecutive blocks of output values
+ * \param[in] key Bijection key
+ * \param[in] sub Substream number
+ * \param[in] ctr Block counter for the first block
+ * \param[out] out Output values, for blocks ctr to ctr+3 in turn
+ *
+ * Vectorized version of compute(), with each SSE2 lane working on one block.
+ * The 32x32-bit products are obtained with two unsigned multiplies, for the
+ * even and odd lanes respectively.
+ */
+inline void philox::compute4(const int32u key[2], const int32u sub,
+      const int64u ctr, int32u out[16])
+   {
+   // multipliers and Weyl sequence key increments
+   const __m128i M0 = _mm_set1_epi32(0xD2511F53);
+   const __m128i M1 = _mm_set1_epi32(0xCD9E8D57);
+   const int32u W0 = 0x9E3779B9;
+   const int32u W1 = 0xBB67AE85;
+   const int64u t1 = ctr + 1;
+   const int64u t2 = ctr + 2;
+   const int64u t3 = ctr + 3;
+   __m128i c0 = _mm_set_epi32(int32u(t3), int32u(t2), int32u(t1), int32u(ctr));
+   __m128i c1 = _mm_set_epi32(int32u(t3 >> 32), int32u(t2 >> 32), int32u(t1
+         >> 32), int32u(ctr >> 32));
+   __m128i c2 = _mm_set1_epi32(sub);
+   __m128i c3 = _mm_setzero_si128();
+   int32u k0 = key[0];
+   int32u k1 = key[1];
+   for (int r = 0; r < 10; r++)
+      {
+      if (r > 0)
+         {
+         k0 += W0;
+         k1 += W1;
+         }
+      // 64-bit products for even and odd lanes
+      const __m128i p0e = _mm_mul_epu32(c0, M0);
+      const __m128i p0o = _mm_mul_epu32(_mm_srli_epi64(c0, 32), M0);
+      const __m128i p1e = _mm_mul_epu32(c2, M1);
+      const __m128i p1o = _mm_mul_epu32(_mm_srli_epi64(c2, 32), M1);
+      // gather low and high halves back into lane order
+      const __m128i lo0 = _mm_unpacklo_epi32(_mm_shuffle_epi32(p0e, 0x08),
+            _mm_shuffle_epi32(p0o, 0x08));
+      const __m128i hi0 = _mm_unpacklo_epi32(_mm_shuffle_epi32(p0e, 0x0D),
+            _mm_shuffle_epi32(p0o, 0x0D));
+      const __m128i lo1 = _mm_unpacklo_epi32(_mm_shuffle_epi32(p1e, 0x08),
+            _mm_shuffle_epi32(p1o, 0x08));
+      const __m128i hi1 = _mm_unpacklo_epi32(_mm_shuffle_epi32(p1e, 0x0D),
+            _mm_shuffle_epi32(p1o, 0x0D));
+      // round function
+      c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(k0));
+      c1 = lo1;
+      c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(k1));
+      c3 = lo0;
+      }
+   // transpose, so that each block's values are consecutive
+   const __m128i t01l = _mm_unpacklo_epi32(c0, c1);
+   const __m128i t23l = _mm_unpacklo_epi32(c2, c3);
+   const __m128i t01h = _mm_unpackhi_epi32(c0, c1);
+   const __m128i t23h = _mm_unpackhi_epi32(c2, c3);
+   __m128i* dst = reinterpret_cast<__m128i*> (out);
+   _mm_storeu_si128(dst + 0, _mm_unpacklo_epi64(t01l, t23l));
+   _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(t01l, t23l));
+   _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(t01h, t23h));
+   _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(t01h, t23h));
+   }
+#endif
+
+void philox::init(int32u s)
+   {
+   key[0] = s;
+   key[1] = 0;
+   sub = 0;
+   ctr = 0;
+   // mark current block as used up
+   pos = 3;
+   }
+
+void philox::advance()
+   {
+   if (++pos == 4)
+      {
+      compute(key, sub, ctr++, block);
+      pos = 0;
+      }
+   }
+
+void philox::fill(int32u* values, const int n)
+   {
+   int i = 0;
+   // use up the remainder of the current block
+   while (i < n && pos < 3)
+      values[i++] = block[++pos];
+   // compute whole blocks directly into the output
+#ifdef __SSE2__
+   for (; i + 16 <= n; i += 16, ctr += 4)
+      compute4(key, sub, ctr, &values[i]);
+#endif
+   for (; i + 4 <= n; i += 4)
+      compute(key, sub, ctr++, &values[i]);
+   // start a new block for any remaining values
+   if (i < n)
+      {
+      compute(key, sub, ctr++, block);
+      pos = -1;
+      while (i < n)
+         values[i++] = block[++pos];
+      }
+   }
+
+/*!
+ * \brief Seed random generator, selecting the given stream
+ *
+ * Sequences with the same seed but different stream numbers do not overlap.
+ */
+void philox::seed(int32u s, int32u stream)
+   {
+   random::seed(s);
+   key[1] = stream;
+   }
+
+/*!
+ * \brief Seed random generator, selecting the given stream and substream
+ *
+ * Sequences with the same seed but different stream or substream numbers do
+ * not overlap.
+ */
+void philox::seed(int32u s, int32u stream, int32u substream)
+   {
+   random::seed(s);
+   key[1] = stream;
+   sub = substream;
+   }
+
+} // end namespace
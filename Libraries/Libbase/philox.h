@@ -0,0 +1,109 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __philox_h
+#define __philox_h
+
+#include "config.h"
+#include "random.h"
+
+namespace libbase {
+
+/*!
+ * \brief   Philox Counter-Based Random Generator.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * A pseudo-random generator using the Philox-4x32-10 bijection due to
+ * Salmon et al. ("Parallel random numbers: as easy as 1, 2, 3", SC'11).
+ * Each output block of four 32-bit values is obtained by applying ten
+ * rounds of a keyed bijection to a 64-bit block counter; the generator
+ * state is therefore just the key and the counter.
+ *
+ * The 64-bit key is made up of the seed and a stream number. Generators
+ * with the same seed and different stream numbers give independent,
+ * non-overlapping sequences; this allows each of a number of threads or
+ * slaves to be given its own reproducible sequence from a single seed.
+ * Each stream may be further divided into substreams; the substream number
+ * takes the upper part of the counter, so that these also do not overlap.
+ * The usual seed() interface selects stream and substream zero.
+ *
+ * \note
+ * - The period of each substream is 2^66 values
+ * - Since output blocks are independent of each other, the bulk interface
+ * computes whole blocks directly into the output; where SSE2 is available,
+ * four blocks are computed at a time
+ */
+
+class philox : public random {
+private:
+   /*! \name Object representation */
+   int32u key[2]; //!< Bijection key (seed, stream)
+   int32u sub; //!< Substream number (third word of counter)
+   int64u ctr; //!< Index of next block to compute
+   int32u block[4]; //!< Last computed block of output values
+   int pos; //!< Index of current output value within block
+   // @}
+
+private:
+   /*! \name Internal functions */
+   static void compute(const int32u key[2], const int32u sub,
+         const int64u ctr, int32u out[4]);
+#ifdef __SSE2__
+   static void compute4(const int32u key[2], const int32u sub,
+         const int64u ctr, int32u out[16]);
+#endif
+   // @}
+
+protected:
+   // Interface with random
+   void init(int32u s);
+   void advance();
+   int32u get_value() const
+      {
+      return block[pos];
+      }
+   int32u get_max() const
+      {
+      return 0xffffffff;
+      }
+   void fill(int32u* values, const int n);
+
+public:
+   /*! \name Random generator interface */
+   using random::seed;
+   //! Seed random generator, selecting the given stream
+   void seed(int32u s, int32u stream);
+   //! Seed random generator, selecting the given stream and substream
+   void seed(int32u s, int32u stream, int32u substream);
+   // @}
+};
+
+} // end namespace
+
+#endif
@@ -66,4 +66,24 @@ void randgen::advance()
    ma[next] = mj;
    }
 
+void randgen::fill(int32u* values, const int n)
+   {
+   int32s a = next, b = nextp, v = mj;
+   for (int i = 0; i < n; i++)
+      {
+      if (++a >= 56)
+         a = 1;
+      if (++b >= 56)
+         b = 1;
+      v = ma[a] - ma[b];
+      if (v < 0)
+         v += mbig;
+      ma[a] = v;
+      values[i] = v;
+      }
+   next = a;
+   nextp = b;
+   mj = v;
+   }
+
 } // end namespace
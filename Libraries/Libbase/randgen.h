@@ -71,6 +71,7 @@ protected:
       {
       return mbig;
       }
+   void fill(int32u* values, const int n);
 };
 
 } // end namespace
@@ -23,6 +23,7 @@
  */
 
 #include "random.h"
+#include "vector.h"
 
 namespace libbase {
 
@@ -81,4 +82,87 @@ double random::gval()
    return (v1 * fac);
    }
 
+/*!
+ * \brief Advance generator by 'n' steps, storing each output value
+ *
+ * Default implementation uses the single-step interface; derived classes
+ * should override this where a faster implementation is possible.
+ */
+void random::fill(int32u* values, const int n)
+   {
+   for (int i = 0; i < n; i++)
+      {
+      advance();
+      values[i] = get_value();
+      }
+   }
+
+void random::ival(vector<int32u>& x)
+   {
+   const int n = x.size();
+#ifndef NDEBUG
+   counter += n;
+   // check for counter roll-over (change to 64-bit counter if this ever happens)
+   assert(counter >= int32u(n));
+   // check for explicit seeding prior to use
+   assert(initialized);
+#endif
+   if (n > 0)
+      fill(&x(0), n);
+   }
+
+void random::fval_closed(vector<double>& x)
+   {
+   vector<int32u> u(x.size());
+   ival(u);
+   const double m = double(get_max());
+   for (int i = 0; i < x.size(); i++)
+      x(i) = u(i) / m;
+   }
+
+/*!
+ * \brief Fill vector with Gaussian-distributed values
+ *
+ * Uses the same polar method as gval(), with the uniform deviates obtained
+ * in bulk. Since each pair of uniform deviates yields at most two Gaussian
+ * values, each batch is sized so that no more deviates are consumed than
+ * with repeated calls to gval(); any unused value is kept for the next call.
+ */
+void random::gval(vector<double>& x, double sigma)
+   {
+   const int n = x.size();
+   int k = 0;
+   // use up any stored value first
+   if (n > 0 && next_gval_available)
+      {
+      next_gval_available = false;
+      x(k++) = next_gval * sigma;
+      }
+   const double m = double(get_max());
+   vector<int32u> u;
+   while (k < n)
+      {
+      const int pairs = (n - k + 1) / 2;
+      u.init(2 * pairs);
+      ival(u);
+      for (int j = 0; j < pairs; j++)
+         {
+         const double v1 = 2.0 * (u(2 * j) / m) - 1.0;
+         const double v2 = 2.0 * (u(2 * j + 1) / m) - 1.0;
+         const double rsq = (v1 * v1) + (v2 * v2);
+         if (rsq >= 1.0 || rsq == 0.0)
+            continue;
+         const double fac = sqrt(-2.0 * log(rsq) / rsq);
+         x(k++) = (v1 * fac) * sigma;
+         if (k < n)
+            x(k++) = (v2 * fac) * sigma;
+         else
+            {
+            next_gval = v2 * fac;
+            next_gval_available = true;
+            }
+         }
+      }
+   }
+
 } // end namespace
@@ -31,6 +31,9 @@
 
 namespace libbase {
 
+template <class T>
+class vector;
+
 /*!
  * \brief   Random Generator Base Class.
  * \author  Johann Briffa
@@ -44,6 +47,12 @@ namespace libbase {
  * integer, real (uniform), and Gaussian deviate conversion facility.
  * Implementations of actual random generators are created by deriving
  * from this class and providing the necessary virtual functions.
+ *
+ * The bulk interface fills a whole vector at a time; derived classes may
+ * override fill() to avoid the per-value virtual call to advance(). Bulk
+ * functions consume the underlying sequence exactly as the corresponding
+ * repeated scalar calls would, so that the two can be mixed freely without
+ * affecting the values obtained.
  */
 
 class random {
@@ -71,6 +80,8 @@ protected:
    virtual int32u get_value() const = 0;
    //! The largest returnable value
    virtual int32u get_max() const = 0;
+   //! Advance generator by 'n' steps, storing each output value
+   virtual void fill(int32u* values, const int n);
    // @}
 
 public:
@@ -109,6 +120,20 @@ public:
       return gval() * sigma;
       }
    // @}
+
+   /*! \name Bulk random generator interface */
+   //! The largest value returned by ival()
+   int32u ival_max() const
+      {
+      return get_max();
+      }
+   //! Fill vector with uniformly-distributed unsigned integers in [0,ival_max()]
+   void ival(vector<int32u>& x);
+   //! Fill vector with uniformly-distributed values in closed interval [0,1]
+   void fval_closed(vector<double>& x);
+   //! Fill vector with Gaussian-distributed values (zero mean, variance sigma^2)
+   void gval(vector<double>& x, double sigma = 1.0);
+   // @}
 };
 
 inline int32u random::ival()
@@ -23,10 +23,13 @@
  */
 
 #include "fba2.h"
+#include "logrealfast_v.h"
 #include "pacifier.h"
 #include "vectorutils.h"
 #include "cputimer.h"
 #include <iomanip>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 namespace libcomm {
 
@@ -39,6 +42,97 @@ namespace libcomm {
 #  define DEBUG 1
 #endif
 
+// Thread settings
+
+int fba2_threads::threads = 1;
+
+/*! \brief Determine the part of the range [first, last] for thread t
+ * The range is split into contiguous parts of (nearly) equal size; the part
+ * for thread t is returned as [lo, hi], which is empty if hi < lo.
+ */
+static inline void fba2_partition(const int first, const int last,
+      const int t, const int threads, int& lo, int& hi)
+   {
+   const int size = last - first + 1;
+   lo = first + int((libbase::int64s(size) * t) / threads);
+   hi = first + int((libbase::int64s(size) * (t + 1)) / threads) - 1;
+   }
+
+// Recursion kernels
+
+/*! \brief Accumulate y[k] += a * x[k], for k in [0, n-1]
+ */
+template <class real>
+static inline void fba2_axpy(real *y, const real& a, const real *x,
+      const int n)
+   {
+   for (int k = 0; k < n; k++)
+      y[k] += a * x[k];
+   }
+
+/*! \brief Accumulate y += b[k] * g(d)[k], for k in [0, n-1] and all d
+ * Terms are added in order of k, then d.
+ */
+template <class real>
+static inline void fba2_dot(real& y, const real *b,
+      const libbase::vector<const real *>& g, const int n)
+   {
+   for (int k = 0; k < n; k++)
+      for (int d = 0; d < g.size(); d++)
+         y += b[k] * g(d)[k];
+   }
+
+/*! \brief Accumulate y[k] += a * x[k] (logrealfast, using vector type)
+ */
+static inline void fba2_axpy(libbase::logrealfast *y,
+      const libbase::logrealfast& a, const libbase::logrealfast *x,
+      const int n)
+   {
+   libbase::logrealfast_v<4> v, w;
+   int k = 0;
+   for (; k + 4 <= n; k += 4)
+      {
+      v.load(x + k);
+      v *= a;
+      w.load(y + k);
+      w += v;
+      w.store(y + k);
+      }
+   for (; k < n; k++)
+      y[k] += a * x[k];
+   }
+
+/*! \brief Accumulate y += b[k] * g(d)[k] (logrealfast, using vector type)
+ * Partial sums are kept for each of four consecutive values of k, so the
+ * order of addition differs from the generic version.
+ */
+static inline void fba2_dot(libbase::logrealfast& y,
+      const libbase::logrealfast *b,
+      const libbase::vector<const libbase::logrealfast *>& g, const int n)
+   {
+   int k = 0;
+   if (n >= 4)
+      {
+      libbase::logrealfast_v<4> acc, v, bv;
+      acc.zero();
+      for (; k + 4 <= n; k += 4)
+         {
+         bv.load(b + k);
+         for (int d = 0; d < g.size(); d++)
+            {
+            v.load(g(d) + k);
+            v *= bv;
+            acc += v;
+            }
+         }
+      for (int j = 0; j < 4; j++)
+         y += acc.get(j);
+      }
+   for (; k < n; k++)
+      for (int d = 0; d < g.size(); d++)
+         y += b[k] * g(d)[k];
+   }
+
 // Memory allocation
 
 /*! \brief Memory allocator for working matrices
@@ -187,27 +281,88 @@ template <class real, class sig, bool norm>
 void fba2<real, sig, norm>::work_alpha(const array1d_t& sof_prior)
    {
    assert(initialised);
-   libbase::pacifier progress("FBA Alpha");
-   // local flag for path thresholding
-   const bool thresholding = (th_inner > real(0));
    // initialise array:
    alpha = real(0);
    // set initial drift distribution
    for (int x = -xmax; x <= xmax; x++)
       alpha[0][x] = real(sof_prior(xmax + x));
-   // compute remaining matrix values
+   // compute remaining matrix values, with the drift range split over threads
+   const int threads = std::min(fba2_threads::get(), 2 * xmax + 1);
+   boost::barrier sync(threads);
+   array1r_t scale(N + 1);
+   boost::thread_group workers;
+   for (int t = 1; t < threads; t++)
+      workers.create_thread(boost::bind(&This::work_alpha_part, this, t,
+            threads, &sync, boost::ref(scale)));
+   work_alpha_part(0, threads, &sync, scale);
+   workers.join_all();
+   // normalize if requested
+   if (norm)
+      {
+      for (int i = 1; i <= N; i++)
+         for (int x = -xmax; x <= xmax; x++)
+            alpha[i][x] *= scale(i);
+      }
+   }
+
+/*! \brief Forward recursion, for the part of the drift range of thread t
+ * \param[in] t Index of this thread, where thread zero reports progress
+ * \param[in] threads Total number of threads
+ * \param[in] sync Barrier used to wait for all threads at each time step
+ * \param[out] scale Normalization factor for each time step (only written
+ *                   by thread zero; the factors are applied by the caller)
+ *
+ * Each thread computes alpha[i][x2] for its own values of x2, from the
+ * complete set of values at the previous time step; the previous values are
+ * normalized as they are read. Since the receiver metric is cached for all
+ * end drifts together, the cache entries needed at each time step are first
+ * filled by the thread owning the corresponding start drift.
+ */
+template <class real, class sig, bool norm>
+void fba2<real, sig, norm>::work_alpha_part(const int t,
+      const int threads, boost::barrier* sync, array1r_t& scale)
+   {
+   libbase::pacifier progress("FBA Alpha");
+   // local flag for path thresholding
+   const bool thresholding = (th_inner > real(0));
+   // determine the drift range for this thread
+   int x2lo, x2hi;
+   fba2_partition(-xmax, xmax, t, threads, x2lo, x2hi);
+   // normalization factor for the previous time step
+   real prev_scale = 1;
    for (int i = 1; i <= N; i++)
       {
-      std::cerr << progress.update(i - 1, N);
+      if (t == 0)
+         std::cerr << progress.update(i - 1, N);
       // determine the strongest path at this point
       real threshold = 0;
       if (thresholding)
          {
          for (int x1 = -xmax; x1 <= xmax; x1++)
-            if (alpha[i - 1][x1] > threshold)
-               threshold = alpha[i - 1][x1];
+            {
+            const real a = norm ? alpha[i - 1][x1] * prev_scale
+                  : alpha[i - 1][x1];
+            if (a > threshold)
+               threshold = a;
+            }
          threshold *= th_inner;
          }
+      // the receiver metric is cached for all end drifts at once, so with
+      // several threads each one first fills the entries for its own part
+      // of the start drift range
+      if (threads > 1 && cache_enabled)
+         {
+         for (int x1 = x2lo; x1 <= x2hi; x1++)
+            {
+            const real a = norm ? alpha[i - 1][x1] * prev_scale
+                  : alpha[i - 1][x1];
+            if (thresholding && a < threshold)
+               continue;
+            if (!cached[i - 1][x1][0])
+               fill_gamma(i - 1, x1);
+            }
+         sync->wait();
+         }
       // limits on insertions and deletions must be respected:
       //   x2-x1 <= n*I
       //   x2-x1 >= -n
@@ -217,55 +372,122 @@ void fba2<real, sig, norm>::work_alpha(const array1d_t& sof_prior)
       //   x2-x1 >= -dxmax
       for (int x1 = -xmax; x1 <= xmax; x1++)
          {
+         const real a = norm ? alpha[i - 1][x1] * prev_scale
+               : alpha[i - 1][x1];
          // ignore paths below a certain threshold
-         if (thresholding && alpha[i - 1][x1] < threshold)
+         if (thresholding && a < threshold)
             continue;
-         const int x2min = std::max(-xmax, dmin + x1);
-         const int x2max = std::min(xmax, dmax + x1);
-         for (int x2 = x2min; x2 <= x2max; x2++)
+         // restrict to the drift range for this thread
+         const int x2min = std::max(x2lo, dmin + x1);
+         const int x2max = std::min(x2hi, dmax + x1);
+         if (cache_enabled)
+            {
+            // work on the cached metrics directly, for all end drifts at once
+            if (x2min > x2max)
+               continue;
+            if (!cached[i - 1][x1][x2min - x1])
+               fill_gamma(i - 1, x1);
+#ifndef NDEBUG
+            gamma_calls += q * (x2max - x2min + 1);
+#endif
             for (int d = 0; d < q; d++)
-               alpha[i][x2] += alpha[i - 1][x1] * get_gamma(d, i - 1, x1, x2
-                     - x1);
+               fba2_axpy(&alpha[i][x2min], a, &gamma[d][i - 1][x1][x2min
+                     - x1], x2max - x2min + 1);
+            }
+         else
+            {
+            for (int x2 = x2min; x2 <= x2max; x2++)
+               for (int d = 0; d < q; d++)
+                  alpha[i][x2] += a * get_gamma(d, i - 1, x1, x2 - x1);
+            }
          }
-      // normalize if requested
-      // TODO: refactor this out to a separate method
+      // wait for all threads to complete this time step
+      sync->wait();
+      // determine the normalization factor, if requested
       if (norm)
          {
-         real scale = 0;
-         for (int x = -xmax; x <= xmax; x++)
-            scale += alpha[i][x];
-         assertalways(scale > real(0));
-         scale = real(1) / scale;
+         real sum = 0;
          for (int x = -xmax; x <= xmax; x++)
-            alpha[i][x] *= scale;
+            sum += alpha[i][x];
+         assertalways(sum > real(0));
+         prev_scale = real(1) / sum;
+         if (t == 0)
+            scale(i) = prev_scale;
          }
       }
-   std::cerr << progress.update(N, N);
+   if (t == 0)
+      std::cerr << progress.update(N, N);
    }
 
 template <class real, class sig, bool norm>
 void fba2<real, sig, norm>::work_beta(const array1d_t& eof_prior)
    {
    assert(initialised);
-   libbase::pacifier progress("FBA Beta");
-   // local flag for path thresholding
-   const bool thresholding = (th_inner > real(0));
    // initialise array:
    beta = real(0);
    // set final drift distribution
    for (int x = -xmax; x <= xmax; x++)
       beta[N][x] = real(eof_prior(xmax + x));
-   // compute remaining matrix values
+   // compute remaining matrix values, with the drift range split over threads
+   const int threads = std::min(fba2_threads::get(), 2 * xmax + 1);
+   boost::barrier sync(threads);
+   array1r_t scale(N + 1);
+   boost::thread_group workers;
+   for (int t = 1; t < threads; t++)
+      workers.create_thread(boost::bind(&This::work_beta_part, this, t,
+            threads, &sync, boost::ref(scale)));
+   work_beta_part(0, threads, &sync, scale);
+   workers.join_all();
+   // normalize if requested
+   if (norm)
+      {
+      for (int i = N - 1; i >= 0; i--)
+         for (int x = -xmax; x <= xmax; x++)
+            beta[i][x] *= scale(i);
+      }
+   }
+
+/*! \brief Backward recursion, for the part of the drift range of thread t
+ * \param[in] t Index of this thread, where thread zero reports progress
+ * \param[in] threads Total number of threads
+ * \param[in] sync Barrier used to wait for all threads at each time step
+ * \param[out] scale Normalization factor for each time step (only written
+ *                   by thread zero; the factors are applied by the caller)
+ *
+ * Each thread computes beta[i][x1] for its own values of x1, from the
+ * complete set of values at the next time step; the next values are
+ * normalized as they are read.
+ */
+template <class real, class sig, bool norm>
+void fba2<real, sig, norm>::work_beta_part(const int t, const int threads,
+      boost::barrier* sync, array1r_t& scale)
+   {
+   libbase::pacifier progress("FBA Beta");
+   // local flag for path thresholding
+   const bool thresholding = (th_inner > real(0));
+   // determine the drift range for this thread
+   int x1lo, x1hi;
+   fba2_partition(-xmax, xmax, t, threads, x1lo, x1hi);
+   // normalization factor for the next time step
+   real next_scale = 1;
+   // working space for cached-metric recursion
+   array1r_t bs(2 * xmax + 1);
+   libbase::vector<const real *> gs(q);
    for (int i = N - 1; i >= 0; i--)
       {
-      std::cerr << progress.update(N - 1 - i, N);
+      if (t == 0)
+         std::cerr << progress.update(N - 1 - i, N);
       // determine the strongest path at this point
       real threshold = 0;
       if (thresholding)
          {
          for (int x2 = -xmax; x2 <= xmax; x2++)
-            if (beta[i + 1][x2] > threshold)
-               threshold = beta[i + 1][x2];
+            {
+            const real b = norm ? beta[i + 1][x2] * next_scale
+                  : beta[i + 1][x2];
+            if (b > threshold)
+               threshold = b;
+            }
          threshold *= th_inner;
          }
       // limits on insertions and deletions must be respected:
@@ -275,46 +497,115 @@ void fba2<real, sig, norm>::work_beta(const array1d_t& eof_prior)
       // (necessary for forward recursion on extracted segment)
       //   x2-x1 <= dxmax
       //   x2-x1 >= -dxmax
-      for (int x2 = -xmax; x2 <= xmax; x2++)
+      if (cache_enabled)
          {
-         // ignore paths below a certain threshold
-         if (thresholding && beta[i + 1][x2] < threshold)
-            continue;
-         const int x1min = std::max(-xmax, x2 - dmax);
-         const int x1max = std::min(xmax, x2 - dmin);
-         for (int x1 = x1min; x1 <= x1max; x1++)
+         // normalized next values, with paths below threshold set to zero
+         for (int x2 = -xmax; x2 <= xmax; x2++)
+            {
+            const real b = norm ? beta[i + 1][x2] * next_scale
+                  : beta[i + 1][x2];
+            bs(xmax + x2) = (thresholding && b < threshold) ? real(0) : b;
+            }
+         // work on the cached metrics directly, for all end drifts at once
+         for (int x1 = x1lo; x1 <= x1hi; x1++)
+            {
+            // skip zero values at either end of the end drift range
+            int x2min = std::max(-xmax, x1 + dmin);
+            int x2max = std::min(xmax, x1 + dmax);
+            while (x2min <= x2max && bs(xmax + x2min) == real(0))
+               x2min++;
+            while (x2max >= x2min && bs(xmax + x2max) == real(0))
+               x2max--;
+            if (x2min > x2max)
+               continue;
+            if (!cached[i][x1][x2min - x1])
+               fill_gamma(i, x1);
+#ifndef NDEBUG
+            gamma_calls += q * (x2max - x2min + 1);
+#endif
             for (int d = 0; d < q; d++)
-               beta[i][x1] += beta[i + 1][x2] * get_gamma(d, i, x1, x2 - x1);
+               gs(d) = &gamma[d][i][x1][x2min - x1];
+            fba2_dot(beta[i][x1], &bs(xmax + x2min), gs, x2max - x2min + 1);
+            }
          }
-      // normalize if requested
-      // TODO: refactor this out to a separate method
+      else
+         {
+         for (int x2 = -xmax; x2 <= xmax; x2++)
+            {
+            const real b = norm ? beta[i + 1][x2] * next_scale
+                  : beta[i + 1][x2];
+            // ignore paths below a certain threshold
+            if (thresholding && b < threshold)
+               continue;
+            // restrict to the drift range for this thread
+            const int x1min = std::max(x1lo, x2 - dmax);
+            const int x1max = std::min(x1hi, x2 - dmin);
+            for (int x1 = x1min; x1 <= x1max; x1++)
+               for (int d = 0; d < q; d++)
+                  beta[i][x1] += b * get_gamma(d, i, x1, x2 - x1);
+            }
+         }
+      // wait for all threads to complete this time step
+      sync->wait();
+      // determine the normalization factor, if requested
       if (norm)
          {
-         real scale = 0;
+         real sum = 0;
          for (int x = -xmax; x <= xmax; x++)
-            scale += beta[i][x];
-         assertalways(scale > real(0));
-         scale = real(1) / scale;
-         for (int x = -xmax; x <= xmax; x++)
-            beta[i][x] *= scale;
+            sum += beta[i][x];
+         assertalways(sum > real(0));
+         next_scale = real(1) / sum;
+         if (t == 0)
+            scale(i) = next_scale;
          }
       }
-   std::cerr << progress.update(N, N);
+   if (t == 0)
+      std::cerr << progress.update(N, N);
    }
 
 template <class real, class sig, bool norm>
 void fba2<real, sig, norm>::work_message_app(array1vr_t& ptable) const
    {
    assert(initialised);
+   // Initialise result vector (one sparse symbol per timestep)
+   libbase::allocate(ptable, N, q);
+   // compute results, with the time steps split over threads
+   const int threads = std::max(1, std::min(fba2_threads::get(), N));
+   boost::thread_group workers;
+   for (int t = 1; t < threads; t++)
+      workers.create_thread(boost::bind(&This::work_message_app_part, this, t,
+            threads, boost::ref(ptable)));
+   work_message_app_part(0, threads, ptable);
+   workers.join_all();
+#ifndef NDEBUG
+   // show cache statistics
+   std::cerr << "FBA Cache Usage: " << 100 * gamma_misses
+         / double(cached.num_elements()) << "%" << std::endl;
+   std::cerr << "FBA Cache Reuse: " << gamma_calls / double(gamma_misses * q)
+         << "x" << std::endl;
+#endif
+   }
+
+/*! \brief Message APPs, for the part of the time range of thread t
+ * \param[in] t Index of this thread, where thread zero reports progress
+ * \param[in] threads Total number of threads
+ * \param[out] ptable Posterior probabilities for message (pre-allocated)
+ */
+template <class real, class sig, bool norm>
+void fba2<real, sig, norm>::work_message_app_part(const int t,
+      const int threads, array1vr_t& ptable) const
+   {
    libbase::pacifier progress("FBA Results");
    // local flag for path thresholding
    const bool thresholding = (th_outer > real(0));
-   // Initialise result vector (one sparse symbol per timestep)
-   libbase::allocate(ptable, N, q);
+   // determine the time range for this thread
+   int ilo, ihi;
+   fba2_partition(0, N - 1, t, threads, ilo, ihi);
    // ptable(i,d) is the a posteriori probability of having transmitted symbol 'd' at time 'i'
-   for (int i = 0; i < N; i++)
+   for (int i = ilo; i <= ihi; i++)
       {
-      std::cerr << progress.update(i, N);
+      if (t == 0)
+         std::cerr << progress.update(i - ilo, ihi - ilo + 1);
       // determine the strongest path at this point
       real threshold = 0;
       if (thresholding)
@@ -348,15 +639,8 @@ void fba2<real, sig, norm>::work_message_app(array1vr_t& ptable) const
          ptable(i)(d) = p;
          }
       }
-   if (N > 0)
-      std::cerr << progress.update(N, N);
-#ifndef NDEBUG
-   // show cache statistics
-   std::cerr << "FBA Cache Usage: " << 100 * gamma_misses
-         / double(cached.num_elements()) << "%" << std::endl;
-   std::cerr << "FBA Cache Reuse: " << gamma_calls / double(gamma_misses * q)
-         << "x" << std::endl;
-#endif
+   if (t == 0 && ihi >= ilo)
+      std::cerr << progress.update(ihi - ilo + 1, ihi - ilo + 1);
    }
 
 template <class real, class sig, bool norm>
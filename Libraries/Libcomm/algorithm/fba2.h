@@ -38,8 +38,38 @@
 #include <fstream>
 #include <sstream>
 
+namespace boost {
+class barrier;
+}
+
 namespace libcomm {
 
+/*!
+ * \brief   Thread settings for the symbol-level forward-backward algorithm.
+ * \author  Johann Briffa
+ *
+ * Holds the number of threads over which each decoding of fba2 is split;
+ * this is a process-wide setting, as it depends on the machine rather than
+ * on the system being simulated.
+ */
+
+class fba2_threads {
+private:
+   static int threads; //!< Number of threads used by each decoder
+public:
+   //! Set number of threads used by each decoder (1 for serial computation)
+   static void set(int threads)
+      {
+      assertalways(threads >= 1);
+      fba2_threads::threads = threads;
+      }
+   //! Get number of threads used by each decoder
+   static int get()
+      {
+      return threads;
+      }
+};
+
 /*!
  * \brief   Symbol-Level Forward-Backward Algorithm.
  * \author  Johann Briffa
@@ -53,6 +83,14 @@ namespace libcomm {
  * new decoder for Davey & McKay's inner codes, originally introduced in
  * "Watermark Codes: Reliable communication over Insertion/Deletion channels",
  * Trans. IT, 47(2), Feb 2001.
+ *
+ * The forward and backward recursions can be split over a number of threads
+ * (see fba2_threads), following the same decomposition as the CUDA version:
+ * at each time step, every thread computes the metrics for its own part of
+ * the drift range, with a barrier between time steps. The normalization
+ * factor for each step is computed redundantly by every thread and applied
+ * when reading the previous step, so that the results are identical to the
+ * serial computation. The final results are split over time steps.
  */
 
 template <class real, class sig, bool norm>
@@ -94,14 +132,15 @@ private:
    array1s_t r; //!< Copy of received sequence, for lazy computation of gamma
    array1vd_t app; //!< Copy of a-priori statistics, for lazy computation of gamma
 #ifndef NDEBUG
-   mutable int gamma_calls; //!< Number of gamma computations
-   mutable int gamma_misses; //!< Number of gamma computations causing a cache miss
+   mutable int gamma_calls; //!< Number of gamma computations (approximate if multi-threaded)
+   mutable int gamma_misses; //!< Number of gamma computations causing a cache miss (approximate if multi-threaded)
 #endif
    mutable dminner2_receiver<real> receiver; //!< Inner code receiver metric computation
    // @}
 private:
    /*! \name Internal functions */
    real compute_gamma(int d, int i, int x, int deltax) const;
+   void fill_gamma(int i, int x) const;
    real get_gamma(int d, int i, int x, int deltax) const;
    // memory allocation
    void allocate();
@@ -115,6 +154,12 @@ protected:
    void work_alpha(const array1d_t& sof_prior);
    void work_beta(const array1d_t& eof_prior);
    void work_message_app(array1vr_t& ptable) const;
+   void work_alpha_part(const int t, const int threads, boost::barrier* sync,
+         array1r_t& scale);
+   void work_beta_part(const int t, const int threads, boost::barrier* sync,
+         array1r_t& scale);
+   void work_message_app_part(const int t, const int threads,
+         array1vr_t& ptable) const;
    void work_state_app(array1r_t& ptable, const int i) const;
    void work_results(array1vr_t& ptable, array1r_t& sof_post,
          array1r_t& eof_post) const;
@@ -162,21 +207,43 @@ inline real fba2<real, sig, norm>::compute_gamma(int d, int i, int x,
    return result;
    }
 
+/*! \brief Fill the receiver metric cache for a given symbol and start drift
+ *
+ * Computes gamma[d][i][x][deltax] for all symbols 'd' and for all 'deltax'
+ * that keep the end drift within range, using a single batch computation
+ * over the longest received segment; the entries are then flagged as cached.
+ */
 template <class real, class sig, bool norm>
-real fba2<real, sig, norm>::get_gamma(int d, int i, int x, int deltax) const
+void fba2<real, sig, norm>::fill_gamma(int i, int x) const
    {
-   if (!cache_enabled)
-      return compute_gamma(d, i, x, deltax);
-
-   if (!cached[i][x][deltax])
+   const int dlo = std::max(dmin, -xmax - x);
+   const int dhi = std::min(dmax, xmax - x);
+   libbase::matrix<bsid::real> ptable;
+   receiver.R(i, r.extract(xmax + n * i + x, n + dhi), dlo, ptable);
+   for (int deltax = dlo; deltax <= dhi; deltax++)
       {
       cached[i][x][deltax] = true;
       for (int d = 0; d < q; d++)
-         gamma[d][i][x][deltax] = compute_gamma(d, i, x, deltax);
+         {
+         real result = ptable(d, deltax - dlo);
+         if (app.size() > 0)
+            result *= real(app(i)(d));
+         gamma[d][i][x][deltax] = result;
+         }
+      }
 #ifndef NDEBUG
-      gamma_misses++;
+   gamma_misses += dhi - dlo + 1;
 #endif
-      }
+   }
+
+template <class real, class sig, bool norm>
+real fba2<real, sig, norm>::get_gamma(int d, int i, int x, int deltax) const
+   {
+   if (!cache_enabled)
+      return compute_gamma(d, i, x, deltax);
+
+   if (!cached[i][x][deltax])
+      fill_gamma(i, x);
 #ifndef NDEBUG
    gamma_calls++;
 #endif
@@ -0,0 +1,1025 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "logmap_bcjr.h"
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace libcomm {
+
+// Vector operations on metrics
+
+/*!
+ * \brief   Vector operations on log-domain metrics.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Each specialization defines a register type 'vec' holding 'width' metrics,
+ * together with the (unaligned) load/store and arithmetic operations needed
+ * by the recursions. Arithmetic on fixed-point metrics saturates.
+ * A scalar fallback is used when no vector extensions are available.
+ */
+
+template <class T>
+struct logmap_ops {
+};
+
+template <>
+struct logmap_ops<float> {
+   typedef float scalar;
+   //! Metric units per nat
+   static double scale()
+      {
+      return 1.0;
+      }
+   //! Metric representing log(0)
+   static scalar logzero()
+      {
+      return -1e30f;
+      }
+   static scalar quantize(const double x)
+      {
+      return x > logzero() ? scalar(x) : logzero();
+      }
+   /*! \name Scalar operations */
+   static scalar smax(const scalar a, const scalar b)
+      {
+      return a > b ? a : b;
+      }
+   static scalar smin(const scalar a, const scalar b)
+      {
+      return a < b ? a : b;
+      }
+   static scalar sadd(const scalar a, const scalar b)
+      {
+      return a + b;
+      }
+   static scalar ssub(const scalar a, const scalar b)
+      {
+      return a - b;
+      }
+   // @}
+#if defined(__SSE2__)
+   typedef __m128 vec;
+   static const int width = 4;
+   //! Returns p[idx[0..width-1]]
+   static vec gather(const scalar* p, const int* idx)
+      {
+      return _mm_set_ps(p[idx[3]], p[idx[2]], p[idx[1]], p[idx[0]]);
+      }
+   static vec load(const scalar* p)
+      {
+      return _mm_loadu_ps(p);
+      }
+   static void store(scalar* p, const vec a)
+      {
+      _mm_storeu_ps(p, a);
+      }
+   static vec set1(const scalar x)
+      {
+      return _mm_set1_ps(x);
+      }
+   static vec add(const vec a, const vec b)
+      {
+      return _mm_add_ps(a, b);
+      }
+   static vec sub(const vec a, const vec b)
+      {
+      return _mm_sub_ps(a, b);
+      }
+   static vec max(const vec a, const vec b)
+      {
+      return _mm_max_ps(a, b);
+      }
+   static vec min(const vec a, const vec b)
+      {
+      return _mm_min_ps(a, b);
+      }
+   //! Returns the largest element, in all positions
+   static vec hmax(const vec a)
+      {
+      const vec m = _mm_max_ps(a, _mm_shuffle_ps(a, a, 0x4e));
+      return _mm_max_ps(m, _mm_shuffle_ps(m, m, 0xb1));
+      }
+   //! Returns c where a < b, and zero elsewhere
+   static vec select_lt(const vec a, const vec b, const vec c)
+      {
+      return _mm_and_ps(_mm_cmplt_ps(a, b), c);
+      }
+#else
+   typedef scalar vec;
+   static const int width = 1;
+   //! Returns p[idx[0..width-1]]
+   static vec gather(const scalar* p, const int* idx)
+      {
+      return p[idx[0]];
+      }
+   static vec load(const scalar* p)
+      {
+      return *p;
+      }
+   static void store(scalar* p, const vec a)
+      {
+      *p = a;
+      }
+   static vec set1(const scalar x)
+      {
+      return x;
+      }
+   static vec add(const vec a, const vec b)
+      {
+      return a + b;
+      }
+   static vec sub(const vec a, const vec b)
+      {
+      return a - b;
+      }
+   static vec max(const vec a, const vec b)
+      {
+      return a > b ? a : b;
+      }
+   static vec min(const vec a, const vec b)
+      {
+      return a < b ? a : b;
+      }
+   //! Returns the largest element, in all positions
+   static vec hmax(const vec a)
+      {
+      return a;
+      }
+   //! Returns c where a < b, and zero elsewhere
+   static vec select_lt(const vec a, const vec b, const vec c)
+      {
+      return a < b ? c : 0;
+      }
+#endif
+};
+
+template <>
+struct logmap_ops<libbase::int16s> {
+   typedef libbase::int16s scalar;
+   //! Metric units per nat
+   static double scale()
+      {
+      return 16.0;
+      }
+   //! Metric representing log(0)
+   /*! \note This is chosen so that the sum or difference of any two metrics
+    * in range can never wrap around (ie. at most saturates).
+    */
+   static scalar logzero()
+      {
+      return -16384;
+      }
+   static scalar quantize(const double x)
+      {
+      const double y = x * scale();
+      if (!(y > logzero()))
+         return logzero();
+      if (y > -logzero())
+         return -logzero();
+      // round to nearest
+      return scalar(y < 0 ? y - 0.5 : y + 0.5);
+      }
+   /*! \name Scalar operations */
+   static scalar saturate(const int x)
+      {
+      return scalar(std::max(-32768, std::min(32767, x)));
+      }
+   static scalar smax(const scalar a, const scalar b)
+      {
+      return a > b ? a : b;
+      }
+   static scalar smin(const scalar a, const scalar b)
+      {
+      return a < b ? a : b;
+      }
+   static scalar sadd(const scalar a, const scalar b)
+      {
+      return saturate(int(a) + int(b));
+      }
+   static scalar ssub(const scalar a, const scalar b)
+      {
+      return saturate(int(a) - int(b));
+      }
+   // @}
+#if defined(__SSE2__)
+   typedef __m128i vec;
+   static const int width = 8;
+   //! Returns p[idx[0..width-1]]
+   static vec gather(const scalar* p, const int* idx)
+      {
+      return _mm_set_epi16(p[idx[7]], p[idx[6]], p[idx[5]], p[idx[4]],
+            p[idx[3]], p[idx[2]], p[idx[1]], p[idx[0]]);
+      }
+   static vec load(const scalar* p)
+      {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i*> (p));
+      }
+   static void store(scalar* p, const vec a)
+      {
+      _mm_storeu_si128(reinterpret_cast<__m128i*> (p), a);
+      }
+   static vec set1(const scalar x)
+      {
+      return _mm_set1_epi16(x);
+      }
+   static vec add(const vec a, const vec b)
+      {
+      return _mm_adds_epi16(a, b);
+      }
+   static vec sub(const vec a, const vec b)
+      {
+      return _mm_subs_epi16(a, b);
+      }
+   static vec max(const vec a, const vec b)
+      {
+      return _mm_max_epi16(a, b);
+      }
+   static vec min(const vec a, const vec b)
+      {
+      return _mm_min_epi16(a, b);
+      }
+   //! Returns the largest element, in all positions
+   static vec hmax(const vec a)
+      {
+      vec m = _mm_max_epi16(a, _mm_shuffle_epi32(a, 0x4e));
+      m = _mm_max_epi16(m, _mm_shuffle_epi32(m, 0xb1));
+      return _mm_max_epi16(m, _mm_shufflehi_epi16(_mm_shufflelo_epi16(m,
+            0xb1), 0xb1));
+      }
+   //! Returns c where a < b, and zero elsewhere
+   static vec select_lt(const vec a, const vec b, const vec c)
+      {
+      return _mm_and_si128(_mm_cmplt_epi16(a, b), c);
+      }
+#else
+   typedef scalar vec;
+   static const int width = 1;
+   //! Returns p[idx[0..width-1]]
+   static vec gather(const scalar* p, const int* idx)
+      {
+      return p[idx[0]];
+      }
+   static vec load(const scalar* p)
+      {
+      return *p;
+      }
+   static void store(scalar* p, const vec a)
+      {
+      *p = a;
+      }
+   static vec set1(const scalar x)
+      {
+      return x;
+      }
+   static vec add(const vec a, const vec b)
+      {
+      return saturate(int(a) + int(b));
+      }
+   static vec sub(const vec a, const vec b)
+      {
+      return saturate(int(a) - int(b));
+      }
+   static vec max(const vec a, const vec b)
+      {
+      return a > b ? a : b;
+      }
+   static vec min(const vec a, const vec b)
+      {
+      return a < b ? a : b;
+      }
+   //! Returns the largest element, in all positions
+   static vec hmax(const vec a)
+      {
+      return a;
+      }
+   //! Returns c where a < b, and zero elsewhere
+   static vec select_lt(const vec a, const vec b, const vec c)
+      {
+      return a < b ? c : 0;
+      }
+#endif
+};
+
+// Max* operator
+
+/*!
+ * \brief   Correction table for the log-MAP max* operator.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * The correction term ln(1+exp(-d)) for d = |a-b| is tabulated over
+ * 'size' intervals of width 'step' nats, using the value at the centre of
+ * each interval; beyond the table range the correction is zero.
+ * For vector evaluation the table is also held as a set of thresholds and
+ * the (non-negative) differences between successive entries, so that the
+ * lookup becomes a sum of masked constants.
+ */
+
+template <class T>
+struct logmap_table {
+   typedef logmap_ops<T> ops;
+   static const int size = 8;
+   //! Interval width in nats
+   static double step()
+      {
+      return 0.5;
+      }
+   T value[size]; //!< Correction for each interval
+   T threshold[size]; //!< Upper limit of each interval
+   T delta[size]; //!< value[k] - value[k+1], with value[size] = 0
+   double inv_step; //!< Reciprocal of interval width, in metric units
+   logmap_table()
+      {
+      inv_step = 1 / (step() * ops::scale());
+      for (int k = 0; k < size; k++)
+         {
+         value[k] = ops::quantize(log(1 + exp(-(k + 0.5) * step())));
+         threshold[k] = ops::quantize((k + 1) * step());
+         }
+      for (int k = 0; k < size; k++)
+         delta[k] = T(value[k] - (k + 1 < size ? value[k + 1] : T(0)));
+      }
+   //! Scalar max* operator
+   T maxstar(const T a, const T b) const
+      {
+      const T mx = ops::smax(a, b);
+      const double k = ops::ssub(mx, ops::smin(a, b)) * inv_step;
+      if (k < size)
+         return ops::sadd(mx, value[int(k)]);
+      return mx;
+      }
+   //! Shared instance
+   static const logmap_table& get()
+      {
+      static const logmap_table table;
+      return table;
+      }
+};
+
+/*!
+ * \brief   Vector max* operator.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Holds the correction table in registers; when 'correct' is false this
+ * reduces to the max-log approximation.
+ */
+
+template <class T, bool correct>
+class logmap_maxstar {
+   typedef logmap_ops<T> ops;
+   typedef typename ops::vec vec;
+   typedef logmap_table<T> table_t;
+   const table_t& table;
+   vec threshold[table_t::size];
+   vec delta[table_t::size];
+public:
+   logmap_maxstar() :
+      table(table_t::get())
+      {
+      if (correct)
+         for (int k = 0; k < table_t::size; k++)
+            {
+            threshold[k] = ops::set1(table.threshold[k]);
+            delta[k] = ops::set1(table.delta[k]);
+            }
+      }
+   vec operator()(const vec a, const vec b) const
+      {
+      const vec mx = ops::max(a, b);
+      if (!correct)
+         return mx;
+      const vec d = ops::sub(mx, ops::min(a, b));
+      vec c = ops::set1(0);
+      for (int k = 0; k < table_t::size; k++)
+         c = ops::add(c, ops::select_lt(d, threshold[k], delta[k]));
+      return ops::add(mx, c);
+      }
+   T operator()(const T* x, const int n) const
+      {
+      T r = x[0];
+      for (int m = 1; m < n; m++)
+         r = correct ? table.maxstar(r, x[m]) : ops::smax(r, x[m]);
+      return r;
+      }
+};
+
+// Conversion between probabilities and metrics
+
+/*!
+ * \brief   Fast natural logarithm, for converting statistics to metrics.
+ *
+ * The argument is split into exponent and mantissa, and the logarithm of the
+ * mantissa is obtained from a short series; the absolute error is below
+ * 2e-5 nats, which is well within the resolution of the metrics. Arguments
+ * that are zero, or too small for a normalized float, give log-zero.
+ */
+inline float logmap_log(const double x)
+   {
+   if (!(x >= 1.2e-38))
+      return logmap_ops<float>::logzero();
+   if (x > 1e38)
+      return float(log(x));
+   union {
+      float f;
+      libbase::int32u i;
+   } u;
+   u.f = float(x);
+   const int e = int((u.i >> 23) & 0xff) - 127;
+   // mantissa in [1,2)
+   u.i = (u.i & 0x007fffff) | 0x3f800000;
+   // log(m) = 2 atanh(y), with y = (m-1)/(m+1) in [0,1/3)
+   const float y = (u.f - 1) / (u.f + 1);
+   const float y2 = y * y;
+   const float lm = 2 * y * (1 + y2 * (1.0f / 3 + y2 * (1.0f / 5 + y2 * (1.0f
+         / 7))));
+   return e * 0.693147181f + lm;
+   }
+
+/*!
+ * \brief   Fast exponential, for converting metrics to statistics.
+ *
+ * The argument (which must not be positive) is split into a power of two and
+ * a remainder in [0,ln 2), for which a short series is used; the relative
+ * error is below 2e-5. Results too small for a normalized float give zero.
+ */
+inline float logmap_exp(const float x)
+   {
+   assert(!(x > 0));
+   const float z = x * 1.44269504f;
+   if (!(z > -126))
+      return 0;
+   const int k = int(floor(z));
+   const float f = (z - k) * 0.693147181f;
+   const float p = 1 + f * (1 + f * (0.5f + f * (1.0f / 6 + f * (1.0f / 24 + f
+         * (1.0f / 120 + f * (1.0f / 720))))));
+   union {
+      float f;
+      libbase::int32u i;
+   } u;
+   u.i = libbase::int32u(k + 127) << 23;
+   return p * u.f;
+   }
+
+// Initialization
+
+/*!
+ * \brief   Creator for class 'logmap_bcjr'.
+ * \param   encoder     The finite state machine used to encode the source.
+ * \param   tau         The block length of decoder (including tail bits).
+ * \param   algorithm   The approximation to use for the max* operator.
+ * \param   metric      The numerical representation of internal metrics.
+ *
+ * \note Each state must have exactly K incoming branches, as is the case for
+ * all shift-register based encoders.
+ *
+ * \note If the trellis is not defined as starting or ending at zero, then it
+ * is assumed that all starting and ending states (respectively) are
+ * equiprobable.
+ */
+template <class dbl>
+void logmap_bcjr<dbl>::init(fsm& encoder, const int tau,
+      const algorithm_t algorithm, const metric_t metric)
+   {
+   assertalways(tau > 0);
+   assertalways(algorithm >= 0 && algorithm < algorithm_undefined);
+   assertalways(metric >= 0 && metric < metric_undefined);
+   logmap_bcjr::tau = tau;
+   logmap_bcjr::algorithm = algorithm;
+   logmap_bcjr::metric = metric;
+
+   // Initialise constants
+   K = encoder.num_input_combinations();
+   N = encoder.num_output_combinations();
+   M = encoder.num_states();
+   // Pad state space to a whole number of registers
+   const int W = (metric == metric_int16) ? logmap_ops<libbase::int16s>::width
+         : logmap_ops<float>::width;
+   Mp = (M + W - 1) / W * W;
+
+   // initialise LUT's for state table
+   lut_X.init(K, Mp);
+   lut_m.init(K, Mp);
+   lut_prev.init(K, Mp);
+   lut_i.init(K, Mp);
+   array1i_t count(Mp);
+   count = 0;
+   for (int mdash = 0; mdash < M; mdash++)
+      for (int i = 0; i < K; i++)
+         {
+         array1i_t mdash_v = encoder.convert_state(mdash);
+         encoder.reset(mdash_v);
+         array1i_t input = encoder.convert_input(i);
+         const int X = encoder.convert_output(encoder.step(input));
+         assert(X >= 0 && X < N);
+         const int m = encoder.convert_state(encoder.state());
+         assert(m >= 0 && m < M);
+         lut_X(i, mdash) = X;
+         lut_m(i, mdash) = m;
+         assertalways(count(m) < K);
+         lut_prev(count(m), m) = mdash;
+         lut_i(count(m), m) = i;
+         count(m)++;
+         }
+   // padding states loop onto themselves
+   for (int m = M; m < Mp; m++)
+      for (int i = 0; i < K; i++)
+         {
+         lut_X(i, m) = 0;
+         lut_m(i, m) = m;
+         lut_prev(i, m) = m;
+         lut_i(i, m) = i;
+         }
+
+   // set flag as necessary
+   initialised = false;
+   }
+
+// Get start- and end-state probabilities
+
+template <class dbl>
+typename logmap_bcjr<dbl>::array1d_t logmap_bcjr<dbl>::getstart() const
+   {
+   assert(initialised);
+   if (metric == metric_int16)
+      return getmetric(ws_int16.beta, 0);
+   return getmetric(ws_float.beta, 0);
+   }
+
+template <class dbl>
+typename logmap_bcjr<dbl>::array1d_t logmap_bcjr<dbl>::getend() const
+   {
+   assert(initialised);
+   if (metric == metric_int16)
+      return getmetric(ws_int16.alpha, tau);
+   return getmetric(ws_float.alpha, tau);
+   }
+
+// Set start- and end-state probabilities - equiprobable
+
+template <class dbl>
+void logmap_bcjr<dbl>::setstart()
+   {
+   if (!initialised)
+      allocate();
+   lstart = 0;
+   }
+
+template <class dbl>
+void logmap_bcjr<dbl>::setend()
+   {
+   if (!initialised)
+      allocate();
+   lend = 0;
+   }
+
+// Set start- and end-state probabilities - known state
+
+template <class dbl>
+void logmap_bcjr<dbl>::setstart(int state)
+   {
+   assert(state >= 0 && state < M);
+   if (!initialised)
+      allocate();
+   lstart = logmap_ops<float>::logzero();
+   lstart(state) = 0;
+   }
+
+template <class dbl>
+void logmap_bcjr<dbl>::setend(int state)
+   {
+   assert(state >= 0 && state < M);
+   if (!initialised)
+      allocate();
+   lend = logmap_ops<float>::logzero();
+   lend(state) = 0;
+   }
+
+// Set start- and end-state probabilities - direct
+
+template <class dbl>
+void logmap_bcjr<dbl>::setstart(const array1d_t& p)
+   {
+   assert(p.size() == M);
+   if (!initialised)
+      allocate();
+   for (int m = 0; m < M; m++)
+      lstart(m) = logmap_ops<float>::quantize(log(double(p(m))));
+   }
+
+template <class dbl>
+void logmap_bcjr<dbl>::setend(const array1d_t& p)
+   {
+   assert(p.size() == M);
+   if (!initialised)
+      allocate();
+   for (int m = 0; m < M; m++)
+      lend(m) = logmap_ops<float>::quantize(log(double(p(m))));
+   }
+
+/*!
+ * \brief   Converts receiver statistics to log-domain.
+ * \param   R     R(t-1, X) is the probability of receiving "whatever we
+ * received" at time t, having transmitted X
+ * \param   lR    Corresponding log-domain statistics, in nats (result)
+ */
+template <class dbl>
+void logmap_bcjr<dbl>::convert(const array2d_t& R, array2f_t& lR)
+   {
+   lR.init(R.size());
+   for (int t = 0; t < R.size().rows(); t++)
+      for (int x = 0; x < R.size().cols(); x++)
+         lR(t, x) = logmap_log(double(R(t, x)));
+   }
+
+// Internal methods
+
+/*! \brief Memory allocator for working matrices
+ */
+template <class dbl>
+void logmap_bcjr<dbl>::allocate()
+   {
+   lstart.init(M);
+   lend.init(M);
+   if (metric == metric_int16)
+      allocate(ws_int16);
+   else
+      allocate(ws_float);
+   // flag the state of the arrays
+   initialised = true;
+   }
+
+template <class dbl>
+template <class T>
+void logmap_bcjr<dbl>::allocate(workspace<T>& w)
+   {
+   w.alpha.init(tau + 1, Mp);
+   w.beta.init(tau + 1, Mp);
+   w.gs.init(tau, K * Mp);
+   w.gd.init(tau, K * Mp);
+   w.tmp.init(std::max(Mp, K * N));
+
+   // set required format, storing previous settings
+   const std::ios::fmtflags flags = std::cerr.flags();
+   std::cerr.setf(std::ios::fixed, std::ios::floatfield);
+   const int prec = std::cerr.precision(1);
+   // determine memory occupied and tell user
+   const size_t bytes_used = sizeof(T) * (w.alpha.size() + w.beta.size()
+         + w.gs.size() + w.gd.size());
+   std::cerr << "BCJR Memory Usage: " << bytes_used / double(1 << 20)
+         << "MiB" << std::endl;
+   // revert cerr to original format
+   std::cerr.precision(prec);
+   std::cerr.setf(flags);
+   }
+
+/*!
+ * \brief   Computes the branch metrics.
+ * \param   lR    lR(t-1, X) is the log-probability of receiving "whatever we
+ * received" at time t, having transmitted X
+ * \param   app   app(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t
+ *
+ * Branch metrics are stored twice: ordered by source state (for the backward
+ * and output recursions) and by destination state (for the forward
+ * recursion), so that all recursions read them as contiguous vectors.
+ */
+template <class dbl>
+template <class T>
+void logmap_bcjr<dbl>::work_gamma(workspace<T>& w, const array2f_t& lR,
+      const array2d_t& app)
+   {
+   typedef logmap_ops<T> ops;
+   // metric for each input/output combination at current time-step
+   T *q = &w.tmp(0);
+   for (int t = 0; t < tau; t++)
+      {
+      const float *r = lR.row(t);
+      for (int i = 0; i < K; i++)
+         {
+         const float la = logmap_log(double(app(t, i)));
+         for (int X = 0; X < N; X++)
+            q[i * N + X] = ops::quantize(r[X] + la);
+         }
+      T *gs = w.gs.row(t);
+      T *gd = w.gd.row(t);
+      for (int i = 0; i < K; i++)
+         {
+         const int *X = lut_X.row(i);
+         for (int m = 0; m < M; m++)
+            gs[i * Mp + m] = q[i * N + X[m]];
+         for (int m = M; m < Mp; m++)
+            gs[i * Mp + m] = ops::logzero();
+         }
+      for (int b = 0; b < K; b++)
+         {
+         const int *prev = lut_prev.row(b);
+         const int *in = lut_i.row(b);
+         for (int m = 0; m < Mp; m++)
+            gd[b * Mp + m] = gs[in[m] * Mp + prev[m]];
+         }
+      }
+   }
+
+/*!
+ * \brief   Normalizes a vector of state metrics.
+ *
+ * The largest metric is subtracted from all states; metrics are then
+ * clipped at log-zero, which stops unreachable states from drifting.
+ */
+template <class T, int Mc>
+inline void logmap_normalize(T *x, const int Mp)
+   {
+   typedef logmap_ops<T> ops;
+   typedef typename ops::vec vec;
+   const int n = Mc ? Mc : Mp;
+   vec vmx = ops::load(x);
+   for (int m = ops::width; m < n; m += ops::width)
+      vmx = ops::max(vmx, ops::load(x + m));
+   vmx = ops::hmax(vmx);
+   const vec vzero = ops::set1(ops::logzero());
+   for (int m = 0; m < n; m += ops::width)
+      ops::store(x + m, ops::max(ops::sub(ops::load(x + m), vmx), vzero));
+   }
+
+/*!
+ * \brief   Computes the alpha matrix.
+ *
+ * For each destination state, the metrics along the K incoming branches are
+ * combined with the max* operator; the gather of predecessor state metrics
+ * is done in scalar code, while the branch metric addition and max* are
+ * vectorized over states.
+ */
+template <class dbl>
+template <class T, bool correct, int Mc>
+void logmap_bcjr<dbl>::work_alpha(workspace<T>& w)
+   {
+   typedef logmap_ops<T> ops;
+   typedef typename ops::vec vec;
+   const logmap_maxstar<T, correct> maxstar;
+   const int n = Mc ? Mc : Mp;
+   // initial conditions
+   for (int m = 0; m < M; m++)
+      w.alpha(0, m) = ops::quantize(lstart(m));
+   for (int m = M; m < Mp; m++)
+      w.alpha(0, m) = ops::logzero();
+   logmap_normalize<T, Mc> (w.alpha.row(0), Mp);
+   // forward recursion
+   for (int t = 1; t <= tau; t++)
+      {
+      const T *ap = w.alpha.row(t - 1);
+      const T *g = w.gd.row(t - 1);
+      T *a = w.alpha.row(t);
+      for (int b = 0; b < K; b++)
+         {
+         const int *prev = lut_prev.row(b);
+         for (int m = 0; m < n; m += ops::width)
+            {
+            const vec v = ops::add(ops::gather(ap, prev + m), ops::load(g + b
+                  * n + m));
+            ops::store(a + m, b == 0 ? v : maxstar(ops::load(a + m), v));
+            }
+         }
+      logmap_normalize<T, Mc> (a, Mp);
+      }
+   }
+
+/*!
+ * \brief   Computes the beta matrix and the final results (input only).
+ * \param   ri    ri(t-1, i) is the probability that we transmitted
+ * (input value) i at time t
+ *
+ * The terms beta(t+1, m(m',i)) + gamma(t, m', i) needed for beta(t, m') are
+ * also those needed for the a-posteriori metric of input i at time t, so
+ * both are worked out in the same pass; the a-posteriori metric is obtained
+ * by adding alpha(t, m') and combining over all source states.
+ * Results are converted back to probabilities, scaled so that the most
+ * likely input has probability metric one.
+ *
+ * \sa See notes for work_alpha()
+ */
+template <class dbl>
+template <class T, bool correct, int Mc>
+void logmap_bcjr<dbl>::work_beta(workspace<T>& w, array2d_t& ri)
+   {
+   typedef logmap_ops<T> ops;
+   typedef typename ops::vec vec;
+   const logmap_maxstar<T, correct> maxstar;
+   const int n = Mc ? Mc : Mp;
+   T *tmp = &w.tmp(0);
+   const double scale = 1.0 / ops::scale();
+   // Initialize results vector
+   ri.init(tau, K);
+   array1f_t L(K);
+   // final conditions
+   for (int m = 0; m < M; m++)
+      w.beta(tau, m) = ops::quantize(lend(m));
+   for (int m = M; m < Mp; m++)
+      w.beta(tau, m) = ops::logzero();
+   logmap_normalize<T, Mc> (w.beta.row(tau), Mp);
+   // backward recursion
+   for (int t = tau - 1; t >= 0; t--)
+      {
+      const T *a = w.alpha.row(t);
+      const T *bn = w.beta.row(t + 1);
+      const T *g = w.gs.row(t);
+      T *beta = w.beta.row(t);
+      for (int i = 0; i < K; i++)
+         {
+         const int *next = lut_m.row(i);
+         vec r = ops::set1(0);
+         for (int m = 0; m < n; m += ops::width)
+            {
+            const vec v = ops::add(ops::gather(bn, next + m), ops::load(g + i
+                  * n + m));
+            ops::store(beta + m, i == 0 ? v : maxstar(ops::load(beta + m), v));
+            // combine over states, first across registers then within
+            const vec u = ops::add(v, ops::load(a + m));
+            r = (m == 0) ? u : maxstar(r, u);
+            }
+         ops::store(tmp, correct ? r : ops::hmax(r));
+         L(i) = float(correct ? maxstar(tmp, ops::width) : tmp[0]);
+         }
+      logmap_normalize<T, Mc> (beta, Mp);
+      // convert results
+      const float mx = L.max();
+      for (int i = 0; i < K; i++)
+         ri(t, i) = dbl(logmap_exp(float((L(i) - mx) * scale)));
+      }
+   }
+
+template <class dbl>
+template <class T, bool correct, int Mc>
+void logmap_bcjr<dbl>::work(workspace<T>& w, array2d_t& ri)
+   {
+   work_alpha<T, correct, Mc> (w);
+   work_beta<T, correct, Mc> (w, ri);
+   }
+
+/*!
+ * \brief   Selects the recursion specialized for the padded state count.
+ *
+ * Specializations are only used where the state count is a whole number of
+ * registers.
+ */
+template <class dbl>
+template <class T, bool correct>
+void logmap_bcjr<dbl>::work(workspace<T>& w, array2d_t& ri)
+   {
+   const int W = logmap_ops<T>::width;
+   if (Mp == 4 && W <= 4)
+      work<T, correct, 4> (w, ri);
+   else if (Mp == 8 && W <= 8)
+      work<T, correct, 8> (w, ri);
+   else if (Mp == 16)
+      work<T, correct, 16> (w, ri);
+   else if (Mp == 32)
+      work<T, correct, 32> (w, ri);
+   else
+      work<T, correct, 0> (w, ri);
+   }
+
+template <class dbl>
+template <class T>
+void logmap_bcjr<dbl>::fdecode(workspace<T>& w, const array2f_t& lR,
+      const array2d_t& app, array2d_t& ri)
+   {
+   work_gamma(w, lR, app);
+   if (algorithm == algorithm_logmap)
+      work<T, true> (w, ri);
+   else
+      work<T, false> (w, ri);
+   }
+
+/*!
+ * \brief   Converts a vector of state metrics to normalized probabilities.
+ */
+template <class dbl>
+template <class T>
+typename logmap_bcjr<dbl>::array1d_t logmap_bcjr<dbl>::getmetric(
+      const libbase::matrix<T>& x, const int t) const
+   {
+   const double scale = 1.0 / logmap_ops<T>::scale();
+   array1d_t r(M);
+   double sum = 0;
+   for (int m = 0; m < M; m++)
+      sum += exp(x(t, m) * scale);
+   for (int m = 0; m < M; m++)
+      r(m) = dbl(exp(x(t, m) * scale) / sum);
+   return r;
+   }
+
+// User procedures
+
+/*!
+ * \brief   Wrapping function for decoding a block.
+ * \param   lR    lR(t-1, X) is the log-probability of receiving "whatever we
+ * received" at time t, having transmitted X (as obtained from convert())
+ * \param   app   app(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t
+ * \param   ri    ri(t-1, i) is the a posteriori probability of having
+ * transmitted (input value) i at time t (result, not normalized)
+ */
+template <class dbl>
+void logmap_bcjr<dbl>::fdecode(const array2f_t& lR, const array2d_t& app,
+      array2d_t& ri)
+   {
+   assert(lR.size().rows() == tau && lR.size().cols() == N);
+   assert(app.size().rows() == tau && app.size().cols() == K);
+   if (!initialised)
+      allocate();
+   if (metric == metric_int16)
+      fdecode(ws_int16, lR, app, ri);
+   else
+      fdecode(ws_float, lR, app, ri);
+   }
+
+// Description
+
+template <class dbl>
+std::string logmap_bcjr<dbl>::description() const
+   {
+   std::ostringstream sout;
+   switch (algorithm)
+      {
+      case algorithm_maxlog:
+         sout << "max-log-MAP";
+         break;
+      case algorithm_logmap:
+         sout << "log-MAP";
+         break;
+      default:
+         failwith("Unknown algorithm");
+         break;
+      }
+   switch (metric)
+      {
+      case metric_float:
+         sout << " (float)";
+         break;
+      case metric_int16:
+         sout << " (int16)";
+         break;
+      default:
+         failwith("Unknown metric representation");
+         break;
+      }
+   return sout.str();
+   }
+
+} // end namespace
+
+// Explicit Realizations
+
+#include "logrealfast.h"
+
+namespace libcomm {
+
+using libbase::logrealfast;
+
+template class logmap_bcjr<float> ;
+template class logmap_bcjr<double> ;
+template class logmap_bcjr<logrealfast> ;
+
+} // end namespace
@@ -0,0 +1,237 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __logmap_bcjr_h
+#define __logmap_bcjr_h
+
+#include "config.h"
+#include "vector.h"
+#include "matrix.h"
+#include "fsm.h"
+
+#include <string>
+
+namespace libcomm {
+
+/*!
+ * \brief   Log-domain BCJR decoder (max-log-MAP / log-MAP).
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * This is an alternative realization of the BCJR algorithm, intended for
+ * speed rather than accuracy. All internal metrics are held in the log
+ * domain, in units of nats; the max* operator is either approximated by the
+ * maximum (max-log-MAP) or computed exactly up to the resolution of a small
+ * correction table (log-MAP). Metrics can be held either as 'float' or as
+ * 16-bit fixed-point values (with 1/16 nat resolution, and saturating
+ * arithmetic).
+ *
+ * The forward and backward recursions (the latter also computing the
+ * results) are vectorized over the encoder states using SSE2, with a scalar
+ * fallback where this is not available; the state space is padded to a
+ * whole number of vector registers, with the padding states held at
+ * log-zero. The recursions are specialized at compile-time for the common
+ * state-space sizes (4, 8, 16 and 32 padded states), falling back to a
+ * run-time loop bound otherwise.
+ *
+ * The external interface follows that of bcjr::fdecode(), with statistics
+ * passed as probabilities of type 'dbl'; the only exception is that the
+ * receiver statistics are passed in log-domain form, as these are usually
+ * reused across several decoding iterations and need only be converted once
+ * (see convert()).
+ *
+ * \warning
+ * - Static memory requirements:
+ * sizeof(metric)*(2*(tau+1)*M' + 2*tau*M'*K) + sizeof(int)*4*K*M'
+ * where M' is the padded number of states
+ * - Dynamic memory requirements:
+ * none
+ *
+ * \note Memory is only allocated in the first call to "fdecode" or to one of
+ * the functions setting start/end state probabilities.
+ */
+
+template <class dbl>
+class logmap_bcjr {
+public:
+   /*! \name Type definitions */
+   typedef libbase::vector<int> array1i_t;
+   typedef libbase::matrix<int> array2i_t;
+   typedef libbase::vector<float> array1f_t;
+   typedef libbase::matrix<float> array2f_t;
+   typedef libbase::vector<dbl> array1d_t;
+   typedef libbase::matrix<dbl> array2d_t;
+   //! Approximation used for the max* operator
+   enum algorithm_t {
+      algorithm_maxlog = 0, //!< max-log-MAP: max* = max
+      algorithm_logmap, //!< log-MAP: max* = max + correction (from table)
+      algorithm_undefined
+   };
+   //! Numerical representation of internal metrics
+   enum metric_t {
+      metric_float = 0, //!< single-precision floating-point
+      metric_int16, //!< 16-bit fixed-point, with saturation
+      metric_undefined
+   };
+   // @}
+private:
+   /*! \name Internal types */
+   //! Working matrices, for a given metric representation
+   template <class T>
+   struct workspace {
+      //! Forward recursion metric: alpha(t,m) = ln Pr{S(t)=m, Y(1..t)}
+      libbase::matrix<T> alpha;
+      //! Backward recursion metric: beta(t,m) = ln Pr{Y(t+1..tau) | S(t)=m}
+      libbase::matrix<T> beta;
+      //! Branch metric, by source state: gs(t, i*M'+m') for input i
+      libbase::matrix<T> gs;
+      //! Branch metric, by destination state: gd(t, b*M'+m) for branch b
+      libbase::matrix<T> gd;
+      //! Temporary space (branch metric table, output metric reduction)
+      libbase::vector<T> tmp;
+   };
+   // @}
+private:
+   /*! \name User-defined parameters */
+   algorithm_t algorithm; //!< Approximation used for the max* operator
+   metric_t metric; //!< Numerical representation of internal metrics
+   // @}
+   /*! \name Internal variables */
+   int tau; //!< Input block size in symbols (including tail)
+   int K; //!< Input alphabet size
+   int N; //!< Output alphabet size
+   int M; //!< Number of encoder states
+   int Mp; //!< Number of states, padded to a whole number of registers
+   bool initialised; //!< Flag to indicate when memory is allocated
+   // @}
+   /*! \name Trellis tables (padding states map onto themselves) */
+   //! lut_X(i,m) = encoder output, given state 'm' and input 'i'
+   array2i_t lut_X;
+   //! lut_m(i,m) = next state, given state 'm' and input 'i'
+   array2i_t lut_m;
+   //! lut_prev(b,m) = previous state, for the b'th branch into state 'm'
+   array2i_t lut_prev;
+   //! lut_i(b,m) = input value, for the b'th branch into state 'm'
+   array2i_t lut_i;
+   // @}
+   /*! \name Start- and end-state metrics (in nats) */
+   array1f_t lstart;
+   array1f_t lend;
+   // @}
+   /*! \name Working matrices */
+   workspace<float> ws_float;
+   workspace<libbase::int16s> ws_int16;
+   // @}
+private:
+   /*! \name Internal methods */
+   void allocate();
+   template <class T>
+   void allocate(workspace<T>& w);
+   template <class T>
+   void work_gamma(workspace<T>& w, const array2f_t& lR, const array2d_t& app);
+   template <class T, bool correct, int Mc>
+   void work_alpha(workspace<T>& w);
+   template <class T, bool correct, int Mc>
+   void work_beta(workspace<T>& w, array2d_t& ri);
+   template <class T, bool correct, int Mc>
+   void work(workspace<T>& w, array2d_t& ri);
+   template <class T, bool correct>
+   void work(workspace<T>& w, array2d_t& ri);
+   template <class T>
+   void fdecode(workspace<T>& w, const array2f_t& lR, const array2d_t& app,
+         array2d_t& ri);
+   template <class T>
+   array1d_t getmetric(const libbase::matrix<T>& x, const int t) const;
+   // @}
+public:
+   /*! \name Constructors / Destructors */
+   //! Default constructor
+   logmap_bcjr() :
+      algorithm(algorithm_maxlog), metric(metric_float), initialised(false)
+      {
+      }
+   // @}
+
+   // main initialization routine
+   void init(fsm& encoder, const int tau, const algorithm_t algorithm,
+         const metric_t metric);
+   // get start- and end-state probabilities
+   array1d_t getstart() const;
+   array1d_t getend() const;
+   // set start- and end-state probabilities - equiprobable
+   void setstart();
+   void setend();
+   // set start- and end-state probabilities - known state
+   void setstart(int state);
+   void setend(int state);
+   // set start- and end-state probabilities - direct
+   void setstart(const array1d_t& p);
+   void setend(const array1d_t& p);
+
+   // conversion of receiver statistics to log-domain
+   static void convert(const array2d_t& R, array2f_t& lR);
+
+   /*! \name Decode functions */
+   void fdecode(const array2f_t& lR, const array2d_t& app, array2d_t& ri);
+   // @}
+
+   /*! \name Information functions */
+   //! Number of defined states
+   int num_states() const
+      {
+      return M;
+      }
+   //! Input alphabet size
+   int num_input_symbols() const
+      {
+      return K;
+      }
+   //! Output alphabet size
+   int num_output_symbols() const
+      {
+      return N;
+      }
+   //! Approximation used for the max* operator
+   algorithm_t get_algorithm() const
+      {
+      return algorithm;
+      }
+   //! Numerical representation of internal metrics
+   metric_t get_metric() const
+      {
+      return metric;
+      }
+   // @}
+
+   // Description
+   std::string description() const;
+};
+
+} // end namespace
+
+#endif
@@ -84,7 +84,7 @@ public:
    void set_temperature(const double Tstart, const double Tstop);
    void set_schedule(const double rate);
    void set_iterations(const int min_iter, const int min_changes);
-   void improve();
+   virtual void improve();
 };
 
 } // end namespace
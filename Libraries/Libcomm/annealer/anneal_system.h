@@ -73,6 +73,10 @@ public:
    virtual ~anneal_system()
       {
       }
+   //! Returns a copy of the system, in its current state
+   virtual anneal_system *clone() const = 0;
+   //! Sets the state to that of another system of the same type
+   virtual void copyfrom(const anneal_system& x) = 0;
    //! Seeds any random generators from a pseudo-random sequence
    virtual void seedfrom(libbase::random& r) = 0;
    //! Perturbs the state and returns the difference in energy due to perturbation
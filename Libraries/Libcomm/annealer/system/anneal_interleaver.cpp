@@ -39,6 +39,8 @@ anneal_interleaver::anneal_interleaver(const int sets, const int tau,
    anneal_interleaver::m = m;
    anneal_interleaver::type = type;
    anneal_interleaver::term = term || (type <= 7);
+   // interacting range, for energy functions that are zero beyond 5*m
+   cutoff = (sets < 2 && type >= 2 && type <= 6) ? 5 * m : tau;
    // compute useful functions
    f0 = tau * sqrt(double(2));
    f1 = tau * sqrt(double(2)) / 2;
@@ -75,20 +77,21 @@ void anneal_interleaver::initialise()
       }
    }
 
+//! Correction metric for annulus area within the valid range, at radius r
+inline double correction_annulus(const double r, const int tau)
+   {
+   using libbase::PI;
+   return (r <= tau) ? (r * PI / 2) : (r * (PI / 2 - 2 * acos(tau / r)));
+   }
+
 inline double anneal_interleaver::energy_function(const int i, const int j)
    {
    if (sets < 2 && type < 15)
       {
-      using libbase::PI;
-
       // compute standard metrics
       const int d_in = abs(j - i);
       const int d_out = abs(lut(0, j) - lut(0, i));
       const double r = sqrt(double(d_in * d_in + d_out * d_out));
-      // compute correction metrics
-      const double c1 = (r <= tau) ? (r * PI / 2) : (r * (PI / 2 - 2 * acos(tau
-            / r)));
-      const double c2 = (tau - d_in) * (tau - d_out) / f2;
 
       // compute change in energy depending on function type
       switch (type)
@@ -113,11 +116,11 @@ inline double anneal_interleaver::energy_function(const int i, const int j)
          case 10:
             return pow((f0 - r) / f0, 4);
          case 11:
-            return (5 * m / r) / c1;
+            return (5 * m / r) / correction_annulus(r, tau);
          case 12:
-            return pow((r - f1) / f1, 4) / c1;
+            return pow((r - f1) / f1, 4) / correction_annulus(r, tau);
          case 13:
-            return (5 * m / r) / c2;
+            return (5 * m / r) / ((tau - d_in) * (tau - d_out) / f2);
          case 14:
             {
             using std::min;
@@ -182,17 +185,33 @@ double anneal_interleaver::work_energy()
    {
    double energy = 0;
    for (int i = 0; i < tau; i++)
-      for (int j = i + 1; j < tau; j++)
+      for (int j = i + 1; j < tau && j <= i + cutoff; j++)
          energy += energy_function(i, j);
    return energy;
    }
 
-double anneal_interleaver::work_delta()
+/*!
+ * \brief Adds the energy terms for positions [lo,hi] to 'delta'
+ */
+void anneal_interleaver::work_delta(double& delta, const int lo, const int hi)
    {
-   double delta = 0;
-   for (int i = 0; i < tau; i++)
+   for (int i = lo; i <= hi; i++)
       if (i != pos1 && i != pos2)
          delta += energy_function(pos1, i) + energy_function(pos2, i);
+   }
+
+/*!
+ * \brief Energy terms involving the positions to be swapped
+ * Only positions within the cutoff distance of either are visited, in
+ * increasing order; all other terms are zero.
+ */
+double anneal_interleaver::work_delta()
+   {
+   double delta = 0;
+   const int hi1 = std::min(tau - 1, pos1 + cutoff);
+   work_delta(delta, std::max(0, pos1 - cutoff), hi1);
+   work_delta(delta, std::max(hi1 + 1, pos2 - cutoff), std::min(tau - 1,
+         pos2 + cutoff));
    return delta;
    }
 
@@ -129,6 +129,11 @@ namespace libcomm {
  *
  * \version 3.31 (2 Jan 2008)
  * - modified stream output to include only LUT contents, not index
+ *
+ * \note For energy types 2-6 (single set), the contribution of a pair of
+ * positions is zero beyond a distance of 5*m; the energy and its change on a
+ * swap are then worked over neighbouring positions only. Terms are summed
+ * in the same order as before, so the results are unchanged.
  */
 
 class anneal_interleaver : public virtual anneal_system {
@@ -136,6 +141,7 @@ class anneal_interleaver : public virtual anneal_system {
    libbase::randgen r;
    bool term;
    int sets, tau, m, type;
+   int cutoff; //!< Distance beyond which energy contributions are zero
    double f0, f1, f2;
    double E, Eold;
    int set, pos1, pos2;
@@ -143,6 +149,7 @@ protected:
    void initialise();
    double energy_function(const int i, const int j);
    double work_energy();
+   void work_delta(double& delta, const int lo, const int hi);
    double work_delta();
 public:
    anneal_interleaver(const int sets, const int tau, const int m,
@@ -150,6 +157,15 @@ public:
    ~anneal_interleaver()
       {
       }
+   // copying
+   anneal_system *clone() const
+      {
+      return new anneal_interleaver(*this);
+      }
+   void copyfrom(const anneal_system& x)
+      {
+      *this = dynamic_cast<const anneal_interleaver&> (x);
+      }
    // seeding for random generator
    void seedfrom(libbase::random& r)
       {
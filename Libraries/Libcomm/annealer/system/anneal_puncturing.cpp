@@ -34,6 +34,7 @@ anneal_puncturing::anneal_puncturing(const char *fname, const int tau,
    // store user parameters
    anneal_puncturing::tau = tau;
    anneal_puncturing::s = s;
+   replica = false;
    // initialise contribution matrix and load contribution matrix from file
    contrib.init(s, tau, tau);
    FILE *file = fopen(fname, "rb");
@@ -77,7 +78,8 @@ anneal_puncturing::anneal_puncturing(const char *fname, const int tau,
 
 anneal_puncturing::~anneal_puncturing()
    {
-   output(std::cout);
+   if (!replica)
+      output(std::cout);
    }
 
 inline void anneal_puncturing::energy_function(const double factor,
@@ -70,6 +70,9 @@ namespace libcomm {
  * \version 1.20 (27 Oct 2006)
  * - defined class and associated data within "libcomm" namespace.
  * - removed use of "using namespace std", replacing by tighter "using" statements as needed.
+ *
+ * Copies made with clone() (as replicas for multi-replica annealing) do not
+ * print themselves at destruction.
  */
 
 class anneal_puncturing : public virtual anneal_system {
@@ -80,12 +83,26 @@ class anneal_puncturing : public virtual anneal_system {
    int tau, s;
    double E, Eold;
    int set, pos1, pos2;
+   bool replica; //!< flag to suppress printing at destruction
 protected:
    void energy_function(const double factor, const int set, const int pos);
    double work_energy();
 public:
    anneal_puncturing(const char *fname, const int tau, const int s);
    ~anneal_puncturing();
+   // copying
+   anneal_system *clone() const
+      {
+      anneal_puncturing *copy = new anneal_puncturing(*this);
+      copy->replica = true;
+      return copy;
+      }
+   void copyfrom(const anneal_system& x)
+      {
+      const bool replica = this->replica;
+      *this = dynamic_cast<const anneal_puncturing&> (x);
+      this->replica = replica;
+      }
    // seeding for random generator
    void seedfrom(libbase::random& r)
       {
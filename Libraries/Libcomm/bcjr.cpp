@@ -23,16 +23,344 @@
  */
 
 #include "bcjr.h"
+#include "logrealfast_v.h"
 #include <iomanip>
+#include <algorithm>
 
 namespace libcomm {
 
+// Internal recursion steps
+
+namespace {
+
+/*!
+ * \brief   Computes alpha values for all states at one time-step.
+ * \param   a     Alpha values for the next time-step (output)
+ * \param   ap    Alpha values for the current time-step
+ * \param   gamma Gamma matrix
+ * \param   row   Row of the gamma matrix for the current time-step
+ * \param   lut_m Next-state table
+ * \param   lut_prev Previous-transition table (unused here)
+ *
+ * Contributions are accumulated in order of originating state and input.
+ */
+template <class real>
+inline void bcjr_alpha_step(real *a, const real *ap,
+      const libbase::matrix3<real>& gamma, const int row,
+      const libbase::matrix<int>& lut_m, const libbase::matrix<int>& lut_prev)
+   {
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   for (int m = 0; m < M; m++)
+      a[m] = 0;
+   for (int mdash = 0; mdash < M; mdash++)
+      for (int i = 0; i < K; i++)
+         {
+         int m = lut_m(mdash, i);
+         a[m] += ap[mdash] * gamma(row, mdash, i);
+         }
+   }
+
+/*!
+ * \brief   Computes beta values for all states at one time-step.
+ * \param   b     Beta values for the previous time-step (output)
+ * \param   bn    Beta values for the current time-step
+ * \param   gamma Gamma matrix
+ * \param   row   Row of the gamma matrix for the previous time-step
+ * \param   lut_m Next-state table
+ */
+template <class real>
+inline void bcjr_beta_step(real *b, const real *bn,
+      const libbase::matrix3<real>& gamma, const int row,
+      const libbase::matrix<int>& lut_m)
+   {
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   for (int m = 0; m < M; m++)
+      {
+      b[m] = 0;
+      for (int i = 0; i < K; i++)
+         {
+         int mdash = lut_m(m, i);
+         b[m] += bn[mdash] * gamma(row, m, i);
+         }
+      }
+   }
+
+/*!
+ * \brief   Computes alpha values for a block of W states from 'm'.
+ *
+ * Uses the previous-transition table to gather contributions, in the same
+ * order as the scatter in the generic version.
+ */
+template <int W>
+inline void bcjr_alpha_block(libbase::logrealfast *a,
+      const libbase::logrealfast *ap,
+      const libbase::matrix3<libbase::logrealfast>& gamma, const int row,
+      const libbase::matrix<int>& lut_prev, const int K, const int m)
+   {
+   libbase::logrealfast_v<W> acc, x, g;
+   acc.zero();
+   for (int j = 0; j < lut_prev.size().cols(); j++)
+      {
+      for (int k = 0; k < W; k++)
+         {
+         const int mdash = lut_prev(m + k, j) / K;
+         const int i = lut_prev(m + k, j) % K;
+         x.set(k, ap[mdash]);
+         g.set(k, gamma(row, mdash, i));
+         }
+      x *= g;
+      acc += x;
+      }
+   acc.store(a + m);
+   }
+
+/*!
+ * \brief   Computes beta values for a block of W states from 'm'.
+ */
+template <int W>
+inline void bcjr_beta_block(libbase::logrealfast *b,
+      const libbase::logrealfast *bn,
+      const libbase::matrix3<libbase::logrealfast>& gamma, const int row,
+      const libbase::matrix<int>& lut_m, const int m)
+   {
+   libbase::logrealfast_v<W> acc, x, g;
+   acc.zero();
+   for (int i = 0; i < lut_m.size().cols(); i++)
+      {
+      for (int k = 0; k < W; k++)
+         {
+         x.set(k, bn[lut_m(m + k, i)]);
+         g.set(k, gamma(row, m + k, i));
+         }
+      x *= g;
+      acc += x;
+      }
+   acc.store(b + m);
+   }
+
+/*!
+ * \brief   Computes alpha values for all states at one time-step.
+ *
+ * Specialization for logrealfast, working on blocks of states with the
+ * vector type; falls back to the generic version if the trellis does not
+ * have a previous-transition table.
+ */
+inline void bcjr_alpha_step(libbase::logrealfast *a,
+      const libbase::logrealfast *ap,
+      const libbase::matrix3<libbase::logrealfast>& gamma, const int row,
+      const libbase::matrix<int>& lut_m, const libbase::matrix<int>& lut_prev)
+   {
+   if (lut_prev.size() == 0)
+      {
+      bcjr_alpha_step<libbase::logrealfast> (a, ap, gamma, row, lut_m,
+            lut_prev);
+      return;
+      }
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   int m = 0;
+   for (; m + 4 <= M; m += 4)
+      bcjr_alpha_block<4> (a, ap, gamma, row, lut_prev, K, m);
+   for (; m < M; m++)
+      bcjr_alpha_block<1> (a, ap, gamma, row, lut_prev, K, m);
+   }
+
+/*!
+ * \brief   Computes beta values for all states at one time-step.
+ *
+ * Specialization for logrealfast, working on blocks of states with the
+ * vector type.
+ */
+inline void bcjr_beta_step(libbase::logrealfast *b,
+      const libbase::logrealfast *bn,
+      const libbase::matrix3<libbase::logrealfast>& gamma, const int row,
+      const libbase::matrix<int>& lut_m)
+   {
+   const int M = lut_m.size().rows();
+   int m = 0;
+   for (; m + 4 <= M; m += 4)
+      bcjr_beta_block<4> (b, bn, gamma, row, lut_m, m);
+   for (; m < M; m++)
+      bcjr_beta_block<1> (b, bn, gamma, row, lut_m, m);
+   }
+
+/*!
+ * \brief   Computes alpha values for all states and frames at one time-step.
+ * \param   a     Alpha values for the next time-step (output)
+ * \param   ap    Alpha values for the current time-step
+ * \param   g     Gamma values for the current time-step
+ * \param   lut_X Encoder output table
+ * \param   lut_m Next-state table
+ * \param   lut_prev Previous-transition table
+ * \param   Fr    Number of frames (used if not fixed at compile-time)
+ *
+ * Metrics are frame-interleaved, with the frame index innermost; for each
+ * frame, contributions are accumulated in the same order as in the
+ * single-frame version. Gamma values are indexed by encoder output and
+ * input, as they do not otherwise depend on the originating state.
+ *
+ * When the number of frames is fixed at compile-time, and the trellis has a
+ * previous-transition table, contributions to each state are gathered in a
+ * local accumulator (in the same order as the scatter).
+ */
+template <class real, int Fc>
+inline void bcjr_alpha_batch_step(real *a, const real *ap, const real *g,
+      const libbase::matrix<int>& lut_X, const libbase::matrix<int>& lut_m,
+      const libbase::matrix<int>& lut_prev, const int Fr)
+   {
+   const int F = Fc ? Fc : Fr;
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   if (Fc && lut_prev.size() > 0)
+      {
+      for (int m = 0; m < M; m++)
+         {
+         real acc[Fc ? Fc : 1];
+         for (int f = 0; f < F; f++)
+            acc[f] = 0;
+         for (int j = 0; j < lut_prev.size().cols(); j++)
+            {
+            const int mdash = lut_prev(m, j) / K;
+            const int i = lut_prev(m, j) % K;
+            const real *apm = ap + mdash * F;
+            const real *gm = g + (lut_X(mdash, i) * K + i) * F;
+            for (int f = 0; f < F; f++)
+               acc[f] += apm[f] * gm[f];
+            }
+         for (int f = 0; f < F; f++)
+            a[m * F + f] = acc[f];
+         }
+      return;
+      }
+   for (int x = 0; x < M * F; x++)
+      a[x] = 0;
+   for (int mdash = 0; mdash < M; mdash++)
+      for (int i = 0; i < K; i++)
+         {
+         real *am = a + lut_m(mdash, i) * F;
+         const real *apm = ap + mdash * F;
+         const real *gm = g + (lut_X(mdash, i) * K + i) * F;
+         for (int f = 0; f < F; f++)
+            am[f] += apm[f] * gm[f];
+         }
+   }
+
+/*!
+ * \brief   Computes beta values for all states and frames at one time-step.
+ * \param   b     Beta values for the previous time-step (output)
+ * \param   bn    Beta values for the current time-step
+ * \param   g     Gamma values for the previous time-step
+ * \param   lut_X Encoder output table
+ * \param   lut_m Next-state table
+ * \param   Fr    Number of frames (used if not fixed at compile-time)
+ */
+template <class real, int Fc>
+inline void bcjr_beta_batch_step(real *b, const real *bn, const real *g,
+      const libbase::matrix<int>& lut_X, const libbase::matrix<int>& lut_m,
+      const int Fr)
+   {
+   const int F = Fc ? Fc : Fr;
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   for (int m = 0; m < M; m++)
+      {
+      real acc[Fc ? Fc : 1];
+      real *bm = Fc ? acc : b + m * F;
+      for (int f = 0; f < F; f++)
+         bm[f] = 0;
+      for (int i = 0; i < K; i++)
+         {
+         const real *bnm = bn + lut_m(m, i) * F;
+         const real *gm = g + (lut_X(m, i) * K + i) * F;
+         for (int f = 0; f < F; f++)
+            bm[f] += bnm[f] * gm[f];
+         }
+      if (Fc)
+         for (int f = 0; f < F; f++)
+            b[m * F + f] = acc[f];
+      }
+   }
+
+/*!
+ * \brief   Computes the unnormalized results for all frames at one time-step.
+ * \param   r     r[i*F+f] is the result for input i in frame f (output)
+ * \param   a     Alpha values for the previous time-step
+ * \param   g     Gamma values for the previous time-step
+ * \param   b     Beta values for the current time-step
+ * \param   lut_X Encoder output table
+ * \param   lut_m Next-state table
+ * \param   Fr    Number of frames (used if not fixed at compile-time)
+ */
+template <class real, int Fc>
+inline void bcjr_results_batch_step(real *r, const real *a, const real *g,
+      const real *b, const libbase::matrix<int>& lut_X,
+      const libbase::matrix<int>& lut_m, const int Fr)
+   {
+   const int F = Fc ? Fc : Fr;
+   const int M = lut_m.size().rows();
+   const int K = lut_m.size().cols();
+   for (int i = 0; i < K; i++)
+      {
+      real acc[Fc ? Fc : 1];
+      real *ri = Fc ? acc : r + i * F;
+      for (int f = 0; f < F; f++)
+         ri[f] = 0;
+      for (int mdash = 0; mdash < M; mdash++)
+         {
+         const real *am = a + mdash * F;
+         const real *gm = g + (lut_X(mdash, i) * K + i) * F;
+         const real *bm = b + lut_m(mdash, i) * F;
+         for (int f = 0; f < F; f++)
+            ri[f] += am[f] * gm[f] * bm[f];
+         }
+      if (Fc)
+         for (int f = 0; f < F; f++)
+            r[i * F + f] = acc[f];
+      }
+   }
+
+/*!
+ * \brief   Normalizes state metrics for all frames at one time-step.
+ * \param   x     Metrics to normalize, frame-interleaved
+ * \param   scale Temporary space for the normalization factors
+ * \param   M     Number of states
+ * \param   Fr    Number of frames (used if not fixed at compile-time)
+ *
+ * \sa See notes for bcjr::work_alpha()
+ */
+template <class real, int Fc>
+inline void bcjr_normalize_batch(real *x, real *scale, const int M,
+      const int Fr)
+   {
+   const int F = Fc ? Fc : Fr;
+   for (int f = 0; f < F; f++)
+      scale[f] = x[f];
+   for (int m = 1; m < M; m++)
+      for (int f = 0; f < F; f++)
+         scale[f] += x[m * F + f];
+   for (int f = 0; f < F; f++)
+      {
+      assertalways(scale[f] > real(0));
+      scale[f] = real(1) / scale[f];
+      }
+   for (int m = 0; m < M; m++)
+      for (int f = 0; f < F; f++)
+         x[m * F + f] *= scale[f];
+   }
+
+} // end anonymous namespace
+
 // Initialization
 
 /*!
  * \brief   Creator for class 'bcjr'.
  * \param   encoder     The finite state machine used to encode the source.
  * \param   tau         The block length of decoder (including tail bits).
+ * \param   window      The sliding window length (0 to decode whole blocks).
+ * \param   warmup      The backward recursion warm-up length (sliding-window
+ * mode only).
  * 
  * \note If the trellis is not defined as starting or ending at zero, then it
  * is assumed that all starting and ending states (respectively) are
@@ -40,12 +368,19 @@ namespace libcomm {
  *
  * \note Instead of keeping a copy of the encoder, we compute the state
  * transition and output tables and keep a copy of those.
+ *
+ * \note A window length that covers the whole block is equivalent to
+ * decoding the whole block at once, and is treated as such.
  */
 template <class real, class dbl, bool norm>
-void bcjr<real, dbl, norm>::init(fsm& encoder, const int tau)
+void bcjr<real, dbl, norm>::init(fsm& encoder, const int tau,
+      const int window, const int warmup)
    {
    assertalways(tau > 0);
+   assertalways(window >= 0 && warmup >= 0);
    bcjr::tau = tau;
+   bcjr::window = (window < tau) ? window : 0;
+   bcjr::warmup = warmup;
 
    // Initialise constants
    K = encoder.num_input_combinations();
@@ -66,9 +401,30 @@ void bcjr<real, dbl, norm>::init(fsm& encoder, const int tau)
          lut_m(mdash, i) = encoder.convert_state(encoder.state());
          assert(lut_m(mdash, i) >= 0 && lut_m(mdash, i) < M);
          }
+   // initialise LUT of transitions into each state, if all states have the
+   // same number of incoming transitions (otherwise leave empty)
+   array1i_t count(M);
+   count = 0;
+   for (int mdash = 0; mdash < M; mdash++)
+      for (int i = 0; i < K; i++)
+         count(lut_m(mdash, i))++;
+   if (count.min() == K && count.max() == K)
+      {
+      lut_prev.init(M, K);
+      count = 0;
+      for (int mdash = 0; mdash < M; mdash++)
+         for (int i = 0; i < K; i++)
+            {
+            const int m = lut_m(mdash, i);
+            lut_prev(m, count(m)++) = mdash * K + i;
+            }
+      }
+   else
+      lut_prev.init(0, 0);
 
    // set flag as necessary
    initialised = false;
+   frames = 0;
    }
 
 // Get start- and end-state probabilities
@@ -78,7 +434,7 @@ typename bcjr<real, dbl, norm>::array1d_t bcjr<real, dbl, norm>::getstart() cons
    {
    array1d_t r(M);
    for (int m = 0; m < M; m++)
-      r(m) = beta(0, m);
+      r(m) = window ? beta0(m) : beta(0, m);
    return r;
    }
 
@@ -87,7 +443,7 @@ typename bcjr<real, dbl, norm>::array1d_t bcjr<real, dbl, norm>::getend() const
    {
    array1d_t r(M);
    for (int m = 0; m < M; m++)
-      r(m) = alpha(tau, m);
+      r(m) = window ? alphatau(m) : alpha(tau, m);
    return r;
    }
 
@@ -98,8 +454,7 @@ void bcjr<real, dbl, norm>::setstart()
    {
    if (!initialised)
       allocate();
-   for (int m = 0; m < M; m++)
-      alpha(0, m) = real(1.0 / M);
+   alpha0 = real(1.0 / M);
    }
 
 template <class real, class dbl, bool norm>
@@ -107,8 +462,7 @@ void bcjr<real, dbl, norm>::setend()
    {
    if (!initialised)
       allocate();
-   for (int m = 0; m < M; m++)
-      beta(tau, m) = real(1.0 / M);
+   betatau = real(1.0 / M);
    }
 
 // Set start- and end-state probabilities - known state
@@ -118,9 +472,8 @@ void bcjr<real, dbl, norm>::setstart(int state)
    {
    if (!initialised)
       allocate();
-   for (int m = 0; m < M; m++)
-      alpha(0, m) = 0;
-   alpha(0, state) = 1;
+   alpha0 = real(0);
+   alpha0(state) = real(1);
    }
 
 template <class real, class dbl, bool norm>
@@ -128,9 +481,8 @@ void bcjr<real, dbl, norm>::setend(int state)
    {
    if (!initialised)
       allocate();
-   for (int m = 0; m < M; m++)
-      beta(tau, m) = 0;
-   beta(tau, state) = 1;
+   betatau = real(0);
+   betatau(state) = real(1);
    }
 
 // Set start- and end-state probabilities - direct
@@ -142,7 +494,7 @@ void bcjr<real, dbl, norm>::setstart(const array1d_t& p)
    if (!initialised)
       allocate();
    for (int m = 0; m < M; m++)
-      alpha(0, m) = real(p(m));
+      alpha0(m) = real(p(m));
    }
 
 template <class real, class dbl, bool norm>
@@ -152,7 +504,7 @@ void bcjr<real, dbl, norm>::setend(const array1d_t& p)
    if (!initialised)
       allocate();
    for (int m = 0; m < M; m++)
-      beta(tau, m) = real(p(m));
+      betatau(m) = real(p(m));
    }
 
 // Internal methods
@@ -162,11 +514,31 @@ void bcjr<real, dbl, norm>::setend(const array1d_t& p)
 template <class real, class dbl, bool norm>
 void bcjr<real, dbl, norm>::allocate()
    {
-   // to save space, gamma is defined from 0 to tau-1, rather than 1 to tau.
-   // for this reason, gamma_t (and only gamma_t) is actually written gamma[t-1, ...
-   alpha.init(tau + 1, M);
-   beta.init(tau + 1, M);
-   gamma.init(tau, M, K);
+   if (window)
+      {
+      // alpha and gamma are only kept for the current window, with
+      // alpha(r, ...) for time s+r and gamma_t written gamma[t-s-1, ...
+      // the last gamma row is used during the backward recursion warm-up
+      // beta is kept for the current time-step only, with a second row
+      // for the next value
+      alpha.init(window + 1, M);
+      beta.init(2, M);
+      gamma.init(window + 1, M, K);
+      beta0.init(M);
+      alphatau.init(M);
+      rk.init(K);
+      rn.init(N);
+      }
+   else
+      {
+      // to save space, gamma is defined from 0 to tau-1, rather than 1 to tau.
+      // for this reason, gamma_t (and only gamma_t) is actually written gamma[t-1, ...
+      alpha.init(tau + 1, M);
+      beta.init(tau + 1, M);
+      gamma.init(tau, M, K);
+      }
+   alpha0.init(M);
+   betatau.init(M);
    // flag the state of the arrays
    initialised = true;
 
@@ -176,7 +548,8 @@ void bcjr<real, dbl, norm>::allocate()
    const int prec = std::cerr.precision(1);
    // determine memory occupied and tell user
    const size_t bytes_used = sizeof(real) * (alpha.size() + beta.size()
-         + gamma.size());
+         + gamma.size() + alpha0.size() + betatau.size() + beta0.size()
+         + alphatau.size() + rk.size() + rn.size());
    std::cerr << "BCJR Memory Usage: " << bytes_used / double(1 << 20)
          << "MiB" << std::endl;
    // revert cerr to original format
@@ -251,7 +624,7 @@ void bcjr<real, dbl, norm>::work_gamma(const array2d_t& R, const array2d_t& app)
  * 
  * Alpha values only depend on the initial values (for t=0) and on the computed
  * gamma values; the matrix is recursively computed. Initial alpha values are
- * set in the creator and are never changed in the object's lifetime.
+ * set by the user with setstart().
  * 
  * \note Metrics are normalized using a variation of Matt Valenti's CML Theory
  * slides; this was initially an attempt at solving the numerical range
@@ -263,20 +636,16 @@ void bcjr<real, dbl, norm>::work_gamma(const array2d_t& R, const array2d_t& app)
 template <class real, class dbl, bool norm>
 void bcjr<real, dbl, norm>::work_alpha()
    {
+   // set up start-state probabilities
+   for (int m = 0; m < M; m++)
+      alpha(0, m) = alpha0(m);
    // using the computed gamma values, work out all alpha values at time t
    for (int t = 1; t <= tau; t++)
       {
-      // first initialise the next set of alpha entries
-      for (int m = 0; m < M; m++)
-         alpha(t, m) = 0;
-      // now start computing the summations
+      // compute the summations
       // tail conditions are automatically handled by zeros in the gamma matrix
-      for (int mdash = 0; mdash < M; mdash++)
-         for (int i = 0; i < K; i++)
-            {
-            int m = lut_m(mdash, i);
-            alpha(t, m) += alpha(t - 1, mdash) * gamma(t - 1, mdash, i);
-            }
+      bcjr_alpha_step(alpha.row(t), alpha.row(t - 1), gamma, t - 1, lut_m,
+            lut_prev);
       // normalize
       if (norm)
          {
@@ -296,25 +665,20 @@ void bcjr<real, dbl, norm>::work_alpha()
  * 
  * Beta values only depend on the final values (for t=tau) and on the computed
  * gamma values; the matrix is recursively computed. Final beta values are set
- * in the creator and are never changed in the object's lifetime.
+ * by the user with setend().
  * 
  * \sa See notes for work_alpha()
  */
 template <class real, class dbl, bool norm>
 void bcjr<real, dbl, norm>::work_beta()
    {
+   // set up end-state probabilities
+   for (int m = 0; m < M; m++)
+      beta(tau, m) = betatau(m);
    // evaluate all beta values
    for (int t = tau - 1; t >= 0; t--)
       {
-      for (int m = 0; m < M; m++)
-         {
-         beta(t, m) = 0;
-         for (int i = 0; i < K; i++)
-            {
-            int mdash = lut_m(m, i);
-            beta(t, m) += beta(t + 1, mdash) * gamma(t, m, i);
-            }
-         }
+      bcjr_beta_step(beta.row(t), beta.row(t + 1), gamma, t, lut_m);
       // normalize
       if (norm)
          {
@@ -410,6 +774,384 @@ void bcjr<real, dbl, norm>::work_results(array2d_t& ri)
          }
    }
 
+// Internal methods - sliding-window mode
+
+/*!
+ * \brief   Computes one row of the gamma matrix (sliding-window mode).
+ * \param   t     Time-step for which gamma_t is required, in [1,tau]
+ * \param   row   Row of the gamma matrix to hold the results
+ * \param   R     R(t-1, X) is the probability of receiving "whatever we
+ * received" at time t, having transmitted X
+ * \param   app   app(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t (NULL if not available)
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_gamma(const int t, const int row,
+      const array2d_t& R, const array2d_t* app)
+   {
+   if (app)
+      {
+      for (int mdash = 0; mdash < M; mdash++)
+         for (int i = 0; i < K; i++)
+            {
+            int X = lut_X(mdash, i);
+            gamma(row, mdash, i) = real(R(t - 1, X) * (*app)(t - 1, i));
+            }
+      }
+   else
+      {
+      for (int mdash = 0; mdash < M; mdash++)
+         for (int i = 0; i < K; i++)
+            {
+            int X = lut_X(mdash, i);
+            gamma(row, mdash, i) = real(R(t - 1, X));
+            }
+      }
+   }
+
+/*!
+ * \brief   Computes one step of the forward recursion (sliding-window mode).
+ * \param   row   Row of the alpha and gamma matrices for the previous
+ * time-step; results are written to the next row of the alpha matrix
+ *
+ * \sa See notes for work_alpha()
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_alpha(const int row)
+   {
+   // compute the summations
+   bcjr_alpha_step(alpha.row(row + 1), alpha.row(row), gamma, row, lut_m,
+         lut_prev);
+   // normalize
+   if (norm)
+      {
+      real scale = alpha(row + 1, 0);
+      for (int m = 1; m < M; m++)
+         scale += alpha(row + 1, m);
+      assertalways(scale > real(0));
+      scale = real(1) / scale;
+      for (int m = 0; m < M; m++)
+         alpha(row + 1, m) *= scale;
+      }
+   }
+
+/*!
+ * \brief   Computes one step of the backward recursion (sliding-window mode).
+ * \param   row   Row of the gamma matrix for the current time-step
+ *
+ * The beta values for the current time-step, held in the first row of the
+ * beta matrix, are replaced with those for the previous time-step.
+ *
+ * \sa See notes for work_alpha()
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_beta(const int row)
+   {
+   bcjr_beta_step(beta.row(1), beta.row(0), gamma, row, lut_m);
+   // normalize
+   if (norm)
+      {
+      real scale = beta(1, 0);
+      for (int m = 1; m < M; m++)
+         scale += beta(1, m);
+      assertalways(scale > real(0));
+      scale = real(1) / scale;
+      for (int m = 0; m < M; m++)
+         beta(1, m) *= scale;
+      }
+   // replace current values
+   for (int m = 0; m < M; m++)
+      beta(0, m) = beta(1, m);
+   }
+
+/*!
+ * \brief   Computes the results for one time-step (sliding-window mode).
+ * \param   row   Row of the alpha and gamma matrices for time-step t-1
+ * \param   t     Time-step for which results are required, in [1,tau]
+ * \param   ri    ri(t-1, i) is the probability that we transmitted
+ * (input value) i at time t
+ * \param   ro    ro(t-1, X) is the probability that we transmitted
+ * (output value) X at time t (NULL if not required)
+ *
+ * The beta values for time-step t are taken from the first row of the beta
+ * matrix. Since alpha and beta metrics are not consistently scaled across
+ * windows, Py cannot be determined once for the whole block; instead, the
+ * results are normalized by their sum at each time-step.
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_results(const int row, const int t,
+      array2d_t& ri, array2d_t* ro)
+   {
+   // accumulate the sigma values
+   rk = real(0);
+   rn = real(0);
+   for (int mdash = 0; mdash < M; mdash++) // for each possible state at time t-1
+      for (int i = 0; i < K; i++) // for each possible input, given present state
+         {
+         int m = lut_m(mdash, i);
+         real delta = alpha(row, mdash) * gamma(row, mdash, i) * beta(0, m);
+         rk(i) += delta;
+         if (ro)
+            rn(lut_X(mdash, i)) += delta;
+         }
+   // determine the normalization factor for this time-step
+   real Py = rk(0);
+   for (int i = 1; i < K; i++)
+      Py += rk(i);
+   // copy results into their final place
+   for (int i = 0; i < K; i++)
+      ri(t - 1, i) = dbl(rk(i) / Py);
+   if (ro)
+      for (int X = 0; X < N; X++)
+         (*ro)(t - 1, X) = dbl(rn(X) / Py);
+   }
+
+/*!
+ * \brief   Decodes a block using a sliding window.
+ * \param   R     R(t-1, X) is the probability of receiving "whatever we
+ * received" at time t, having transmitted X
+ * \param   app   app(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t (NULL if not available)
+ * \param   ri    ri(t-1, i) is the a posteriori probability of having
+ * transmitted (input value) i at time t (result)
+ * \param   ro    ro(t-1, X) = (result) a posteriori probability of having
+ * transmitted (output value) X at time t (result, NULL if not required)
+ *
+ * Windows are processed in order; for each window, the forward recursion is
+ * continued from the end of the previous window, keeping the alpha and
+ * gamma values. The backward recursion is then started 'warmup' time-steps
+ * beyond the end of the window (from equiprobable states, unless this
+ * reaches the end of the block) and continued through the window, computing
+ * the results on the way.
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_window(const array2d_t& R,
+      const array2d_t* app, array2d_t& ri, array2d_t* ro)
+   {
+   // Initialize results vectors
+   ri.init(tau, K);
+   if (ro)
+      ro->init(tau, N);
+   // set up start-state probabilities
+   for (int m = 0; m < M; m++)
+      alpha(0, m) = alpha0(m);
+   // process each window in turn
+   for (int s = 0; s < tau; s += window)
+      {
+      const int e = std::min(s + window, tau);
+      // forward recursion, keeping gamma values for the window
+      for (int t = s + 1; t <= e; t++)
+         {
+         work_gamma(t, t - s - 1, R, app);
+         work_alpha(t - s - 1);
+         }
+      // backward recursion warm-up
+      const int f = std::min(e + warmup, tau);
+      for (int m = 0; m < M; m++)
+         beta(0, m) = (f == tau) ? betatau(m) : real(1.0 / M);
+      for (int t = f; t > e; t--)
+         {
+         work_gamma(t, window, R, app);
+         work_beta(window);
+         }
+      // backward recursion over the window, with results
+      for (int t = e; t > s; t--)
+         {
+         work_results(t - s - 1, t, ri, ro);
+         work_beta(t - s - 1);
+         }
+      // keep boundary metrics, as needed
+      if (s == 0)
+         for (int m = 0; m < M; m++)
+            beta0(m) = beta(0, m);
+      if (e == tau)
+         for (int m = 0; m < M; m++)
+            alphatau(m) = alpha(e - s, m);
+      // carry the forward recursion into the next window
+      for (int m = 0; m < M; m++)
+         alpha(0, m) = alpha(e - s, m);
+      }
+   }
+
+// Internal methods - multi-frame mode
+
+/*! \brief Memory allocator for working matrices (multi-frame mode)
+ * \param   frames   Number of frames to be decoded together
+ *
+ * Space is kept for later calls with the same number of frames.
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::allocate(const int frames)
+   {
+   assert(initialised);
+   if (frames == bcjr::frames)
+      return;
+   bcjr::frames = frames;
+   falpha.init(tau + 1, M * frames);
+   fbeta.init(tau + 1, M * frames);
+   fgamma.init(tau, N * K * frames);
+   fscale.init(K + 1, frames);
+
+   // set required format, storing previous settings
+   const std::ios::fmtflags flags = std::cerr.flags();
+   std::cerr.setf(std::ios::fixed, std::ios::floatfield);
+   const int prec = std::cerr.precision(1);
+   // determine memory occupied and tell user
+   const size_t bytes_used = sizeof(real) * (falpha.size() + fbeta.size()
+         + fgamma.size() + fscale.size());
+   std::cerr << "BCJR Memory Usage (" << frames << " frames): " << bytes_used
+         / double(1 << 20) << "MiB" << std::endl;
+   // revert cerr to original format
+   std::cerr.precision(prec);
+   std::cerr.setf(flags);
+   }
+
+/*!
+ * \brief   Computes the gamma matrix for all frames.
+ * \param   R     R(f)(t-1, X) is the probability of receiving "whatever we
+ * received" at time t, having transmitted X, for frame f
+ * \param   app   app(f)(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t, for frame f
+ *
+ * Values are worked out for each combination of encoder output and input;
+ * these are the same as the gamma values for any transition with that output
+ * and input.
+ *
+ * \sa See notes for work_gamma()
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_batch_gamma(
+      const libbase::vector<array2d_t>& R,
+      const libbase::vector<array2d_t>& app)
+   {
+   const int F = frames;
+   for (int t = 1; t <= tau; t++)
+      {
+      real *g = fgamma.row(t - 1);
+      for (int f = 0; f < F; f++)
+         {
+         const dbl *r = R(f).row(t - 1);
+         const dbl *p = app(f).row(t - 1);
+         for (int X = 0; X < N; X++)
+            for (int i = 0; i < K; i++)
+               g[(X * K + i) * F + f] = real(r[X] * p[i]);
+         }
+      }
+   }
+
+/*!
+ * \brief   Computes the alpha matrix for all frames.
+ *
+ * \sa See notes for work_alpha()
+ */
+template <class real, class dbl, bool norm>
+template <int Fc>
+void bcjr<real, dbl, norm>::work_batch_alpha()
+   {
+   const int F = frames;
+   // set up start-state probabilities
+   for (int m = 0; m < M; m++)
+      for (int f = 0; f < F; f++)
+         falpha(0, m * F + f) = alpha0(m);
+   // using the computed gamma values, work out all alpha values at time t
+   for (int t = 1; t <= tau; t++)
+      {
+      bcjr_alpha_batch_step<real, Fc> (falpha.row(t), falpha.row(t - 1),
+            fgamma.row(t - 1), lut_X, lut_m, lut_prev, F);
+      if (norm)
+         bcjr_normalize_batch<real, Fc> (falpha.row(t), fscale.row(0), M, F);
+      }
+   }
+
+/*!
+ * \brief   Computes the beta matrix for all frames.
+ *
+ * \sa See notes for work_beta()
+ */
+template <class real, class dbl, bool norm>
+template <int Fc>
+void bcjr<real, dbl, norm>::work_batch_beta()
+   {
+   const int F = frames;
+   // set up end-state probabilities
+   for (int m = 0; m < M; m++)
+      for (int f = 0; f < F; f++)
+         fbeta(tau, m * F + f) = betatau(m);
+   // evaluate all beta values
+   for (int t = tau - 1; t >= 0; t--)
+      {
+      bcjr_beta_batch_step<real, Fc> (fbeta.row(t), fbeta.row(t + 1),
+            fgamma.row(t), lut_X, lut_m, F);
+      if (norm)
+         bcjr_normalize_batch<real, Fc> (fbeta.row(t), fscale.row(0), M, F);
+      }
+   }
+
+/*!
+ * \brief   Computes the final results for all frames (input only).
+ * \param   ri    ri(f)(t-1, i) is the probability that we transmitted
+ * (input value) i at time t, for frame f
+ *
+ * \sa See notes for work_results(array2d_t&)
+ */
+template <class real, class dbl, bool norm>
+template <int Fc>
+void bcjr<real, dbl, norm>::work_batch_results(libbase::vector<array2d_t>& ri)
+   {
+   const int F = frames;
+   real *Py = fscale.row(0);
+   real *r = fscale.row(1);
+   // Initialize results vectors
+   ri.init(F);
+   for (int f = 0; f < F; f++)
+      ri(f).init(tau, K);
+   // Compute probability of received sequence
+   const real *a = falpha.row(tau);
+   const real *b = fbeta.row(tau);
+   for (int f = 0; f < F; f++)
+      Py[f] = 0;
+   for (int mdash = 0; mdash < M; mdash++)
+      for (int f = 0; f < F; f++)
+         Py[f] += a[mdash * F + f] * b[mdash * F + f];
+   // Work out final results
+   for (int t = 1; t <= tau; t++)
+      {
+      bcjr_results_batch_step<real, Fc> (r, falpha.row(t - 1),
+            fgamma.row(t - 1), fbeta.row(t), lut_X, lut_m, F);
+      for (int f = 0; f < F; f++)
+         for (int i = 0; i < K; i++)
+            ri(f)(t - 1, i) = r[i * F + f] / Py[f];
+      }
+   }
+
+template <class real, class dbl, bool norm>
+template <int Fc>
+void bcjr<real, dbl, norm>::work_batch(libbase::vector<array2d_t>& ri)
+   {
+   work_batch_alpha<Fc> ();
+   work_batch_beta<Fc> ();
+   work_batch_results<Fc> (ri);
+   }
+
+/*!
+ * \brief   Selects the recursion specialized for the number of frames.
+ *
+ * Specializations for the common batch sizes allow the loops over frames to
+ * be unrolled completely.
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::work_batch(libbase::vector<array2d_t>& ri)
+   {
+   if (frames == 4)
+      work_batch<4> (ri);
+   else if (frames == 8)
+      work_batch<8> (ri);
+   else if (frames == 16)
+      work_batch<16> (ri);
+   else
+      work_batch<0> (ri);
+   }
+
 // Internal helper functions
 
 /*!
@@ -457,10 +1199,15 @@ void bcjr<real, dbl, norm>::decode(const array2d_t& R, array2d_t& ri,
       array2d_t& ro)
    {
    assert(initialised);
-   work_gamma(R);
-   work_alpha();
-   work_beta();
-   work_results(ri, ro);
+   if (window)
+      work_window(R, NULL, ri, &ro);
+   else
+      {
+      work_gamma(R);
+      work_alpha();
+      work_beta();
+      work_results(ri, ro);
+      }
    }
 
 /*!
@@ -482,10 +1229,15 @@ void bcjr<real, dbl, norm>::decode(const array2d_t& R, const array2d_t& app,
       array2d_t& ri, array2d_t& ro)
    {
    assert(initialised);
-   work_gamma(R, app);
-   work_alpha();
-   work_beta();
-   work_results(ri, ro);
+   if (window)
+      work_window(R, &app, ri, &ro);
+   else
+      {
+      work_gamma(R, app);
+      work_alpha();
+      work_beta();
+      work_results(ri, ro);
+      }
    }
 
 /*!
@@ -502,10 +1254,15 @@ template <class real, class dbl, bool norm>
 void bcjr<real, dbl, norm>::fdecode(const array2d_t& R, array2d_t& ri)
    {
    assert(initialised);
-   work_gamma(R);
-   work_alpha();
-   work_beta();
-   work_results(ri);
+   if (window)
+      work_window(R, NULL, ri, NULL);
+   else
+      {
+      work_gamma(R);
+      work_alpha();
+      work_beta();
+      work_results(ri);
+      }
    }
 
 /*!
@@ -522,10 +1279,46 @@ void bcjr<real, dbl, norm>::fdecode(const array2d_t& R, const array2d_t& app,
       array2d_t& ri)
    {
    assert(initialised);
-   work_gamma(R, app);
-   work_alpha();
-   work_beta();
-   work_results(ri);
+   if (window)
+      work_window(R, &app, ri, NULL);
+   else
+      {
+      work_gamma(R, app);
+      work_alpha();
+      work_beta();
+      work_results(ri);
+      }
+   }
+
+/*!
+ * \brief   Wrapping function for faster decoding of a set of frames.
+ * \param   R     R(f)(t-1, X) is the probability of receiving "whatever we
+ * received" at time t, having transmitted X, for frame f
+ * \param   app   app(f)(t-1, i) is the 'a priori' probability of having
+ * transmitted (input value) i at time t, for frame f
+ * \param   ri    ri(f)(t-1, i) is the a posteriori probability of having
+ * transmitted (input value) i at time t, for frame f (result)
+ *
+ * This gives the same results as calling fdecode() for each frame in turn;
+ * the recursions for all frames are worked out together.
+ */
+template <class real, class dbl, bool norm>
+void bcjr<real, dbl, norm>::fdecode(const libbase::vector<array2d_t>& R,
+      const libbase::vector<array2d_t>& app, libbase::vector<array2d_t>& ri)
+   {
+   assert(initialised);
+   assert(R.size() == app.size());
+   const int F = R.size();
+   if (window)
+      {
+      ri.init(F);
+      for (int f = 0; f < F; f++)
+         work_window(R(f), &app(f), ri(f), NULL);
+      return;
+      }
+   allocate(F);
+   work_batch_gamma(R, app);
+   work_batch(ri);
    }
 
 } // end namespace
@@ -536,6 +1329,7 @@ void bcjr<real, dbl, norm>::fdecode(const array2d_t& R, const array2d_t& app,
 #include "mpgnu.h"
 #include "logreal.h"
 #include "logrealfast.h"
+#include "logfixed.h"
 
 namespace libcomm {
 
@@ -543,6 +1337,8 @@ using libbase::mpreal;
 using libbase::mpgnu;
 using libbase::logreal;
 using libbase::logrealfast;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 template class bcjr<float, float, true> ;
 template class bcjr<float, double, true> ;
@@ -552,5 +1348,7 @@ template class bcjr<mpgnu> ;
 template class bcjr<logreal> ;
 template class bcjr<logrealfast> ;
 template class bcjr<logrealfast, logrealfast> ;
+template class bcjr<logfixed16, double, true> ;
+template class bcjr<logfixed8, double, true> ;
 
 } // end namespace
@@ -65,9 +65,36 @@ namespace libcomm {
  * backward recursion. This allows the use of double-precision representation
  * throughout the algorithm.
  *
+ * For long blocks, a sliding-window mode can be selected at initialization.
+ * The block is then processed in windows of 'window' time-steps: the forward
+ * recursion is carried across windows, while the backward recursion for
+ * each window is started 'warmup' time-steps beyond its end (or at the end
+ * of the block, if this is closer) from equiprobable states. Only the metrics
+ * for the current window are kept, so that memory requirements no longer
+ * depend on the block size. Results are exact if the warm-up reaches the end
+ * of the block; otherwise they approach the exact results as the warm-up
+ * length increases. In this mode, the results for each time-step are
+ * normalized to sum to one, which is also true of the whole-block results.
+ *
+ * A set of frames can also be decoded together (see the multi-frame fdecode).
+ * The working matrices then hold the metrics of all frames interleaved, with
+ * the frame index innermost, so that each step of the recursions is a loop
+ * over frames with unit stride; for 'float' and 'double' metrics the compiler
+ * vectorizes this loop. The recursions are specialized at compile-time for
+ * common numbers of frames (4, 8 and 16). The arithmetic for each frame is done in the same
+ * order as when decoding it alone, so results are identical. All frames use
+ * the same start- and end-state probabilities. In sliding-window mode, frames
+ * are simply decoded in turn.
+ *
  * \warning
  * - Static memory requirements:
  * sizeof(real)*(2*(tau+1)*M + tau*M*K + K + N) + sizeof(int)*(2*K+1)*M
+ * - Static memory requirements (sliding-window mode):
+ * sizeof(real)*((W+3)*M + (W+1)*M*K + 4*M + K + N) + sizeof(int)*(2*K+1)*M
+ * where W is the window length
+ * - Static memory requirements (multi-frame mode, additional):
+ * sizeof(real)*F*(2*(tau+1)*M + tau*N*K + K + 1) where F is the number of
+ * frames
  * - Dynamic memory requirements:
  * none
  *
@@ -84,6 +111,7 @@ public:
    typedef libbase::matrix<int> array2i_t;
    typedef libbase::vector<dbl> array1d_t;
    typedef libbase::matrix<dbl> array2d_t;
+   typedef libbase::vector<real> array1r_t;
    typedef libbase::matrix<real> array2r_t;
    typedef libbase::matrix3<real> array3r_t;
    // @}
@@ -93,6 +121,8 @@ private:
    int K; //!< Input alphabet size
    int N; //!< Output alphabet size
    int M; //!< Number of encoder states
+   int window; //!< Sliding window length in time-steps (0 for whole block)
+   int warmup; //!< Backward recursion warm-up length in time-steps
    bool initialised; //!< Flag to indicate when memory is allocated
    // @}
    /*! \name Working matrices */
@@ -103,11 +133,35 @@ private:
    //! Receiver metric: gamma(t-1,m',i) = Pr{S(t)=m(m',i), Y(t) | S(t-1)=m'}
    array3r_t gamma;
    // @}
+   /*! \name Boundary metrics */
+   array1r_t alpha0; //!< Start-state probabilities, as set by user
+   array1r_t betatau; //!< End-state probabilities, as set by user
+   array1r_t beta0; //!< Computed beta(0,m), from the last decoding (sliding-window mode)
+   array1r_t alphatau; //!< Computed alpha(tau,m), from the last decoding (sliding-window mode)
+   // @}
+   /*! \name Per-step results (sliding-window mode) */
+   array1r_t rk; //!< Input results for current time-step
+   array1r_t rn; //!< Output results for current time-step
+   // @}
+   /*! \name Working matrices (multi-frame mode) */
+   int frames; //!< Number of frames for which space is allocated
+   //! Forward recursion metric: falpha(t,m*F+f) = alpha(t,m) for frame f
+   array2r_t falpha;
+   //! Backward recursion metric: fbeta(t,m*F+f) = beta(t,m) for frame f
+   array2r_t fbeta;
+   //! Receiver metric: fgamma(t-1,(X*K+i)*F+f) = gamma(t-1,m',i) for frame f,
+   //! where X is the encoder output for state m' and input i
+   array2r_t fgamma;
+   //! Per-frame temporary space (normalization factors and results)
+   array2r_t fscale;
+   // @}
    /*! \name Temporary (cache) matrices */
    //! lut_X(m,i) = encoder output, given state 'm' and input 'i'
    array2i_t lut_X;
    //! lut_m(m,i) = next state, given state 'm' and input 'i'
    array2i_t lut_m;
+   //! lut_prev(m,j) = (mdash*K+i) for the j-th transition into state 'm'
+   array2i_t lut_prev;
    // @}
 private:
    /*! \name Internal methods */
@@ -120,12 +174,33 @@ private:
    void work_beta();
    void work_results(array2d_t& ri, array2d_t& ro);
    void work_results(array2d_t& ri);
+   void work_gamma(const int t, const int row, const array2d_t& R,
+         const array2d_t* app);
+   void work_alpha(const int row);
+   void work_beta(const int row);
+   void work_results(const int row, const int t, array2d_t& ri,
+         array2d_t* ro);
+   void work_window(const array2d_t& R, const array2d_t* app, array2d_t& ri,
+         array2d_t* ro);
+   void allocate(const int frames);
+   void work_batch_gamma(const libbase::vector<array2d_t>& R,
+         const libbase::vector<array2d_t>& app);
+   template <int Fc>
+   void work_batch_alpha();
+   template <int Fc>
+   void work_batch_beta();
+   template <int Fc>
+   void work_batch_results(libbase::vector<array2d_t>& ri);
+   template <int Fc>
+   void work_batch(libbase::vector<array2d_t>& ri);
+   void work_batch(libbase::vector<array2d_t>& ri);
    // @}
 protected:
    // normalization function for derived classes
    static void normalize(array2d_t& r);
    // main initialization routine - constructor essentially just calls this
-   void init(fsm& encoder, const int tau);
+   void init(fsm& encoder, const int tau, const int window = 0,
+         const int warmup = 0);
    // get start- and end-state probabilities
    array1d_t getstart() const;
    array1d_t getend() const;
@@ -141,7 +216,10 @@ protected:
    // default constructor
    bcjr()
       {
+      window = 0;
+      warmup = 0;
       initialised = false;
+      frames = 0;
       }
 public:
    /*! \name Constructor & destructor */
@@ -157,6 +235,8 @@ public:
          array2d_t& ro);
    void fdecode(const array2d_t& R, array2d_t& ri);
    void fdecode(const array2d_t& R, const array2d_t& app, array2d_t& ri);
+   void fdecode(const libbase::vector<array2d_t>& R, const libbase::vector<
+         array2d_t>& app, libbase::vector<array2d_t>& ri);
    // @}
 
    /*! \name Information functions */
@@ -180,6 +260,16 @@ public:
       {
       return libbase::size_type<libbase::vector>(tau);
       }
+   //! Sliding window length (0 if decoding the whole block at once)
+   int window_size() const
+      {
+      return window;
+      }
+   //! Backward recursion warm-up length (sliding-window mode)
+   int warmup_size() const
+      {
+      return warmup;
+      }
    // @}
 };
 
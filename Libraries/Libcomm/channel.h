@@ -113,6 +113,9 @@ public:
     *
     * Default implementation is suitable for substitution channels, and
     * performs channel-specific operation through the corrupt() override.
+    * Channels may override this to draw the random deviates for the whole
+    * sequence at once; these are then taken in the same order as by
+    * corrupt(), so that the result is unchanged.
     *
     * \note It is possible that the \c tx and \c rx parameters actually point
     * to the same vector.
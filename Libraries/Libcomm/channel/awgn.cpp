@@ -44,6 +44,24 @@ sigspace awgn::corrupt(const sigspace& s)
    return s + sigspace(x, y);
    }
 
+/*!
+ * \copydoc channel::transmit()
+ *
+ * The in-phase and quadrature components for each symbol are consecutive
+ * Gaussian deviates.
+ */
+void awgn::transmit(const array1s_t& tx, array1s_t& rx)
+   {
+   const int tau = tx.size();
+   // Generate noise samples, in the order used by corrupt()
+   libbase::vector<double> n(2 * tau);
+   r.gval(n, sigma);
+   // Corrupt the modulation symbols
+   rx.init(tau);
+   for (int i = 0; i < tau; i++)
+      rx(i) = tx(i) + sigspace(n(2 * i), n(2 * i + 1));
+   }
+
 double awgn::pdf(const sigspace& tx, const sigspace& rx) const
    {
    sigspace n = rx - tx;
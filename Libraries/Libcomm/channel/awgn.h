@@ -90,6 +90,8 @@ protected:
    sigspace corrupt(const sigspace& s);
    double pdf(const sigspace& tx, const sigspace& rx) const;
 public:
+   // Channel functions
+   void transmit(const array1s_t& tx, array1s_t& rx);
    // Description
    std::string description() const;
 
@@ -65,6 +65,23 @@ bool bsc::corrupt(const bool& s)
    return s;
    }
 
+/*!
+ * \copydoc channel::transmit()
+ *
+ * Each symbol takes one uniform deviate, to decide whether it is substituted.
+ */
+void bsc::transmit(const array1s_t& tx, array1s_t& rx)
+   {
+   const int tau = tx.size();
+   // Generate one uniform deviate per symbol, as used by corrupt()
+   libbase::vector<double> p(tau);
+   r.fval_closed(p);
+   // Corrupt the modulation symbols
+   rx.init(tau);
+   for (int i = 0; i < tau; i++)
+      rx(i) = (p(i) < Ps) ? !tx(i) : tx(i);
+   }
+
 // description output
 
 std::string bsc::description() const
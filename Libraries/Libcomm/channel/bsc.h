@@ -55,6 +55,10 @@ protected:
    bool corrupt(const bool& s);
    double pdf(const bool& tx, const bool& rx) const;
 public:
+   /*! \name Channel functions */
+   void transmit(const array1s_t& tx, array1s_t& rx);
+   // @}
+
    /*! \name Constructors / Destructors */
    //! Default constructor
    bsc()
@@ -447,6 +447,148 @@ bsid::real bsid::metric_computer::receive(const bitfield& tx,
    }
 #endif
 
+/*!
+ * \brief Batch receiver metric, for a set of codewords and end drifts
+ * \param[in] tx Set of codewords under consideration (all of the same size)
+ * \param[in] rx Received sequence, long enough for the largest end drift
+ * \param[in] mumin Smallest end drift required
+ * \param[out] ptable Receiver metric ptable(d,mu-mumin) for codeword tx(d)
+ *              and received subsequence rx.extract(0, n+mu), for mu in
+ *              [mumin, rx.size()-n]
+ *
+ * The result is identical to calling the single-codeword receive() for
+ * each codeword and received subsequence, but the forward lattice is only
+ * computed once over the longest received sequence. This is possible because
+ * the lattice entries used by a shorter received sequence do not depend on
+ * any of the later received bits. The lattice is also computed for all
+ * codewords together, with the codeword index innermost, so that the inner
+ * loop can be vectorized by the compiler.
+ */
+#ifndef USE_CUDA
+void bsid::metric_computer::receive(const libbase::vector<bitfield>& tx,
+      const array1b_t& rx, const int mumin, array2r_t& ptable) const
+   {
+   using std::min;
+   using std::max;
+   using std::swap;
+   // Compute sizes
+   const int q = tx.size();
+   assert(q > 0);
+   const int n = tx(0).size();
+   const int mumax = rx.size() - n;
+   assert(n <= N);
+   assert(labs(mumin) <= xmax && labs(mumax) <= xmax);
+   assert(mumin <= mumax);
+   // Set up two slices of forward matrix, with the codeword index innermost
+   const int size = 2 * xmax + 1;
+   libbase::vector<real> F0(size * q);
+   libbase::vector<real> F1(size * q);
+   real *Fthis = &F1(0);
+   real *Fprev = &F0(0);
+   // Set up the transmitted bit for each codeword, at each position
+   libbase::vector<real> txbits(n * q);
+   for (int j = 0; j < n; j++)
+      for (int d = 0; d < q; d++)
+         {
+         assert(tx(d).size() == n);
+         txbits(j * q + d) = tx(d)(j);
+         }
+   // for prior list, reset all elements to zero
+   for (int x = 0; x < size * q; x++)
+      Fprev[x] = 0;
+   // we also know x[0] = 0; ie. drift before transmitting bit t0 is zero.
+   for (int d = 0; d < q; d++)
+      Fprev[xmax * q + d] = 1;
+   // compute remaining matrix values
+   for (int j = 1; j < n; ++j)
+      {
+      // for this list, reset all elements to zero
+      for (int x = 0; x < size * q; x++)
+         Fthis[x] = 0;
+      // transmitted bits for this position
+      const real *tj = &txbits((j - 1) * q);
+      // limits as for the single-codeword case
+      const int ymin = max(0, xmax - j);
+      const int ymax = min(2 * xmax, xmax + rx.size() - j);
+      for (int y = ymin; y <= ymax; ++y)
+         {
+         real *result = &Fthis[y * q];
+         const int amin = max(max(0, xmax + 1 - j), y - I);
+         const int amax = min(2 * xmax, y + 1);
+         // check if the last element is a pure deletion
+         int amax_act = amax;
+         if (y - amax < 0)
+            {
+            const real *prev = &Fprev[amax * q];
+            for (int d = 0; d < q; d++)
+               result[d] += prev[d] * Rval;
+            amax_act--;
+            }
+         // elements requiring comparison of tx and rx bits
+         const real rb = rx(j + (y - xmax) - 1);
+         for (int a = amin; a <= amax_act; ++a)
+            {
+            const real *prev = &Fprev[a * q];
+            const real R0 = Rtable(0, y - a);
+            const real R1 = Rtable(1, y - a);
+            for (int d = 0; d < q; d++)
+               result[d] += prev[d] * (tj[d] != rb ? R1 : R0);
+            }
+         }
+      // swap 'this' and 'prior' lists
+      swap(Fthis, Fprev);
+      }
+   // Compute forward metric for each known drift
+   ptable.init(q, mumax - mumin + 1);
+   const real *tn = &txbits((n - 1) * q);
+   for (int mu = mumin; mu <= mumax; mu++)
+      {
+      const int muoff = mu + xmax;
+      const int amin = max(max(0, muoff - I), xmax + 1 - n);
+      const int amax = min(2 * xmax, muoff + 1);
+      // check if the last element is a pure deletion
+      int amax_act = amax;
+      for (int d = 0; d < q; d++)
+         ptable(d, mu - mumin) = 0;
+      if (muoff - amax < 0)
+         {
+         for (int d = 0; d < q; d++)
+            ptable(d, mu - mumin) += Fprev[amax * q + d] * Rval;
+         amax_act--;
+         }
+      // elements requiring comparison of tx and rx bits
+      const real rb = rx(n + mu - 1);
+      for (int a = amin; a <= amax_act; ++a)
+         {
+         const real R0 = Rtable(0, muoff - a);
+         const real R1 = Rtable(1, muoff - a);
+         for (int d = 0; d < q; d++)
+            ptable(d, mu - mumin) += Fprev[a * q + d] * (tn[d] != rb ? R1
+                  : R0);
+         }
+      }
+   }
+#else
+void bsid::metric_computer::receive(const libbase::vector<bitfield>& tx,
+      const array1b_t& rx, const int mumin, array2r_t& ptable) const
+   {
+   // Compute sizes
+   const int q = tx.size();
+   assert(q > 0);
+   const int n = tx(0).size();
+   const int mumax = rx.size() - n;
+   assert(mumin <= mumax);
+   // Compute each metric separately on the device
+   ptable.init(q, mumax - mumin + 1);
+   for (int mu = mumin; mu <= mumax; mu++)
+      {
+      const array1b_t rxmu = rx.extract(0, n + mu);
+      for (int d = 0; d < q; d++)
+         ptable(d, mu - mumin) = receive(tx(d), rxmu);
+      }
+   }
+#endif
+
 /*!
  * \brief Initialization
  *
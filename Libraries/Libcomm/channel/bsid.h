@@ -234,6 +234,10 @@ public:
       real receive(const bitfield& tx, const array1b_t& rx) const;
       // @}
 #endif
+      /*! \name Batch interface */
+      void receive(const libbase::vector<bitfield>& tx, const array1b_t& rx,
+            const int mumin, array2r_t& ptable) const;
+      // @}
    };
    // @}
 private:
@@ -51,6 +51,24 @@ sigspace lapgauss::corrupt(const sigspace& s)
    return s + sigspace(x, y);
    }
 
+/*!
+ * \copydoc channel::transmit()
+ *
+ * Each symbol takes two Gaussian deviates: the first for the in-phase
+ * component and the second for the quadrature component.
+ */
+void lapgauss::transmit(const array1s_t& tx, array1s_t& rx)
+   {
+   const int tau = tx.size();
+   // Generate noise samples, in the order used by corrupt()
+   libbase::vector<double> n(2 * tau);
+   r.gval(n, sigma);
+   // Corrupt the modulation symbols
+   rx.init(tau);
+   for (int i = 0; i < tau; i++)
+      rx(i) = tx(i) + sigspace(n(2 * i), n(2 * i + 1));
+   }
+
 double lapgauss::pdf(const sigspace& tx, const sigspace& rx) const
    {
    using libbase::gauss;
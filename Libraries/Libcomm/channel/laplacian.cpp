@@ -97,6 +97,26 @@ sigspace laplacian<sigspace>::corrupt(const sigspace& s)
    return s + sigspace(x, y);
    }
 
+/*!
+ * \copydoc channel::transmit()
+ *
+ * Each noise component is obtained from a uniform deviate through the inverse
+ * Laplacian distribution function.
+ */
+void laplacian<sigspace>::transmit(const array1s_t& tx, array1s_t& rx)
+   {
+   const int tau = tx.size();
+   // Generate noise samples, in the order used by corrupt()
+   libbase::vector<double> n(2 * tau);
+   r.fval_closed(n);
+   for (int i = 0; i < 2 * tau; i++)
+      n(i) = Finv(n(i));
+   // Corrupt the modulation symbols
+   rx.init(tau);
+   for (int i = 0; i < tau; i++)
+      rx(i) = tx(i) + sigspace(n(2 * i), n(2 * i + 1));
+   }
+
 double laplacian<sigspace>::pdf(const sigspace& tx, const sigspace& rx) const
    {
    sigspace n = rx - tx;
@@ -70,6 +70,48 @@ G qsc<G>::corrupt(const G& s)
    return s;
    }
 
+/*!
+ * \copydoc channel::transmit()
+ *
+ * Each symbol uses one deviate, and each substituted symbol uses a second one
+ * for the error value. Since at least one deviate is needed for every
+ * remaining symbol, batches are sized to the number of remaining symbols so
+ * that none are wasted.
+ */
+template <class G>
+void qsc<G>::transmit(const array1s_t& tx, array1s_t& rx)
+   {
+   const int tau = tx.size();
+   const double m = double(this->r.ival_max());
+   libbase::vector<libbase::int32u> u;
+   int k = 0;
+   // Corrupt the modulation symbols
+   rx.init(tau);
+   for (int i = 0; i < tau; i++)
+      {
+      if (k == u.size())
+         {
+         u.init(tau - i);
+         this->r.ival(u);
+         k = 0;
+         }
+      const double p = u(k++) / m;
+      if (p < Ps)
+         {
+         if (k == u.size())
+            {
+            u.init(tau - i);
+            this->r.ival(u);
+            k = 0;
+            }
+         const int e = int(floor(u(k++) / (m + 1.0) * (G::elements() - 1)));
+         rx(i) = tx(i) + G(e + 1);
+         }
+      else
+         rx(i) = tx(i);
+      }
+   }
+
 // description output
 
 template <class G>
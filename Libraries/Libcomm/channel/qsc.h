@@ -56,6 +56,10 @@ namespace libcomm {
 
 template <class G>
 class qsc : public channel<G> {
+public:
+   /*! \name Type definitions */
+   typedef libbase::vector<G> array1s_t;
+   // @}
 private:
    /*! \name User-defined parameters */
    double Ps; //!< Symbol-substitution probability \f$ P_s \f$
@@ -65,6 +69,10 @@ protected:
    G corrupt(const G& s);
    double pdf(const G& tx, const G& rx) const;
 public:
+   /*! \name Channel functions */
+   void transmit(const array1s_t& tx, array1s_t& rx);
+   // @}
+
    /*! \name Constructors / Destructors */
    //! Default constructor
    qsc()
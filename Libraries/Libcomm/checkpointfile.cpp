@@ -0,0 +1,382 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "checkpointfile.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+namespace libcomm {
+
+using libbase::trace;
+using libbase::int32u;
+using libbase::int64u;
+using libbase::vector;
+
+// Object-wide constants
+
+const int32u checkpointfile::version = 1;
+const int32u checkpointfile::order = 0x01020304;
+const int32u checkpointfile::record = 0x54504b43;
+
+// Internal functions
+
+/*!
+ * \brief Compute the checksum for a record
+ * \param[in] h Record header (the checksum field itself is not included)
+ * \param[in] state State values
+ *
+ * This is a Fletcher checksum over 32-bit words, with 64-bit result.
+ */
+int64u checkpointfile::checksum(const recordheader& h,
+      const vector<double>& state)
+   {
+   const int64u mod = 0xffffffff;
+   int64u a = 0;
+   int64u b = 0;
+   // header words, after the checksum field
+   const int32u *w = reinterpret_cast<const int32u *> (&h);
+   const int hn = (sizeof(recordheader) - sizeof(h.checksum)) / sizeof(int32u);
+   w += sizeof(h.checksum) / sizeof(int32u);
+   for (int i = 0; i < hn; i++)
+      {
+      a = (a + w[i]) % mod;
+      b = (b + a) % mod;
+      }
+   // state values
+   if (state.size() > 0)
+      {
+      w = reinterpret_cast<const int32u *> (&state(0));
+      const int n = state.size() * sizeof(double) / sizeof(int32u);
+      for (int i = 0; i < n; i++)
+         {
+         a = (a + w[i]) % mod;
+         b = (b + a) % mod;
+         }
+      }
+   return (b << 32) | a;
+   }
+
+//! Set up a file header for the current format
+void checkpointfile::makeheader(fileheader& h)
+   {
+   memset(&h, 0, sizeof(h));
+   memcpy(h.magic, "SCSCKPT", 8);
+   h.version = version;
+   h.order = order;
+   }
+
+//! Set up a record header with the given key, clearing all other fields
+void checkpointfile::makekey(recordheader& h, const sha& digest,
+      const double parameter)
+   {
+   memset(&h, 0, sizeof(h));
+   const std::vector<unsigned char> d = digest;
+   assertalways(d.size() == sizeof(h.digest));
+   memcpy(h.digest, &d[0], sizeof(h.digest));
+   h.parameter = parameter;
+   h.magic = record;
+   }
+
+//! Check whether two record headers have the same key
+bool checkpointfile::samekey(const recordheader& a, const recordheader& b)
+   {
+   return a.parameter == b.parameter && memcmp(a.digest, b.digest,
+         sizeof(a.digest)) == 0;
+   }
+
+/*!
+ * \brief Read and validate one copy of a record
+ * \param[in] file Checkpoint file
+ * \param[in] pos Position of the record copy in file
+ * \param[in] size Number of state values held by the slot
+ * \param[out] h Record header
+ * \param[out] state State values
+ * \return True if the copy was ever written and passes the checksum
+ *
+ * The size field of the copy is not trusted; a copy whose size does not
+ * match the slot (as found by findslot()) is rejected before allocating.
+ */
+bool checkpointfile::readcopy(std::istream& file, std::streamoff pos,
+      int64u size, recordheader& h, vector<double>& state)
+   {
+   file.clear();
+   file.seekg(pos);
+   file.read(reinterpret_cast<char *> (&h), sizeof(h));
+   if (!file || h.magic != record || h.sequence == 0 || h.size != size)
+      return false;
+   state.init(int(h.size));
+   if (h.size > 0)
+      file.read(reinterpret_cast<char *> (&state(0)), h.size * sizeof(double));
+   if (!file)
+      return false;
+   return h.checksum == checksum(h, state);
+   }
+
+/*!
+ * \brief Find the slot for a given key
+ * \param[in] file Checkpoint file, with a valid file header
+ * \param[in] key Record header holding the key to look for
+ * \param[out] h First record header for the slot found
+ * \return Position of the slot in file, or -1 if not found
+ *
+ * Only the slot headers are read, stepping over the record contents. Where
+ * more than one slot has the same key (ie. with different state sizes), the
+ * last one is returned. Any incomplete slot at the end of the file (left by
+ * an interrupted write), or a slot whose size would extend beyond the end of
+ * the file, is ignored.
+ */
+std::streamoff checkpointfile::findslot(std::istream& file,
+      const recordheader& key, recordheader& h) const
+   {
+   file.seekg(0, std::ios_base::end);
+   const std::streamoff length = file.tellg();
+   std::streamoff found = -1;
+   std::streamoff pos = sizeof(fileheader);
+   while (pos + std::streamoff(sizeof(recordheader)) <= length)
+      {
+      recordheader cur;
+      file.seekg(pos);
+      file.read(reinterpret_cast<char *> (&cur), sizeof(cur));
+      if (!file || cur.magic != record)
+         break;
+      // check size before computing the slot extent, to avoid overflow
+      if (cur.size > int64u(length - pos) / (2 * sizeof(double)))
+         break;
+      const std::streamoff slotsize = 2 * (sizeof(recordheader) + cur.size
+            * sizeof(double));
+      if (pos + slotsize > length)
+         break;
+      if (samekey(cur, key))
+         {
+         found = pos;
+         h = cur;
+         }
+      pos += slotsize;
+      }
+   file.clear();
+   return found;
+   }
+
+// Checkpoint interface
+
+/*!
+ * \brief Check whether the checkpoint file exists
+ *
+ * Results files without a checkpoint file can only hold states as text
+ * (from older versions); this allows the caller to look for those only then.
+ */
+bool checkpointfile::exists() const
+   {
+   std::ifstream file(fname.c_str(), std::ios::in | std::ios::binary);
+   return file.good();
+   }
+
+/*!
+ * \brief Read the saved state for a given key
+ * \param[in] digest Digest of simulated system
+ * \param[in] parameter Simulation parameter
+ * \param[out] samplecount Number of samples accumulated
+ * \param[out] state State values
+ * \return True if a valid state was found
+ *
+ * Does nothing if the file does not exist, or is not in the current format.
+ */
+bool checkpointfile::read(const sha& digest, const double parameter,
+      int64u& samplecount, vector<double>& state) const
+   {
+   std::ifstream file(fname.c_str(), std::ios::in | std::ios::binary);
+   if (!file)
+      return false;
+   // check file header
+   fileheader fh, ref;
+   makeheader(ref);
+   file.read(reinterpret_cast<char *> (&fh), sizeof(fh));
+   if (!file || memcmp(&fh, &ref, sizeof(fh)) != 0)
+      {
+      trace << "DEBUG (checkpointfile): unknown format in " << fname
+            << std::endl;
+      return false;
+      }
+   // find slot for key
+   recordheader key, h;
+   makekey(key, digest, parameter);
+   const std::streamoff pos = findslot(file, key, h);
+   if (pos < 0)
+      return false;
+   // read both copies, using the latest valid one
+   const std::streamoff copysize = sizeof(recordheader) + h.size
+         * sizeof(double);
+   recordheader h0, h1;
+   vector<double> s0, s1;
+   const bool v0 = readcopy(file, pos, h.size, h0, s0);
+   const bool v1 = readcopy(file, pos + copysize, h.size, h1, s1);
+   if (v1 && (!v0 || h1.sequence > h0.sequence))
+      {
+      samplecount = h1.samplecount;
+      state = s1;
+      }
+   else if (v0)
+      {
+      samplecount = h0.samplecount;
+      state = s0;
+      }
+   else
+      return false;
+   trace << "DEBUG (checkpointfile): read state with " << samplecount
+         << " samples." << std::endl;
+   return true;
+   }
+
+/*!
+ * \brief Save the state for a given key
+ * \param[in] digest Digest of simulated system
+ * \param[in] parameter Simulation parameter
+ * \param[in] samplecount Number of samples accumulated
+ * \param[in] state State values
+ *
+ * If a slot with the same key and state size exists, the older of its two
+ * copies is overwritten (or the newer one, if that does not pass the
+ * checksum); otherwise a new slot is appended to the file. The file is
+ * created if necessary.
+ */
+void checkpointfile::write(const sha& digest, const double parameter,
+      const int64u samplecount, const vector<double>& state) const
+   {
+   std::fstream file(fname.c_str(), std::ios::in | std::ios::out
+         | std::ios::binary);
+   // set up file header
+   fileheader fh, ref;
+   makeheader(ref);
+   if (!file)
+      {
+      trace << "DEBUG (checkpointfile): file not found - creating." << std::endl;
+      file.clear();
+      file.open(fname.c_str(), std::ios::out | std::ios::binary);
+      assertalways(file.good());
+      file.write(reinterpret_cast<const char *> (&ref), sizeof(ref));
+      file.close();
+      file.open(fname.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+      }
+   assertalways(file.good());
+   file.read(reinterpret_cast<char *> (&fh), sizeof(fh));
+   if (!file || memcmp(&fh, &ref, sizeof(fh)) != 0)
+      failwith("Checkpoint file is in an unknown format.");
+   // set up record header
+   recordheader h;
+   makekey(h, digest, parameter);
+   h.samplecount = samplecount;
+   h.size = state.size();
+   const std::streamoff copysize = sizeof(recordheader) + h.size
+         * sizeof(double);
+   // find slot for key, and determine which copy to overwrite
+   recordheader cur;
+   std::streamoff pos = findslot(file, h, cur);
+   if (pos >= 0 && cur.size == h.size)
+      {
+      recordheader h0, h1;
+      vector<double> s;
+      const bool v0 = readcopy(file, pos, cur.size, h0, s);
+      const bool v1 = readcopy(file, pos + copysize, cur.size, h1, s);
+      file.clear();
+      // the copy to keep is the latest valid one
+      const bool keep1 = v1 && (!v0 || h1.sequence > h0.sequence);
+      if (keep1)
+         h.sequence = h1.sequence + 1;
+      else
+         {
+         h.sequence = v0 ? h0.sequence + 1 : 1;
+         pos += copysize;
+         }
+      }
+   else
+      {
+      // append a new slot, with an empty second copy
+      file.seekp(0, std::ios_base::end);
+      pos = file.tellp();
+      recordheader empty = h;
+      empty.sequence = 0;
+      empty.checksum = 0;
+      file.seekp(pos + copysize);
+      file.write(reinterpret_cast<const char *> (&empty), sizeof(empty));
+      const std::vector<char> zeros(h.size * sizeof(double), 0);
+      if (h.size > 0)
+         file.write(&zeros[0], zeros.size());
+      h.sequence = 1;
+      }
+   // write record copy
+   h.checksum = checksum(h, state);
+   file.seekp(pos);
+   file.write(reinterpret_cast<const char *> (&h), sizeof(h));
+   if (h.size > 0)
+      file.write(reinterpret_cast<const char *> (&state(0)), h.size
+            * sizeof(double));
+   file.flush();
+   assertalways(file.good());
+   }
+
+/*!
+ * \brief Discard the saved state for a given key
+ * \param[in] digest Digest of simulated system
+ * \param[in] parameter Simulation parameter
+ *
+ * Both copies in the slot are marked as unused, so that a later read finds
+ * no state for this key; the slot itself is kept, and is reused by the next
+ * write with the same key and state size. Does nothing if the file does not
+ * exist, is not in the current format, or has no slot for this key.
+ */
+void checkpointfile::erase(const sha& digest, const double parameter) const
+   {
+   std::fstream file(fname.c_str(), std::ios::in | std::ios::out
+         | std::ios::binary);
+   if (!file)
+      return;
+   // check file header
+   fileheader fh, ref;
+   makeheader(ref);
+   file.read(reinterpret_cast<char *> (&fh), sizeof(fh));
+   if (!file || memcmp(&fh, &ref, sizeof(fh)) != 0)
+      return;
+   // find slot for key
+   recordheader key, h;
+   makekey(key, digest, parameter);
+   const std::streamoff pos = findslot(file, key, h);
+   if (pos < 0)
+      return;
+   trace << "DEBUG (checkpointfile): discarding state." << std::endl;
+   // overwrite both copy headers with an unused record
+   const std::streamoff copysize = sizeof(recordheader) + h.size
+         * sizeof(double);
+   recordheader empty = key;
+   empty.size = h.size;
+   file.seekp(pos);
+   file.write(reinterpret_cast<const char *> (&empty), sizeof(empty));
+   file.seekp(pos + copysize);
+   file.write(reinterpret_cast<const char *> (&empty), sizeof(empty));
+   file.flush();
+   assertalways(file.good());
+   }
+
+} // end namespace
@@ -0,0 +1,139 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __checkpointfile_h
+#define __checkpointfile_h
+
+#include "config.h"
+#include "vector.h"
+#include "sha.h"
+
+#include <iostream>
+#include <string>
+
+namespace libcomm {
+
+/*!
+ * \brief   Binary Checkpoint File.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * This class holds saved simulation states in a binary file, keyed by the
+ * system digest and the parameter value. Each key has a single slot in the
+ * file, which is overwritten by later saves; looking for a state therefore
+ * only needs to step over the slot headers, and its cost does not depend on
+ * the number of times states were saved.
+ *
+ * \note No index of slots is kept, in memory or in the file: each read or
+ * write steps over the slot headers from the start of the file, so its cost
+ * grows with the number of distinct keys (one header read per key). This is
+ * small for the number of points in a typical results file, and avoids any
+ * index going stale when the file is shared between runs.
+ *
+ * The file consists of a file header (magic string, format version, and a
+ * byte-order marker) followed by a sequence of slots. Each slot holds two
+ * copies of a record, made up of a fixed-size header (checksum, sequence
+ * number, sample count, state size, parameter, system digest, and a record
+ * marker) and the state values. Saves alternate between the two copies, so
+ * that an interrupted write always leaves the previous copy intact; on
+ * reading, the copy with the highest sequence number that passes the
+ * checksum is used.
+ *
+ * \note All fields are held in native byte order, and are naturally aligned
+ * (the header sizes are multiples of eight bytes), so that the file may also
+ * be memory-mapped directly. Files written on a machine with a different
+ * byte order are rejected.
+ */
+
+class checkpointfile {
+private:
+   /*! \name Internal types */
+   //! File header
+   struct fileheader {
+      char magic[8]; //!< File identifier
+      libbase::int32u version; //!< Format version
+      libbase::int32u order; //!< Byte-order marker
+      libbase::int64u reserved; //!< Reserved (zero)
+   };
+   //! Record header
+   struct recordheader {
+      libbase::int64u checksum; //!< Checksum of remaining fields and values
+      libbase::int64u sequence; //!< Write sequence number (zero if unused)
+      libbase::int64u samplecount; //!< Number of samples accumulated
+      libbase::int64u size; //!< Number of state values
+      double parameter; //!< Simulation parameter
+      unsigned char digest[20]; //!< Digest of simulated system
+      libbase::int32u magic; //!< Record marker
+   };
+   // @}
+   /*! \name Object-wide constants */
+   static const libbase::int32u version; //!< Current format version
+   static const libbase::int32u order; //!< Byte-order marker
+   static const libbase::int32u record; //!< Record marker
+   // @}
+private:
+   /*! \name User-specified parameters */
+   std::string fname; //!< Filename for associated checkpoint file
+   // @}
+private:
+   /*! \name Internal functions */
+   static libbase::int64u checksum(const recordheader& h,
+         const libbase::vector<double>& state);
+   static void makeheader(fileheader& h);
+   static void makekey(recordheader& h, const sha& digest,
+         const double parameter);
+   static bool samekey(const recordheader& a, const recordheader& b);
+   static bool readcopy(std::istream& file, std::streamoff pos,
+         libbase::int64u size, recordheader& h,
+         libbase::vector<double>& state);
+   std::streamoff findslot(std::istream& file, const recordheader& key,
+         recordheader& h) const;
+   // @}
+public:
+   /*! \name Constructor/destructor */
+   //! Principal constructor
+   explicit checkpointfile(const std::string& fname) :
+      fname(fname)
+      {
+      }
+   // @}
+
+   /*! \name Checkpoint interface */
+   bool exists() const;
+   bool read(const sha& digest, const double parameter,
+         libbase::int64u& samplecount, libbase::vector<double>& state) const;
+   void write(const sha& digest, const double parameter,
+         const libbase::int64u samplecount,
+         const libbase::vector<double>& state) const;
+   void erase(const sha& digest, const double parameter) const;
+   // @}
+};
+
+} // end namespace
+
+#endif
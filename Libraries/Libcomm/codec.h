@@ -113,6 +113,47 @@ public:
    virtual void decode(C<int>& decoded) = 0;
    // @}
 
+   /*! \name Batch codec operations */
+   /*!
+    * \brief Whether frames can be decoded in batches
+    *
+    * Frames in a batch are only decoded after all of them are encoded; this
+    * is not possible if the codec changes from one frame to the next (eg.
+    * with an interleaver that is renewed for every frame).
+    */
+   virtual bool can_batch() const
+      {
+      return true;
+      }
+   /*!
+    * \brief Batch decoding process
+    * \param[in] ptable Likelihoods of each possible modulation symbol at every
+    * (modulation) timestep, for each of a set of frames
+    * \param[out] decoded Most likely sequence of information symbols, for
+    * each iteration and frame: decoded(i)(f) is the decision for frame 'f'
+    * after iteration 'i'
+    *
+    * This performs the complete decoding cycle (ie. num_iter() iterations)
+    * for a set of independent frames. The default implementation decodes
+    * each frame in turn; derived classes may override this to share work
+    * across frames.
+    */
+   virtual void batchdecode(const libbase::vector<C<array1d_t> >& ptable,
+         libbase::vector<libbase::vector<C<int> > >& decoded)
+      {
+      const int frames = ptable.size();
+      decoded.init(num_iter());
+      for (int i = 0; i < num_iter(); i++)
+         decoded(i).init(frames);
+      for (int f = 0; f < frames; f++)
+         {
+         init_decoder(ptable(f));
+         for (int i = 0; i < num_iter(); i++)
+            decode(decoded(i)(f));
+         }
+      }
+   // @}
+
    /*! \name Codec information functions - fundamental */
    //! Input block size in symbols
    virtual libbase::size_type<C> input_block_size() const = 0;
@@ -72,6 +72,10 @@ public:
       {
       base.seedfrom(r);
       }
+   bool can_batch() const
+      {
+      return base.can_batch();
+      }
    void encode(const libbase::matrix<int>& source,
          libbase::matrix<int>& encoded)
       {
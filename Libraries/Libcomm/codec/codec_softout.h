@@ -100,6 +100,38 @@ public:
     */
    virtual void softdecode(C<array1d_t>& ri, C<array1d_t>& ro) = 0;
    // @}
+
+   /*! \name Batch codec operations */
+   /*!
+    * \brief Batch decoding process
+    * \param[in] ptable Likelihoods of each possible modulation symbol at every
+    * (modulation) timestep, for each of a set of frames
+    * \param[out] ri Likelihood table for input symbols at every timestep, for
+    * each iteration and frame: ri(i)(f) is the table for frame 'f' after
+    * iteration 'i'
+    *
+    * This performs the complete decoding cycle (ie. num_iter() iterations)
+    * for a set of independent frames. The default implementation decodes
+    * each frame in turn; derived classes may override this to share work
+    * across frames.
+    */
+   virtual void batchsoftdecode(const libbase::vector<C<array1d_t> >& ptable,
+         libbase::vector<libbase::vector<C<array1d_t> > >& ri)
+      {
+      // init_decoder(ptable) is hidden by the overload in this class
+      codec<C, dbl>& base = *this;
+      const int frames = ptable.size();
+      ri.init(this->num_iter());
+      for (int i = 0; i < this->num_iter(); i++)
+         ri(i).init(frames);
+      for (int f = 0; f < frames; f++)
+         {
+         base.init_decoder(ptable(f));
+         for (int i = 0; i < this->num_iter(); i++)
+            softdecode(ri(i)(f));
+         }
+      }
+   // @}
 };
 
 /*!
@@ -31,6 +31,7 @@
 
 #include "ldpc.h"
 #include "linear_code_utils.h"
+#include "hard_decision.h"
 #include "randgen.h"
 #include "sumprodalg/spa_factory.h"
 #include <cmath>
@@ -385,6 +386,60 @@ template <class GF_q, class real> void ldpc<GF_q, real>::softdecode(
 
    }
 
+/*!
+ * \copydoc codec::batchdecode()
+ *
+ * Decisions are taken directly on the information symbols, without
+ * converting the whole soft-output table; once a frame is decoded to a
+ * codeword, its decision is repeated for any remaining iterations.
+ *
+ * Frames are decoded in turn rather than interleaved, as the message-passing
+ * state is held by the sum-product algorithm object for a single frame.
+ */
+template <class GF_q, class real> void ldpc<GF_q, real>::batchdecode(
+      const libbase::vector<array1vdbl_t>& ptable,
+      libbase::vector<libbase::vector<array1i_t> >& decoded)
+   {
+   const int frames = ptable.size();
+   decoded.init(this->max_iter);
+   for (int loop_i = 0; loop_i < this->max_iter; loop_i++)
+      decoded(loop_i).init(frames);
+   const int num_of_elements = GF_q::elements();
+   array1vd_t tmp_ro;
+   array1dbl_t symbol_probs(num_of_elements);
+   basic_hard_decision<double> functor;
+   for (int loop_f = 0; loop_f < frames; loop_f++)
+      {
+      this->init_decoder(ptable(loop_f));
+      for (int loop_i = 0; loop_i < this->max_iter; loop_i++)
+         {
+         array1i_t& result = decoded(loop_i)(loop_f);
+         //repeat the solution computed in a previous iteration
+         if (this->decodingSuccess)
+            {
+            result = decoded(loop_i - 1)(loop_f);
+            continue;
+            }
+         this->current_iteration++;
+         this->spa_alg->spa_iteration(tmp_ro);
+         //determine the most likely symbol
+         libbase::linear_code_utils<GF_q, real>::get_most_likely_received_word(
+               tmp_ro, this->received_word_sd, this->received_word_hd);
+         //decide on the info symbols, cast back from real to double
+         result.init(this->dim_k);
+         for (int loop_k = 0; loop_k < this->dim_k; loop_k++)
+            {
+            const array1d_t& probs = tmp_ro(this->info_symb_pos(loop_k));
+            for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+               symbol_probs(loop_e) = static_cast<double> (probs(loop_e));
+            result(loop_k) = functor(symbol_probs);
+            }
+         //do we have a solution?
+         this->isCodeword();
+         }
+      }
+   }
+
 template <class GF_q, class real> std::string ldpc<GF_q, real>::description() const
    {
    std::ostringstream sout;
@@ -392,7 +447,12 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
          << this->dim_k << ", spa=" << this->spa_alg->spa_type() << ", iter="
          << this->max_iter << ", clipping="
          << this->spa_alg->get_clipping_type() << ", almostzero="
-         << this->spa_alg->get_almostzero() << ") ";
+         << this->spa_alg->get_almostzero();
+   if (this->spa_alg->get_schedule_type() != "flooding")
+      {
+      sout << ", schedule=" << this->spa_alg->get_schedule_type();
+      }
+   sout << ") ";
 #if DEBUG>=2
    this->serialize(libbase::trace);
    libbase::trace << std::endl;
@@ -424,6 +484,8 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
  * clipping
  * spa_type
  * max_iter
+ * reduce_to_ref
+ * schedule
  * n m
  * max_n max_m
  * rand_prov_vals
@@ -438,6 +500,7 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
  * - version is the file format version used
  * - spa_type is the impl of the SPA used
  * - max_iter is the maximum number of iterations used by the decoder
+ * - schedule is the order of node updates in the SPA (flooding|layered)
  * - n is the length of the code
  * - m is the dimension of the parity check matrix
  * - max_n is the maxiumum number of non-zero entries per column
@@ -463,7 +526,7 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
  * An example file would be
  * ldpc<gf<2,0x7>>
  * #version
- * 4
+ * 5
  * #SPA
  * trad
  * #iter
@@ -473,6 +536,8 @@ template <class GF_q, class real> std::string ldpc<GF_q, real>::description() co
  * 1e-100
  * # reduce generator matrix to REF? (true|false)
  * false
+ * # SPA schedule (flooding|layered)
+ * flooding
  * # length dim
  * 5 3
  * # max col/row weight
@@ -515,7 +580,7 @@ template <class GF_q, class real> std::ostream& ldpc<GF_q, real>::serialize(
 
    assertalways(sout.good());
    sout << "#version of this file format" << std::endl;
-   sout << 4 << std::endl;
+   sout << 5 << std::endl;
    sout << "#SPA type" << std::endl;
    sout << this->spa_alg->spa_type() << std::endl;
    sout << "# number of iterations" << std::endl;
@@ -536,6 +601,8 @@ template <class GF_q, class real> std::ostream& ldpc<GF_q, real>::serialize(
       {
       sout << "false" << std::endl;
       }
+   sout << "#SPA schedule (flooding|layered)" << std::endl;
+   sout << this->spa_alg->get_schedule_type() << std::endl;
    sout << "# length n and dimension m" << std::endl;
    sout << this->length_n << " " << this->dim_pchk << std::endl;
    sout << "#max col weight and max row weight" << std::endl;
@@ -597,6 +664,9 @@ template <class GF_q, class real> std::ostream& ldpc<GF_q, real>::serialize(
  * version
  * spa_type
  * max_iter
+ * clipping
+ * reduce_to_ref
+ * schedule
  * n m
  * max_n max_m
  * rand_prov_vals
@@ -611,6 +681,8 @@ template <class GF_q, class real> std::ostream& ldpc<GF_q, real>::serialize(
  * - version is the file format version used
  * - spa_type is the impl of the SPA used
  * - max_iter is the maximum number of iterations used by the decoder
+ * - schedule (from version 5) is the order of node updates in the SPA
+ *   (flooding|layered); earlier versions use flooding
  * - n is the length of the code
  * - m is the dimension of the parity check matrix
  * - max_n is the maxiumum number of non-zero entries per column
@@ -722,6 +794,13 @@ template <class GF_q, class real> std::istream& ldpc<GF_q, real>::serialize(
          this->reduce_to_ref = true;
          }
       }
+   //default schedule for files with versions less than 5
+   std::string schedule_type = "flooding";
+   if (version > 4)
+      {
+      sin >> libbase::eatcomments >> schedule_type;
+      assertalways(("flooding"==schedule_type)||("layered"==schedule_type));
+      }
    sin >> libbase::eatcomments >> this->length_n;
    sin >> libbase::eatcomments >> this->dim_pchk;
 
@@ -827,6 +906,7 @@ template <class GF_q, class real> std::istream& ldpc<GF_q, real>::serialize(
          this->length_n, this->dim_pchk, this->M_n, this->N_m,
          this->pchk_matrix);
    this->spa_alg->set_clipping(clipping_type, almost_zero);
+   this->spa_alg->set_schedule(schedule_type);
    this->init();
    return sin;
    }
@@ -1127,9 +1207,12 @@ template <class GF_q, class real> std::istream& ldpc<GF_q, real>::read_alist(
 
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 
 namespace libcomm {
 using libbase::mpreal;
+using libbase::logfixed16;
+using libbase::logfixed8;
 using libbase::serializer;
 using libbase::gf;
 
@@ -1138,6 +1221,16 @@ template <>
 const serializer ldpc<gf<1, 0x3> , double>::shelper = serializer("codec",
       "ldpc<gf<1,0x3>>", ldpc<gf<1, 0x3> , double>::create);
 
+template class ldpc<gf<1, 0x3> , logfixed16> ;
+template <>
+const serializer ldpc<gf<1, 0x3> , logfixed16>::shelper = serializer("codec",
+      "ldpc<gf<1,0x3>(logfixed16)>", ldpc<gf<1, 0x3> , logfixed16>::create);
+
+template class ldpc<gf<1, 0x3> , logfixed8> ;
+template <>
+const serializer ldpc<gf<1, 0x3> , logfixed8>::shelper = serializer("codec",
+      "ldpc<gf<1,0x3>(logfixed8)>", ldpc<gf<1, 0x3> , logfixed8>::create);
+
 template class ldpc<gf<2, 0x7> > ;
 template <>
 const serializer ldpc<gf<2, 0x7> >::shelper = serializer("codec",
@@ -1163,6 +1256,16 @@ template <>
 const serializer ldpc<gf<4, 0x13> , mpreal>::shelper = serializer("codec",
       "ldpc<gf<4,0x13>(mpreal)>", ldpc<gf<4, 0x13> , mpreal>::create);
 
+template class ldpc<gf<4, 0x13> , logfixed16> ;
+template <>
+const serializer ldpc<gf<4, 0x13> , logfixed16>::shelper = serializer("codec",
+      "ldpc<gf<4,0x13>(logfixed16)>", ldpc<gf<4, 0x13> , logfixed16>::create);
+
+template class ldpc<gf<4, 0x13> , logfixed8> ;
+template <>
+const serializer ldpc<gf<4, 0x13> , logfixed8>::shelper = serializer("codec",
+      "ldpc<gf<4,0x13>(logfixed8)>", ldpc<gf<4, 0x13> , logfixed8>::create);
+
 template class ldpc<gf<5, 0x25> > ;
 template <>
 const serializer ldpc<gf<5, 0x25> >::shelper = serializer("codec",
@@ -141,6 +141,11 @@ public:
     */
    void softdecode(array1vdbl_t& ri, array1vdbl_t& ro);
 
+   /*! \name Batch codec operations */
+   void batchdecode(const libbase::vector<array1vdbl_t>& ptable,
+         libbase::vector<libbase::vector<array1i_t> >& decoded);
+   // @}
+
    /*
     * some more necessary functions for the codec interface
     */
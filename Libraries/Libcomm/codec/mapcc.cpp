@@ -25,7 +25,9 @@
 #include "mapcc.h"
 #include "mapper/map_straight.h"
 #include "vectorutils.h"
+#include "hard_decision.h"
 #include <sstream>
+#include <cctype>
 
 namespace libcomm {
 
@@ -35,7 +37,7 @@ template <class real, class dbl>
 void mapcc<real, dbl>::init()
    {
    assertalways(encoder);
-   BCJR::init(*encoder, tau);
+   BCJR::init(*encoder, tau, window, warmup);
    assertalways(!circular || !endatzero);
    }
 
@@ -70,14 +72,16 @@ void mapcc<real, dbl>::reset()
 
 template <class real, class dbl>
 mapcc<real, dbl>::mapcc() :
-   encoder(NULL)
+   encoder(NULL), window(0), warmup(0)
    {
    }
 
 template <class real, class dbl>
 mapcc<real, dbl>::mapcc(const fsm& encoder, const int tau,
-      const bool endatzero, const bool circular) :
-   tau(tau), endatzero(endatzero), circular(circular)
+      const bool endatzero, const bool circular, const int window,
+      const int warmup) :
+   tau(tau), endatzero(endatzero), circular(circular), window(window),
+         warmup(warmup)
    {
    This::encoder = dynamic_cast<fsm*> (encoder.clone());
    init();
@@ -219,6 +223,39 @@ void mapcc<real, dbl>::softdecode(array1vd_t& ri, array1vd_t& ro)
          ro(i)(j) = rof(i, j);
    }
 
+// batch codec operations
+
+/*!
+ * \copydoc codec::batchdecode()
+ *
+ * Equiprobable priors are set up once and shared by all frames; all frames
+ * are then decoded together, with the BCJR recursions worked out at once
+ * (see bcjr::fdecode()). Decisions are taken directly on the decoder
+ * results.
+ */
+template <class real, class dbl>
+void mapcc<real, dbl>::batchdecode(const libbase::vector<array1vd_t>& ptable,
+      libbase::vector<libbase::vector<array1i_t> >& decoded)
+   {
+   const int frames = ptable.size();
+   decoded.init(1);
+   decoded(0).init(frames);
+   // set up priors and receiver statistics for all frames
+   resetpriors();
+   libbase::vector<array2d_t> fR(frames), fapp(frames), fri;
+   for (int f = 0; f < frames; f++)
+      {
+      setreceiver(ptable(f));
+      fR(f) = R;
+      fapp(f) = app;
+      }
+   // decode all frames
+   BCJR::fdecode(fR, fapp, fri);
+   hard_decision<libbase::vector, dbl> functor;
+   for (int f = 0; f < frames; f++)
+      functor(fri(f), This::input_block_size(), decoded(0)(f));
+   }
+
 // description output
 
 template <class real, class dbl>
@@ -230,6 +267,8 @@ std::string mapcc<real, dbl>::description() const
    sout << "MAP-decoded Convolutional Code (" << This::output_bits() << ","
          << This::input_bits() << ") - ";
    sout << encoder->description();
+   if (window > 0)
+      sout << ", Sliding Window (" << window << "+" << warmup << ")";
    return sout.str();
    }
 
@@ -238,23 +277,55 @@ std::string mapcc<real, dbl>::description() const
 template <class real, class dbl>
 std::ostream& mapcc<real, dbl>::serialize(std::ostream& sout) const
    {
+   // format version
+   sout << "# Version" << std::endl;
+   sout << 2 << std::endl;
+   sout << "# Encoder" << std::endl;
    sout << encoder;
+   sout << "# Block length (including tail)" << std::endl;
    sout << tau << std::endl;
+   sout << "# Terminated?" << std::endl;
    sout << int(endatzero) << std::endl;
+   sout << "# Circular?" << std::endl;
    sout << int(circular) << std::endl;
+   sout << "# Sliding window length (0=whole block)" << std::endl;
+   sout << window << std::endl;
+   sout << "# Sliding window warm-up length" << std::endl;
+   sout << warmup << std::endl;
    return sout;
    }
 
 // object serialization - loading
 
+/*!
+ * \version 1 Initial version (un-numbered)
+ *
+ * \version 2 Added version numbering; added sliding window and warm-up
+ * lengths
+ */
 template <class real, class dbl>
 std::istream& mapcc<real, dbl>::serialize(std::istream& sin)
    {
    free();
+   // get format version; old-format files start with the encoder name
+   int version = 1;
+   sin >> libbase::eatcomments;
+   if (isdigit(sin.peek()))
+      sin >> version;
    sin >> libbase::eatcomments >> encoder;
    sin >> libbase::eatcomments >> tau;
    sin >> libbase::eatcomments >> endatzero;
    sin >> libbase::eatcomments >> circular;
+   if (version < 2)
+      {
+      window = 0;
+      warmup = 0;
+      }
+   else
+      {
+      sin >> libbase::eatcomments >> window;
+      sin >> libbase::eatcomments >> warmup;
+      }
    init();
    return sin;
    }
@@ -267,6 +338,7 @@ std::istream& mapcc<real, dbl>::serialize(std::istream& sin)
 #include "mpgnu.h"
 #include "logreal.h"
 #include "logrealfast.h"
+#include "logfixed.h"
 #include "mapper/map_straight.h"
 
 namespace libcomm {
@@ -275,6 +347,8 @@ using libbase::mpreal;
 using libbase::mpgnu;
 using libbase::logreal;
 using libbase::logrealfast;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 using libbase::serializer;
 
@@ -314,4 +388,14 @@ const serializer mapcc<logrealfast, logrealfast>::shelper =
       serializer("codec", "mapcc<logrealfast,logrealfast>", mapcc<logrealfast,
             logrealfast>::create);
 
+template class mapcc<logfixed16> ;
+template <>
+const serializer mapcc<logfixed16>::shelper = serializer("codec",
+      "mapcc<logfixed16>", mapcc<logfixed16>::create);
+
+template class mapcc<logfixed8> ;
+template <>
+const serializer mapcc<logfixed8>::shelper = serializer("codec",
+      "mapcc<logfixed8>", mapcc<logfixed8>::create);
+
 } // end namespace
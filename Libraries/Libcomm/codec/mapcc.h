@@ -46,6 +46,9 @@ namespace libcomm {
  * - $Date: 2010-12-09 09:56:06 +0000 (Thu, 09 Dec 2010) $
  * - $Author: jabriffa $
  *
+ * \note Serialization is versioned; for compatibility, earlier (un-numbered)
+ * streams are interpreted as v.1, decoding whole blocks at once.
+ *
  * \todo Update decoding process for changes in FSM model.
  */
 
@@ -71,6 +74,8 @@ private:
    int tau; //!< Sequence length in timesteps (including tail, if any)
    bool endatzero; //!< True for terminated trellis
    bool circular; //!< True for circular trellis
+   int window; //!< Sliding window length (0 for whole block)
+   int warmup; //!< Sliding window warm-up length
    // @}
    /*! \name Internal object representation */
    double rate;
@@ -94,7 +99,8 @@ protected:
 public:
    /*! \name Constructors / Destructors */
    mapcc(const fsm& encoder, const int tau, const bool endatzero,
-         const bool circular = false);
+         const bool circular = false, const int window = 0,
+         const int warmup = 0);
    ~mapcc()
       {
       free();
@@ -106,6 +112,10 @@ public:
    void softdecode(array1vd_t& ri);
    void softdecode(array1vd_t& ri, array1vd_t& ro);
 
+   // Batch codec operations
+   void batchdecode(const libbase::vector<array1vd_t>& ptable,
+         libbase::vector<libbase::vector<array1i_t> >& decoded);
+
    // Codec information functions - fundamental
    libbase::size_type<libbase::vector> input_block_size() const
       {
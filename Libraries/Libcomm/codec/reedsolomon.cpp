@@ -232,20 +232,29 @@ template <class GF_q> void reedsolomon<GF_q>::decode(array1i_t& decoded)
          error_loc_poly.serialize(std::cout, ',');
 #endif
 
-         //Use brute force and horner's scheme to determine the roots.
+         //Use a Chien search to determine the roots.
          //we can stop as soon as we have found t=deg(\lambda(x)) roots
          array1i_t error_pos;
          error_pos.init(t);
          GF_q alpha = GF_q(2);//represents \alpha
          int counter = 0;
-         GF_q pow_aplha = GF_q(1); // represent \alpha^counter;
+         //terms(j) represents \lambda_j \alpha^{j counter}, and is advanced
+         //at each step by multiplying with steps(j)=\alpha^j
+         libbase::vector<GF_q> terms = error_loc_poly;
+         libbase::vector<GF_q> steps;
+         steps.init(t + 1);
+         steps(0) = GF_q(1);
+         for (int j = 1; j <= t; j++)
+            {
+            steps(j) = steps(j - 1) * alpha;
+            }
          int rootsfound = 0;
          while ((rootsfound < t) && (counter < this->length_n))
             {
-            tmp_val = error_loc_poly(t);
-            for (int j = t; j > 0; j--)
+            tmp_val = GF_q(0);
+            for (int j = 0; j <= t; j++)
                {
-               tmp_val = tmp_val * pow_aplha + error_loc_poly(j - 1);
+               tmp_val += terms(j);
                }
             if (tmp_val == GF_q(0))
                {
@@ -263,8 +272,8 @@ template <class GF_q> void reedsolomon<GF_q>::decode(array1i_t& decoded)
                }
             //increment the counter
             counter++;
-            //up the power
-            pow_aplha = pow_aplha * alpha;
+            //up the powers
+            GF_q::multiply(&terms(0), &steps(0), t + 1);
             }
 
 #if DEBUG>=2
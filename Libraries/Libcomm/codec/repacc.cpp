@@ -51,7 +51,7 @@ void repacc<real, dbl>::init()
    assertalways(This::input_block_size() > 0);
    assertalways(rep.num_inputs() == This::num_inputs());
    // initialize BCJR subsystem for accumulator
-   BCJR::init(*acc, This::acc_timesteps());
+   BCJR::init(*acc, This::acc_timesteps(), window, warmup);
    // check interleaver size
    assertalways(inter->size() == This::acc_timesteps());
    assertalways(iter > 0);
@@ -341,6 +341,8 @@ std::string repacc<real, dbl>::description() const
    sout << (endatzero ? "Terminated" : "Unterminated");
    if (limitlo > dbl(0))
       sout << ", Clipping at " << limitlo;
+   if (window > 0)
+      sout << ", Sliding Window (" << window << "+" << warmup << ")";
    return sout.str();
    }
 
@@ -350,13 +352,15 @@ template <class real, class dbl>
 std::ostream& repacc<real, dbl>::serialize(std::ostream& sout) const
    {
    // format version
-   sout << 3 << std::endl;
+   sout << 4 << std::endl;
    rep.serialize(sout);
    sout << acc;
    sout << inter;
    sout << iter << std::endl;
    sout << int(endatzero) << std::endl;
    sout << limitlo << std::endl;
+   sout << window << std::endl;
+   sout << warmup << std::endl;
    return sout;
    }
 
@@ -364,6 +368,8 @@ std::ostream& repacc<real, dbl>::serialize(std::ostream& sout) const
 
 /*!
  * \version 3 added clipping threshold (limitlo)
+ *
+ * \version 4 added sliding window and warm-up lengths for accumulator
  */
 template <class real, class dbl>
 std::istream& repacc<real, dbl>::serialize(std::istream& sin)
@@ -385,6 +391,17 @@ std::istream& repacc<real, dbl>::serialize(std::istream& sin)
       sin >> libbase::eatcomments >> limitlo;
    else
       limitlo = 0;
+   // get version 4 items
+   if (version >= 4)
+      {
+      sin >> libbase::eatcomments >> window;
+      sin >> libbase::eatcomments >> warmup;
+      }
+   else
+      {
+      window = 0;
+      warmup = 0;
+      }
    init();
    assertalways(sin.good());
    return sin;
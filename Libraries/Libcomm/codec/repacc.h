@@ -78,6 +78,8 @@ private:
    int iter; //!< Number of iterations to perform
    bool endatzero; //!< Flag to indicate that trellises are terminated
    dbl limitlo; //!< Lower clipping threshold
+   int window; //!< Sliding window length for accumulator (0 for whole block)
+   int warmup; //!< Sliding window warm-up length
    // @}
 protected:
    /*! \name Internal object representation */
@@ -122,6 +124,13 @@ public:
    void softdecode(array1vd_t& ri);
    void softdecode(array1vd_t& ri, array1vd_t& ro);
 
+   // Batch codec operations
+   //! Frames can only be batched if the interleaver stays the same
+   bool can_batch() const
+      {
+      return inter->is_fixed();
+      }
+
    // Codec information functions - fundamental
    libbase::size_type<libbase::vector> input_block_size() const
       {
@@ -25,6 +25,7 @@
 #include "turbo.h"
 #include "interleaver/lut/flat.h"
 #include "vectorutils.h"
+#include "hard_decision.h"
 #include <sstream>
 #include <iomanip>
 
@@ -49,7 +50,16 @@ void turbo<real, dbl>::init()
    assertalways(encoder);
    const int tau = num_timesteps();
    assertalways(tau > 0);
-   BCJR::init(*encoder, tau);
+   assertalways(realization >= 0 && realization <= 2);
+   // sliding window is only available with the exact decoder
+   assertalways(window >= 0 && warmup >= 0);
+   assertalways(realization == 0 || window == 0);
+   if (realization == 0)
+      BCJR::init(*encoder, tau, window, warmup);
+   else
+      fast.init(*encoder, tau, typename logmap_bcjr<dbl>::algorithm_t(
+            realization - 1), fixedpoint ? logmap_bcjr<dbl>::metric_int16
+            : logmap_bcjr<dbl>::metric_float);
 
    assertalways(!endatzero || !circular);
    assertalways(iter > 0);
@@ -76,6 +86,14 @@ void turbo<real, dbl>::reset()
       ss = dbl(1.0 / double(enc_states()));
       se = dbl(1.0 / double(enc_states()));
       }
+   else if (realization != 0)
+      {
+      fast.setstart(0);
+      if (endatzero)
+         fast.setend(0);
+      else
+         fast.setend();
+      }
    else if (endatzero)
       {
       BCJR::setstart(0);
@@ -107,6 +125,10 @@ turbo<real, dbl>::turbo(const fsm& encoder, const libbase::vector<interleaver<
    This::parallel = parallel;
    This::circular = circular;
    This::iter = iter;
+   This::realization = 0;
+   This::fixedpoint = false;
+   This::window = 0;
+   This::warmup = 0;
    init();
    }
 
@@ -127,6 +149,8 @@ void turbo<real, dbl>::allocate()
    else
       libbase::allocate(ra, 1, tau, K);
    libbase::allocate(R, sets, tau, N);
+   if (realization != 0)
+      lR.init(sets);
    // flag the state of the arrays
    initialised = true;
 
@@ -196,19 +220,36 @@ void turbo<real, dbl>::bcjr_wrap(const int set, const array2d_t& ra,
    {
    // Temporary variables to hold interleaved versions of ra/ri
    array2d_t rai, rii;
-   if (circular)
+   inter(set)->transform(ra, rai);
+   if (realization != 0)
       {
-      BCJR::setstart(ss(set));
-      BCJR::setend(se(set));
+      if (circular)
+         {
+         fast.setstart(ss(set));
+         fast.setend(se(set));
+         }
+      fast.fdecode(lR(set), rai, rii);
+      if (circular)
+         {
+         ss(set) = fast.getstart();
+         se(set) = fast.getend();
+         }
       }
-   inter(set)->transform(ra, rai);
-   BCJR::fdecode(R(set), rai, rii);
-   inter(set)->inverse(rii, ri);
-   if (circular)
+   else
       {
-      ss(set) = BCJR::getstart();
-      se(set) = BCJR::getend();
+      if (circular)
+         {
+         BCJR::setstart(ss(set));
+         BCJR::setend(se(set));
+         }
+      BCJR::fdecode(R(set), rai, rii);
+      if (circular)
+         {
+         ss(set) = BCJR::getstart();
+         se(set) = BCJR::getend();
+         }
       }
+   inter(set)->inverse(rii, ri);
    work_extrinsic(ra, ri, rp, re);
    }
 
@@ -249,23 +290,121 @@ void turbo<real, dbl>::decode_parallel(array2d_t& ri)
    // and ra(set) is updated with the extrinsic information for that set
    for (int set = 0; set < num_sets(); set++)
       bcjr_wrap(set, ra(set), ri, ra(set));
+   work_parallel(ra, rp, ri);
+   }
+
+/*! \brief Combine the extrinsic information of all sets (parallel decoding)
+ * \param[in,out] ra Extrinsic probabilities from each set, replaced with the
+ * a-priori probabilities for the next stage
+ * \param[in]  rp  A-priori intrinsic probabilities of input values
+ * \param[out] ri  A-posteriori probabilities of input values
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::work_parallel(libbase::vector<array2d_t>& ra,
+      const array2d_t& rp, array2d_t& ri)
+   {
+   const int sets = ra.size();
    // the following are repeated at each frame element, for each possible symbol
    // work in ri the sum of all extrinsic information
    ri = ra(0);
-   for (int set = 1; set < num_sets(); set++)
+   for (int set = 1; set < sets; set++)
       ri.multiplyby(ra(set));
    // compute the next-stage a priori information by subtracting the extrinsic
    // information of the current stage from the sum of all extrinsic information.
-   for (int set = 0; set < num_sets(); set++)
+   for (int set = 0; set < sets; set++)
       ra(set) = ri.divide(ra(set));
    // add the channel information to the sum of extrinsic information
    ri.multiplyby(rp);
    // normalize results
-   for (int set = 0; set < num_sets(); set++)
+   for (int set = 0; set < sets; set++)
       BCJR::normalize(ra(set));
    BCJR::normalize(ri);
    }
 
+// batch decoding functions
+
+/*! \brief Whether the component decoder can work on a set of frames together
+ *
+ * This is the case for the exact decoder, except with circular trellises,
+ * where each frame has its own start- and end-state probabilities.
+ */
+template <class real, class dbl>
+bool turbo<real, dbl>::can_interleave_frames() const
+   {
+   return realization == 0 && !circular;
+   }
+
+/*!
+ * \brief Complete BCJR decoding cycle, for a set of frames
+ * \param[in]  set Parity sequence being decoded
+ * \param[in]  R   A priori intrinsic encoder-output statistics for this set,
+ * for each frame
+ * \param[in]  rp  A-priori intrinsic probabilities of input values, for each
+ * frame
+ * \param[in,out] ra A-priori (extrinsic) probabilities of input values, for
+ * each frame; ra(f)(k) is used, and replaced with the extrinsic probabilities
+ * \param[in]  k   Index of the extrinsic probabilities to use
+ * \param[out] ri  A-posteriori probabilities of input values, for each frame
+ *
+ * \sa bcjr_wrap(const int, const array2d_t&, array2d_t&, array2d_t&)
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::bcjr_wrap(const int set,
+      const libbase::vector<array2d_t>& R,
+      const libbase::vector<array2d_t>& rp, libbase::vector<libbase::vector<
+            array2d_t> >& ra, const int k, libbase::vector<array2d_t>& ri)
+   {
+   const int frames = rp.size();
+   // Temporary variables to hold interleaved versions of ra/ri
+   libbase::vector<array2d_t> rai(frames), rii;
+   for (int f = 0; f < frames; f++)
+      inter(set)->transform(ra(f)(k), rai(f));
+   BCJR::fdecode(R, rai, rii);
+   for (int f = 0; f < frames; f++)
+      {
+      inter(set)->inverse(rii(f), ri(f));
+      work_extrinsic(ra(f)(k), ri(f), rp(f), ra(f)(k));
+      }
+   }
+
+/*! \brief Perform a complete serial-decoding cycle, for a set of frames
+ *
+ * \sa decode_serial(array2d_t&)
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::decode_serial(const libbase::vector<libbase::vector<
+      array2d_t> >& R, const libbase::vector<array2d_t>& rp,
+      libbase::vector<libbase::vector<array2d_t> >& ra, libbase::vector<
+            array2d_t>& ri)
+   {
+   const int frames = rp.size();
+   for (int set = 0; set < num_sets(); set++)
+      {
+      bcjr_wrap(set, R(set), rp, ra, 0, ri);
+      for (int f = 0; f < frames; f++)
+         BCJR::normalize(ra(f)(0));
+      }
+   for (int f = 0; f < frames; f++)
+      BCJR::normalize(ri(f));
+   }
+
+/*! \brief Perform a complete parallel-decoding cycle, for a set of frames
+ *
+ * \sa decode_parallel(array2d_t&)
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::decode_parallel(const libbase::vector<libbase::vector<
+      array2d_t> >& R, const libbase::vector<array2d_t>& rp,
+      libbase::vector<libbase::vector<array2d_t> >& ra, libbase::vector<
+            array2d_t>& ri)
+   {
+   const int frames = rp.size();
+   for (int set = 0; set < num_sets(); set++)
+      bcjr_wrap(set, R(set), rp, ra, set, ri);
+   for (int f = 0; f < frames; f++)
+      work_parallel(ra(f), rp(f), ri(f));
+   }
+
 // internal codec operations
 
 template <class real, class dbl>
@@ -357,6 +496,9 @@ void turbo<real, dbl>::setreceiver(const array1vd_t& ptable)
          for (int x = 0; x < N; x++)
             R(set)(t, x) = rpi(t, x % K) * ptemp(set, t, x / K);
       BCJR::normalize(R(set));
+      // keep log-domain version for fast decoder
+      if (realization != 0)
+         logmap_bcjr<dbl>::convert(R(set), lR(set));
       }
 
    // Reset start- and end-state probabilities
@@ -483,6 +625,87 @@ void turbo<real, dbl>::softdecode(array1vd_t& ri, array1vd_t& ro)
    failwith("Not yet implemented");
    }
 
+// batch codec operations
+
+/*!
+ * \copydoc codec::can_batch()
+ *
+ * This requires all interleavers to stay the same from one frame to the next.
+ */
+template <class real, class dbl>
+bool turbo<real, dbl>::can_batch() const
+   {
+   for (int set = 0; set < num_sets(); set++)
+      if (!inter(set)->is_fixed())
+         return false;
+   return true;
+   }
+
+/*!
+ * \copydoc codec::batchdecode()
+ *
+ * Decisions are taken directly on the results of each iteration. With the
+ * exact component decoder (except for circular trellises), all frames go
+ * through each decoding stage together, and the BCJR recursions for all
+ * frames are worked out at once, with metrics interleaved across frames
+ * (see bcjr::fdecode()). Otherwise, frames are decoded in turn, sharing the
+ * working space. Either way, the decisions are the same as when decoding
+ * each frame alone.
+ */
+template <class real, class dbl>
+void turbo<real, dbl>::batchdecode(const libbase::vector<array1vd_t>& ptable,
+      libbase::vector<libbase::vector<array1i_t> >& decoded)
+   {
+   const int frames = ptable.size();
+   decoded.init(iter);
+   for (int i = 0; i < iter; i++)
+      decoded(i).init(frames);
+   hard_decision<libbase::vector, dbl> functor;
+   if (can_interleave_frames())
+      {
+      const int sets = num_sets();
+      // set up the intrinsic and initial extrinsic statistics for all frames
+      libbase::vector<libbase::vector<array2d_t> > fR(sets), fra(frames);
+      libbase::vector<array2d_t> frp(frames), fri(frames);
+      for (int set = 0; set < sets; set++)
+         fR(set).init(frames);
+      for (int f = 0; f < frames; f++)
+         {
+         this->init_decoder(ptable(f));
+         frp(f) = rp;
+         fra(f) = ra;
+         for (int set = 0; set < sets; set++)
+            fR(set)(f) = R(set);
+         }
+      for (int i = 0; i < iter; i++)
+         {
+         // do one iteration, in serial or parallel as required
+         if (parallel)
+            decode_parallel(fR, frp, fra, fri);
+         else
+            decode_serial(fR, frp, fra, fri);
+         for (int f = 0; f < frames; f++)
+            functor(fri(f), input_block_size(), decoded(i)(f));
+         }
+      return;
+      }
+   // temporary space to hold complete results (ie. with tail)
+   array2d_t rif;
+   for (int f = 0; f < frames; f++)
+      {
+      this->init_decoder(ptable(f));
+      for (int i = 0; i < iter; i++)
+         {
+         // do one iteration, in serial or parallel as required
+         if (parallel)
+            decode_parallel(rif);
+         else
+            decode_serial(rif);
+         functor(rif, input_block_size(), decoded(i)(f));
+         }
+      }
+   }
+
 // description output
 
 template <class real, class dbl>
@@ -498,6 +721,10 @@ std::string turbo<real, dbl>::description() const
    sout << (circular ? "Circular, " : "Non-circular, ");
    sout << (parallel ? "Parallel Decoding, " : "Serial Decoding, ");
    sout << iter << " iterations";
+   if (realization != 0)
+      sout << ", " << fast.description();
+   if (window > 0)
+      sout << ", Sliding Window (" << window << "+" << warmup << ")";
    return sout.str();
    }
 
@@ -508,7 +735,7 @@ std::ostream& turbo<real, dbl>::serialize(std::ostream& sout) const
    {
    // format version
    sout << "# Version" << std::endl;
-   sout << 2 << std::endl;
+   sout << 4 << std::endl;
    sout << "# Encoder" << std::endl;
    sout << encoder;
    sout << "# Number of parallel sets" << std::endl;
@@ -526,6 +753,16 @@ std::ostream& turbo<real, dbl>::serialize(std::ostream& sout) const
    sout << int(parallel) << std::endl;
    sout << "# Number of iterations" << std::endl;
    sout << iter << std::endl;
+   sout << "# Component decoder (0=exact, 1=max-log-MAP, 2=log-MAP)"
+         << std::endl;
+   sout << realization << std::endl;
+   sout << "# Fixed-point metrics? (max-log-MAP / log-MAP only)" << std::endl;
+   sout << int(fixedpoint) << std::endl;
+   sout << "# Sliding window length (0=whole block; exact decoder only)"
+         << std::endl;
+   sout << window << std::endl;
+   sout << "# Sliding window warm-up length" << std::endl;
+   sout << warmup << std::endl;
    return sout;
    }
 
@@ -537,6 +774,10 @@ std::ostream& turbo<real, dbl>::serialize(std::ostream& sout) const
  * \version 1 Added version numbering; added explicit first interleaver
  * 
  * \version 2 Removed explicit 'tau'
+ *
+ * \version 3 Added component decoder selection and fixed-point flag
+ *
+ * \version 4 Added sliding window and warm-up lengths
  */
 template <class real, class dbl>
 std::istream& turbo<real, dbl>::serialize(std::istream& sin)
@@ -574,6 +815,26 @@ std::istream& turbo<real, dbl>::serialize(std::istream& sin)
    sin >> libbase::eatcomments >> circular >> libbase::verify;
    sin >> libbase::eatcomments >> parallel >> libbase::verify;
    sin >> libbase::eatcomments >> iter >> libbase::verify;
+   if (version < 3)
+      {
+      realization = 0;
+      fixedpoint = false;
+      }
+   else
+      {
+      sin >> libbase::eatcomments >> realization >> libbase::verify;
+      sin >> libbase::eatcomments >> fixedpoint >> libbase::verify;
+      }
+   if (version < 4)
+      {
+      window = 0;
+      warmup = 0;
+      }
+   else
+      {
+      sin >> libbase::eatcomments >> window >> libbase::verify;
+      sin >> libbase::eatcomments >> warmup >> libbase::verify;
+      }
    init();
    assertalways(sin.good());
    return sin;
@@ -587,6 +848,7 @@ std::istream& turbo<real, dbl>::serialize(std::istream& sin)
 #include "mpgnu.h"
 #include "logreal.h"
 #include "logrealfast.h"
+#include "logfixed.h"
 
 namespace libcomm {
 
@@ -594,6 +856,8 @@ using libbase::mpreal;
 using libbase::mpgnu;
 using libbase::logreal;
 using libbase::logrealfast;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 using libbase::serializer;
 
@@ -633,4 +897,14 @@ const serializer turbo<logrealfast, logrealfast>::shelper =
       serializer("codec", "turbo<logrealfast,logrealfast>", turbo<logrealfast,
             logrealfast>::create);
 
+template class turbo<logfixed16> ;
+template <>
+const serializer turbo<logfixed16>::shelper = serializer("codec",
+      "turbo<logfixed16>", turbo<logfixed16>::create);
+
+template class turbo<logfixed8> ;
+template <>
+const serializer turbo<logfixed8>::shelper = serializer("codec",
+      "turbo<logfixed8>", turbo<logfixed8>::create);
+
 } // end namespace
@@ -30,6 +30,7 @@
 #include "fsm.h"
 #include "interleaver.h"
 #include "safe_bcjr.h"
+#include "algorithm/logmap_bcjr.h"
 #include "itfunc.h"
 
 #include <cstdlib>
@@ -72,6 +73,12 @@ namespace libcomm {
  * interpreted as v.0; a flat interleaver is automatically used for the
  * first encoder in these cases.
  *
+ * \note The component decoder can be either the exact BCJR algorithm (using
+ * the 'real' representation), or the faster log-domain realization in
+ * logmap_bcjr (max-log-MAP or log-MAP, with float or 16-bit fixed-point
+ * metrics); this is selected at serialization. The exact decoder can also
+ * work with a sliding window, to bound memory requirements for long blocks.
+ *
  * \todo Fix terminated sequence encoding (currently this implicitly assumes
  * a flat first interleaver)
  *
@@ -112,6 +119,10 @@ private:
    bool endatzero; //!< Flag to indicate that trellises are terminated
    bool parallel; //!< Flag to enable parallel decoding (rather than serial)
    bool circular; //!< Flag to indicate trellis tailbiting
+   int realization; //!< Component decoder: 0=exact, 1=max-log-MAP, 2=log-MAP
+   bool fixedpoint; //!< Flag to use fixed-point metrics (logmap_bcjr only)
+   int window; //!< Sliding window length (0 for whole block; exact only)
+   int warmup; //!< Sliding window warm-up length
    // @}
    /*! \name Internal object representation */
    bool initialised; //!< Flag to indicate when memory is initialised
@@ -120,6 +131,8 @@ private:
    libbase::vector<array2d_t> ra; //!< A priori extrinsic source statistics
    libbase::vector<array1d_t> ss; //!< Holder for start-state probabilities (used with circular trellises)
    libbase::vector<array1d_t> se; //!< Holder for end-state probabilities (used with circular trellises)
+   logmap_bcjr<dbl> fast; //!< Log-domain component decoder (if selected)
+   libbase::vector<libbase::matrix<float> > lR; //!< Log-domain R (fast only)
    // @}
    /*! \name Internal functions */
    //! Memory allocator (for internal use only)
@@ -131,6 +144,21 @@ private:
          array2d_t& re);
    void decode_serial(array2d_t& ri);
    void decode_parallel(array2d_t& ri);
+   static void work_parallel(libbase::vector<array2d_t>& ra,
+         const array2d_t& rp, array2d_t& ri);
+   // @}
+   /*! \name Internal functions - batch decoding */
+   bool can_interleave_frames() const;
+   void bcjr_wrap(const int set, const libbase::vector<array2d_t>& R,
+         const libbase::vector<array2d_t>& rp, libbase::vector<
+               libbase::vector<array2d_t> >& ra, const int k, libbase::vector<
+               array2d_t>& ri);
+   void decode_serial(const libbase::vector<libbase::vector<array2d_t> >& R,
+         const libbase::vector<array2d_t>& rp, libbase::vector<
+               libbase::vector<array2d_t> >& ra, libbase::vector<array2d_t>& ri);
+   void decode_parallel(const libbase::vector<libbase::vector<array2d_t> >& R,
+         const libbase::vector<array2d_t>& rp, libbase::vector<
+               libbase::vector<array2d_t> >& ra, libbase::vector<array2d_t>& ri);
    // @}
 protected:
    /*! \name Internal functions */
@@ -224,6 +252,11 @@ public:
    // (necessary because inheriting methods from templated base)
    using Base::decode;
 
+   // Batch codec operations
+   bool can_batch() const;
+   void batchdecode(const libbase::vector<array1vd_t>& ptable,
+         libbase::vector<libbase::vector<array1i_t> >& decoded);
+
    // Codec information functions - fundamental
    libbase::size_type<libbase::vector> input_block_size() const
       {
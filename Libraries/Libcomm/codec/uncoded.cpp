@@ -25,6 +25,7 @@
 #include "uncoded.h"
 #include "fsm/cached_fsm.h"
 #include "vectorutils.h"
+#include "hard_decision.h"
 #include <sstream>
 
 namespace libcomm {
@@ -37,6 +38,25 @@ void uncoded<dbl>::init()
    assertalways(encoder);
    // Check that FSM is memoryless
    assertalways(encoder->mem_order() == 0);
+   // Inherit sizes
+   const int k = enc_inputs();
+   const int n = enc_outputs();
+   const int S = This::num_inputs();
+   // Tabulate input-output mapping, for each input set considered
+   lut_ip.init(k * S, k);
+   lut_op.init(k * S, n);
+   encoder->reset();
+   array1i_t ip(k);
+   ip = 0;
+   for (int i = 0, j = 0; i < k; i++)
+      for (int x = 0; x < S; x++, j++)
+         {
+         // Update input set
+         ip(i) = x;
+         // Determine corresponding output set
+         lut_op.insertrow(encoder->step(ip), j);
+         lut_ip.insertrow(ip, j);
+         }
    }
 
 template <class dbl>
@@ -56,6 +76,27 @@ uncoded<dbl>::uncoded(const fsm& encoder, const int tau) :
    init();
    }
 
+/*!
+ * \brief Update input statistics according to those at output
+ * \param[in] R Intrinsic output statistics
+ * \param[in,out] ri Input statistics, initialized with prior statistics
+ */
+template <class dbl>
+void uncoded<dbl>::work_inputs(const array1vd_t& R, array1vd_t& ri) const
+   {
+   // Inherit sizes
+   const int k = enc_inputs();
+   const int n = enc_outputs();
+   const int J = lut_ip.size().rows();
+   // Consider each time-step
+   for (int t = 0; t < tau; t++)
+      // Go through each possible input set
+      for (int j = 0; j < J; j++)
+         for (int ii = 0; ii < k; ii++)
+            for (int oo = 0; oo < n; oo++)
+               ri(t * k + ii)(lut_ip(j, ii)) *= R(t * n + oo)(lut_op(j, oo));
+   }
+
 // internal codec operations
 
 template <class dbl>
@@ -116,31 +157,10 @@ void uncoded<dbl>::encode(const array1i_t& source, array1i_t& encoded)
 template <class dbl>
 void uncoded<dbl>::softdecode(array1vd_t& ri)
    {
-   // Inherit sizes
-   const int k = enc_inputs();
-   const int n = enc_outputs();
-   const int S = This::num_inputs();
    // Initialize results to prior statistics
    ri = rp;
-   // Consider each time-step
-   for (int t = 0; t < tau; t++)
-      {
-      array1i_t ip(k), op(n);
-      // Go through each possible input set
-      ip = 0;
-      for (int i = 0; i < k; i++)
-         for (int x = 0; x < S; x++)
-            {
-            // Update input set
-            ip(i) = x;
-            // Determine corresponding output set
-            op = encoder->step(ip);
-            // Update probabilities at input according to those at output
-            for (int ii = 0; ii < k; ii++)
-               for (int oo = 0; oo < n; oo++)
-                  ri(t * k + ii)(ip(ii)) *= R(t * n + oo)(op(oo));
-            }
-      }
+   // Update according to output statistics
+   work_inputs(R, ri);
    }
 
 template <class dbl>
@@ -150,29 +170,71 @@ void uncoded<dbl>::softdecode(array1vd_t& ri, array1vd_t& ro)
    // Inherit sizes
    const int k = enc_inputs();
    const int n = enc_outputs();
-   const int S = This::num_inputs();
+   const int J = lut_ip.size().rows();
    // Allocate space for output results
    libbase::allocate(ro, This::output_block_size(), This::num_outputs());
    // Initialize
    ro = 1.0;
    // Consider each time-step
    for (int t = 0; t < tau; t++)
-      {
-      array1i_t ip(k), op(n);
       // Go through each possible input set
-      ip = 0;
-      for (int i = 0; i < k; i++)
-         for (int x = 0; x < S; x++)
-            {
-            // Update input set
-            ip(i) = x;
-            // Determine corresponding output set
-            op = encoder->step(ip);
-            // Update probabilities at output according to those at input
-            for (int ii = 0; ii < k; ii++)
-               for (int oo = 0; oo < n; oo++)
-                  ro(t * n + oo)(op(oo)) *= ri(t * k + ii)(ip(ii));
-            }
+      for (int j = 0; j < J; j++)
+         // Update probabilities at output according to those at input
+         for (int ii = 0; ii < k; ii++)
+            for (int oo = 0; oo < n; oo++)
+               ro(t * n + oo)(lut_op(j, oo)) *= ri(t * k + ii)(lut_ip(j, ii));
+   }
+
+// batch codec operations
+
+/*!
+ * \copydoc codec::batchdecode()
+ *
+ * Each frame is worked directly from the given likelihoods, with
+ * equiprobable priors, sharing the same working space. Frames are worked in
+ * turn rather than interleaved, as each symbol is decided independently with
+ * a few table lookups; there is no recursion to vectorize across frames.
+ */
+template <class dbl>
+void uncoded<dbl>::batchdecode(const libbase::vector<array1vd_t>& ptable,
+      libbase::vector<libbase::vector<array1i_t> >& decoded)
+   {
+   const int frames = ptable.size();
+   decoded.init(1);
+   decoded(0).init(frames);
+   array1vd_t ri;
+   libbase::allocate(ri, This::input_block_size(), This::num_inputs());
+   hard_decision<libbase::vector, dbl> functor;
+   for (int f = 0; f < frames; f++)
+      {
+      // Confirm input sequence to be of the correct length
+      assertalways(ptable(f).size() == This::output_block_size());
+      ri = 1.0;
+      work_inputs(ptable(f), ri);
+      functor(ri, decoded(0)(f));
+      }
+   }
+
+/*!
+ * \copydoc codec_softout_interface::batchsoftdecode()
+ *
+ * Each frame is worked directly from the given likelihoods, with
+ * equiprobable priors.
+ */
+template <class dbl>
+void uncoded<dbl>::batchsoftdecode(const libbase::vector<array1vd_t>& ptable,
+      libbase::vector<libbase::vector<array1vd_t> >& ri)
+   {
+   const int frames = ptable.size();
+   ri.init(1);
+   ri(0).init(frames);
+   for (int f = 0; f < frames; f++)
+      {
+      // Confirm input sequence to be of the correct length
+      assertalways(ptable(f).size() == This::output_block_size());
+      libbase::allocate(ri(0)(f), This::input_block_size(), This::num_inputs());
+      ri(0)(f) = 1.0;
+      work_inputs(ptable(f), ri(0)(f));
       }
    }
 
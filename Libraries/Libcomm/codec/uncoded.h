@@ -44,6 +44,9 @@ namespace libcomm {
  * - $Date: 2011-11-23 18:57:30 +0000 (Wed, 23 Nov 2011) $
  * - $Author: jabriffa $
  *
+ * \note The input-output mapping considered in decoding is tabulated at
+ * initialization; in batch decoding, frames are worked directly from the
+ * given likelihoods, sharing the same working space.
  */
 
 template <class dbl = double>
@@ -51,6 +54,7 @@ class uncoded : public codec_softout<libbase::vector, dbl> {
 public:
    /*! \name Type definitions */
    typedef libbase::vector<int> array1i_t;
+   typedef libbase::matrix<int> array2i_t;
    typedef libbase::vector<dbl> array1d_t;
    typedef libbase::vector<array1d_t> array1vd_t;
    // @}
@@ -68,10 +72,15 @@ private:
    array1vd_t rp; //!< Intrinsic source statistics
    array1vd_t R; //!< Intrinsic output statistics
    // @}
+   /*! \name Mapping tables, for each input set considered in decoding */
+   array2i_t lut_ip; //!< lut_ip(j,i) = i'th input symbol for input set 'j'
+   array2i_t lut_op; //!< lut_op(j,o) = o'th output symbol for input set 'j'
+   // @}
 protected:
    /*! \name Internal functions */
    void init();
    void free();
+   void work_inputs(const array1vd_t& R, array1vd_t& ri) const;
    // @}
    /*! \name Codec information functions - internal */
    //! Number of encoder input symbols / timestep
@@ -100,7 +109,8 @@ public:
       }
    //! Copy constructor
    uncoded(const uncoded<dbl>& x) :
-      encoder(dynamic_cast<fsm*> (x.encoder->clone())), tau(x.tau), rp(x.rp), R(x.R)
+      encoder(dynamic_cast<fsm*> (x.encoder->clone())), tau(x.tau), rp(x.rp),
+            R(x.R), lut_ip(x.lut_ip), lut_op(x.lut_op)
       {
       }
    uncoded(const fsm& encoder, const int tau);
@@ -115,6 +125,12 @@ public:
    void softdecode(array1vd_t& ri);
    void softdecode(array1vd_t& ri, array1vd_t& ro);
 
+   // Batch codec operations
+   void batchdecode(const libbase::vector<array1vd_t>& ptable,
+         libbase::vector<libbase::vector<array1i_t> >& decoded);
+   void batchsoftdecode(const libbase::vector<array1vd_t>& ptable,
+         libbase::vector<libbase::vector<array1vd_t> >& ri);
+
    // Codec information functions - fundamental
    libbase::size_type<libbase::vector> input_block_size() const
       {
@@ -141,6 +141,26 @@ void basic_commsys<S, C>::seedfrom(libbase::random& r)
    chan->seedfrom(r);
    }
 
+// Internal receive path steps
+
+template <class S, template <class > class C>
+void basic_commsys<S, C>::demodulate_path(const C<S>& received,
+      C<array1d_t>& ptable_mapped)
+   {
+   this->mdm->reset_timers();
+   this->mdm->demodulate(*this->chan, received, ptable_mapped);
+   this->add_timers(*this->mdm);
+   }
+
+template <class S, template <class > class C>
+void basic_commsys<S, C>::unmap_path(const C<array1d_t>& ptable_mapped,
+      C<array1d_t>& ptable_encoded)
+   {
+   this->map->reset_timers();
+   this->map->inverse(ptable_mapped, ptable_encoded);
+   this->add_timers(*this->map);
+   }
+
 // Communication System Interface
 
 /*!
@@ -230,9 +250,7 @@ void basic_commsys<S, C>::receive_path(const C<S>& received)
    {
    // Demodulate
    C<array1d_t> ptable_mapped;
-   this->mdm->reset_timers();
-   this->mdm->demodulate(*this->chan, received, ptable_mapped);
-   this->add_timers(*this->mdm);
+   demodulate_path(received, ptable_mapped);
    // After-demodulation receive path
    softreceive_path(ptable_mapped);
    }
@@ -258,9 +276,7 @@ void basic_commsys<S, C>::softreceive_path(const C<array1d_t>& ptable_mapped)
    {
    // Inverse Map
    C<array1d_t> ptable_encoded;
-   this->map->reset_timers();
-   this->map->inverse(ptable_mapped, ptable_encoded);
-   this->add_timers(*this->map);
+   unmap_path(ptable_mapped, ptable_encoded);
    // Translate
    this->cdc->reset_timers();
    this->cdc->init_decoder(ptable_encoded);
@@ -289,6 +305,46 @@ void basic_commsys<S, C>::decode(C<int>& decoded)
 #endif
    }
 
+// Batch Interface
+
+/*!
+ * \param[in] received Received sequence for the frame
+ * \param[out] ptable_encoded Statistics at the decoder input, to be passed to
+ * batchdecode() with those of the other frames in the batch
+ *
+ * This consists of the receive path up to, but excluding, decoder
+ * initialization; it must be performed for each frame as it is received, as
+ * the modem or mapper may depend on the last frame sent.
+ */
+template <class S, template <class > class C>
+void basic_commsys<S, C>::batchreceive_path(const C<S>& received,
+      C<array1d_t>& ptable_encoded)
+   {
+   assert(can_batch());
+   // Demodulate
+   C<array1d_t> ptable_mapped;
+   demodulate_path(received, ptable_mapped);
+   // Inverse Map
+   unmap_path(ptable_mapped, ptable_encoded);
+   }
+
+/*!
+ * \param[in] ptable_encoded Statistics at the decoder input, for each frame
+ * \param[out] decoded Decoded sequences, for each iteration and frame
+ *
+ * \sa codec::batchdecode()
+ */
+template <class S, template <class > class C>
+void basic_commsys<S, C>::batchdecode(
+      const libbase::vector<C<array1d_t> >& ptable_encoded, libbase::vector<
+            libbase::vector<C<int> > >& decoded)
+   {
+   assert(can_batch());
+   this->cdc->reset_timers();
+   this->cdc->batchdecode(ptable_encoded, decoded);
+   this->add_timers(*this->cdc);
+   }
+
 // Description & Serialization
 
 template <class S, template <class > class C>
@@ -49,6 +49,12 @@ namespace libcomm {
  * - Integrates functionality of binary variant.
  * - Explicit instantiations for bool and gf types are present.
  *
+ * Frames may also be decoded in batches: the receive path is performed for
+ * each frame as it is received, up to the decoder input (see
+ * batchreceive_path()), after which all frames are decoded together (see
+ * batchdecode()). Systems where decoding cannot be separated from the
+ * receive path in this way indicate so through can_batch().
+ *
  * \todo Consider removing subcomponent getters, enforcing calls through this
  * interface
  */
@@ -77,6 +83,14 @@ protected:
    void clear();
    void free();
    // @}
+   /*! \name Internal receive path steps */
+   //! Demodulate received sequence
+   virtual void demodulate_path(const C<S>& received,
+         C<array1d_t>& ptable_mapped);
+   //! Inverse map demodulated statistics
+   void unmap_path(const C<array1d_t>& ptable_mapped,
+         C<array1d_t>& ptable_encoded);
+   // @}
 public:
    /*! \name Constructors / Destructors */
    basic_commsys(const basic_commsys<S, C>& c);
@@ -127,6 +141,20 @@ public:
    virtual void decode(C<int>& decoded);
    // @}
 
+   /*! \name Batch Interface */
+   //! Whether frames can be decoded in batches
+   virtual bool can_batch() const
+      {
+      return cdc->can_batch();
+      }
+   //! Perform receive path for a frame in a batch, up to the decoder input
+   virtual void batchreceive_path(const C<S>& received,
+         C<array1d_t>& ptable_encoded);
+   //! Perform all decoding iterations for a batch of frames, with hard decision
+   virtual void batchdecode(const libbase::vector<C<array1d_t> >& ptable_encoded,
+         libbase::vector<libbase::vector<C<int> > >& decoded);
+   // @}
+
    /*! \name Informative functions */
    //! Number of iterations to perform
    virtual int num_iter() const
@@ -81,6 +81,12 @@ public:
    // Communication System Interface
    void receive_path(const C<S>& received);
    void decode(C<int>& decoded);
+   // Batch Interface
+   //! Decoding needs the modem at each iteration, so cannot be batched
+   bool can_batch() const
+      {
+      return false;
+      }
    // Informative functions
    int num_iter() const
       {
@@ -30,13 +30,12 @@
 
 namespace libcomm {
 
-// Communication System Interface
+// Internal receive path steps
 
 template <class S, template <class > class C>
-void commsys_iterative<S, C>::receive_path(const C<S>& received)
+void commsys_iterative<S, C>::demodulate_path(const C<S>& received,
+      C<array1d_t>& ptable_mapped)
    {
-   // Demodulate
-   C<array1d_t> ptable_mapped;
    informed_modulator<S>& m = dynamic_cast<informed_modulator<S>&> (*this->mdm);
    for (int i = 0; i < iter; i++)
       {
@@ -47,8 +46,6 @@ void commsys_iterative<S, C>::receive_path(const C<S>& received)
       m.mark_as_clean();
       }
    m.mark_as_dirty();
-   // After-demodulation receive path
-   softreceive_path(ptable_mapped);
    }
 
 // Description & Serialization
@@ -61,9 +61,9 @@ private:
    /*! \name User parameters */
    int iter; //!< Number of demodulation iterations
    // @}
-public:
-   // Communication System Interface
-   void receive_path(const C<S>& received);
+protected:
+   // Internal receive path steps
+   void demodulate_path(const C<S>& received, C<array1d_t>& ptable_mapped);
 
    // Description
    std::string description() const;
@@ -40,6 +40,10 @@
 
 namespace libcomm {
 
+// Batch settings
+
+int commsys_batch::frames = 1;
+
 // *** Templated Common Base ***
 
 // Setup functions
@@ -57,6 +61,7 @@ void commsys_simulator<S, R>::clear()
    {
    src = NULL;
    sys = NULL;
+   discardbatch();
    }
 
 /*!
@@ -99,6 +104,45 @@ libbase::vector<int> commsys_simulator<S, R>::createsource()
    return source;
    }
 
+//! Discard any frames left in the current batch
+template <class S, class R>
+void commsys_simulator<S, R>::discardbatch()
+   {
+   batch_source.init(0);
+   batch_decoded.init(0);
+   batch_next = 0;
+   }
+
+/*!
+ * \brief Simulate a batch of frames, up to and including decoding
+ * \param[in] frames Number of frames in batch
+ *
+ * The source sequence creation, encoding, transmission and receive path up to
+ * the decoder input are done for each frame in turn, so that random
+ * generators are used in the same order as for unbatched simulation.
+ */
+template <class S, class R>
+void commsys_simulator<S, R>::createbatch(const int frames)
+   {
+   libbase::vector<libbase::vector<libbase::vector<double> > > ptable(frames);
+   batch_source.init(frames);
+   for (int f = 0; f < frames; f++)
+      {
+      // Create source stream
+      batch_source(f) = createsource();
+      // Encode -> Map -> Modulate
+      libbase::vector<S> transmitted = sys->encode_path(batch_source(f));
+      // Transmit
+      libbase::vector<S> received = sys->transmit(transmitted);
+      // Demodulate -> Inverse Map
+      sys->batchreceive_path(received, ptable(f));
+      }
+   // Decode all frames, for every iteration
+   sys->batchdecode(ptable, batch_decoded);
+   batch_next = 0;
+   batch_parameter = get_parameter();
+   }
+
 // Constructors / Destructors
 
 /*!
@@ -111,6 +155,7 @@ commsys_simulator<S, R>::commsys_simulator(const commsys_simulator<S, R>& c)
    {
    this->src = new libbase::randgen(*c.src);
    this->sys = dynamic_cast<commsys<S> *> (c.sys->clone());
+   discardbatch();
    }
 
 // Experiment parameter handling
@@ -120,6 +165,7 @@ void commsys_simulator<S, R>::seedfrom(libbase::random& r)
    {
    src->seed(r.ival());
    sys->seedfrom(r);
+   discardbatch();
    }
 
 // Experiment handling
@@ -134,6 +180,10 @@ void commsys_simulator<S, R>::seedfrom(libbase::random& r)
  * \note The results collector assumes that the result vector is an accumulator,
  * so that every call adds to the existing result. This explains the need to
  * initialize the result vector to zero.
+ *
+ * \note When batching, a new batch is simulated whenever the current one is
+ * used up (or was simulated at a different parameter value); otherwise the
+ * next frame is taken from the current batch.
  */
 template <class S, class R>
 void commsys_simulator<S, R>::sample(libbase::vector<double>& result)
@@ -141,6 +191,30 @@ void commsys_simulator<S, R>::sample(libbase::vector<double>& result)
    // Initialise result vector
    result.init(count());
    result = 0;
+   // Batched simulation
+   if (commsys_batch::get() > 1 && sys->can_batch())
+      {
+      if (batch_next >= batch_source.size() || batch_parameter
+            != get_parameter())
+         createbatch(commsys_batch::get());
+      const int f = batch_next++;
+      const libbase::vector<int>& source = batch_source(f);
+      // For every iteration, update results
+      for (int i = 0; i < sys->num_iter(); i++)
+         R::updateresults(result, i, source, batch_decoded(i)(f));
+      // Keep record of what we last simulated
+      const libbase::vector<int>& decoded = batch_decoded(sys->num_iter() - 1)(f);
+      const int tau = sys->input_block_size();
+      assert(source.size() == tau);
+      assert(decoded.size() == tau);
+      last_event.init(2 * tau);
+      for (int i = 0; i < tau; i++)
+         {
+         last_event(i) = source(i);
+         last_event(i + tau) = decoded(i);
+         }
+      return;
+      }
    // Create source stream
    libbase::vector<int> source = createsource();
    // Encode -> Map -> Modulate
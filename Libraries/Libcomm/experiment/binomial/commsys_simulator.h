@@ -34,6 +34,32 @@
 
 namespace libcomm {
 
+/*!
+ * \brief   Batch settings for the communication systems simulator.
+ * \author  Johann Briffa
+ *
+ * Holds the number of frames that are decoded together by each simulator;
+ * this is a process-wide setting, as it affects only the speed of the
+ * simulation and not its results.
+ */
+
+class commsys_batch {
+private:
+   static int frames; //!< Number of frames decoded together
+public:
+   //! Set number of frames decoded together (1 for no batching)
+   static void set(int frames)
+      {
+      assertalways(frames >= 1);
+      commsys_batch::frames = frames;
+      }
+   //! Get number of frames decoded together
+   static int get()
+      {
+      return frames;
+      }
+};
+
 /*!
  * \brief   Communication Systems Simulator.
  * \author  Johann Briffa
@@ -43,6 +69,15 @@ namespace libcomm {
  * - $Date: 2011-11-18 17:58:59 +0000 (Fri, 18 Nov 2011) $
  * - $Author: jabriffa $
  *
+ * Where a batch size greater than one is set (see commsys_batch), and the
+ * system allows it, frames are simulated in batches: the source, transmission
+ * and receive path up to the decoder input are performed for each frame in
+ * turn, in the same order as for unbatched simulation, after which all
+ * frames are decoded together. Results are still returned one frame per
+ * sample, so that the results are identical to those of an unbatched
+ * simulation. Any frames left in a batch are discarded when the simulator is
+ * reseeded or the parameter changes.
+ *
  * \todo Clean up interface with commsys object, particularly in cycleonce()
  */
 
@@ -55,6 +90,10 @@ protected:
    // @}
    /*! \name Internal state */
    libbase::vector<int> last_event;
+   libbase::vector<libbase::vector<int> > batch_source; //!< Source sequences for batch
+   libbase::vector<libbase::vector<libbase::vector<int> > > batch_decoded; //!< Decoded sequences for batch, by iteration
+   int batch_next; //!< Index of next frame to return from batch
+   double batch_parameter; //!< Parameter value used for batch
    // @}
 protected:
    /*! \name Setup functions */
@@ -63,6 +102,8 @@ protected:
    // @}
    /*! \name Internal functions */
    libbase::vector<int> createsource();
+   void discardbatch();
+   void createbatch(const int frames);
    // @}
    // System Interface for Results
    int get_iter() const
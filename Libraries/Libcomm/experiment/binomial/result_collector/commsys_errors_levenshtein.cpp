@@ -26,7 +26,6 @@
 #include "fsm.h"
 #include "itfunc.h"
 #include "hamming.h"
-#include "levenshtein.h"
 #include <sstream>
 
 namespace libcomm {
@@ -50,7 +49,7 @@ void commsys_errors_levenshtein::updateresults(libbase::vector<double>& result,
    assert(i >= 0 && i < get_iter());
    // Count errors
    const int hd = libbase::hamming(source, decoded);
-   const int ld = libbase::levenshtein(source, decoded);
+   const int ld = hd ? ld_engine.distance(source, decoded, hd) : 0;
    // Estimate the SER, LD, FER
    result(3 * i + 0) += hd;
    result(3 * i + 1) += ld;
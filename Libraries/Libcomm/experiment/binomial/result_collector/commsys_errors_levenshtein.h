@@ -27,6 +27,7 @@
 
 #include "config.h"
 #include "vector.h"
+#include "levenshtein.h"
 #include <string>
 
 namespace libcomm {
@@ -42,8 +43,18 @@ namespace libcomm {
  *
  * Implements error rate calculators for SER (using both Hamming and
  * Levenshtein distances) and FER.
+ *
+ * The Levenshtein distance is computed with the bit-parallel method, within
+ * the band given by the Hamming distance (which bounds it from above). The
+ * working space is kept with the object; each local worker in montecarlo has
+ * its own copy of the system, so this is never shared between threads.
  */
 class commsys_errors_levenshtein {
+private:
+   /*! \name Internal representation */
+   //! Levenshtein distance calculator, with its working space
+   mutable libbase::levenshtein_bitparallel<int> ld_engine;
+   // @}
 protected:
    /*! \name System Interface */
    //! The number of decoding iterations performed
@@ -95,6 +95,36 @@ public:
          decoded(t) = basic_hard_decision<dbl>::operator()(ri(t));
          }
       }
+   /*!
+    * \brief Hard decision on soft information
+    * \param[in]  ri       Likelihood table for input symbols, with one row per
+    * timestep
+    * \param[in]  tau      Number of timesteps to decide (from the first row)
+    * \param[out] decoded  Sequence of the most likely input symbols at every
+    * timestep
+    *
+    * Decide which input sequence was most probable; this is useful when the
+    * likelihood table includes additional timesteps (eg. a tail).
+    */
+   void operator()(const libbase::matrix<dbl>& ri, const int tau,
+         libbase::vector<int>& decoded)
+      {
+      assert(tau > 0 && tau <= ri.size().rows());
+      // Determine sizes from input matrix
+      const int K = ri.size().cols();
+      assert(K > 0);
+      // Initialise result vector
+      decoded.init(tau);
+      // Determine most likely symbol at every timestep
+      for (int t = 0; t < tau; t++)
+         {
+         int d = 0;
+         for (int i = 1; i < K; i++)
+            if (ri(t, i) > ri(t, d))
+               d = i;
+         decoded(t) = d;
+         }
+      }
 };
 
 template <class dbl>
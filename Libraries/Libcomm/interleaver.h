@@ -65,6 +65,11 @@ public:
    virtual void advance()
       {
       }
+   //! Whether the interleaver stays the same from one frame to the next
+   virtual bool is_fixed() const
+      {
+      return true;
+      }
    // @}
 
    /*! \name Transform Functions */
@@ -69,6 +69,10 @@ public:
 
    void seedfrom(libbase::random& r);
    void advance();
+   bool is_fixed() const
+      {
+      return false;
+      }
 
    // Description
    std::string description() const;
@@ -62,6 +62,10 @@ public:
    // Intra-frame Operations
    void seedfrom(libbase::random& r);
    void advance();
+   bool is_fixed() const
+      {
+      return false;
+      }
 
    // Transform functions
    void
@@ -99,6 +99,24 @@ public:
       // compute the conditional probability
       return computer.receive(tx, r);
       }
+   /*!
+    * \brief Batch receiver interface, for all symbols and end drifts
+    *
+    * Sets ptable(d,mu-mumin) = R(d, i, r.extract(0, n+mu)) for all symbols
+    * 'd' and for mu in [mumin, r.size()-n].
+    */
+   void R(int i, const libbase::vector<bool>& r, int mumin,
+         libbase::matrix<libcomm::bsid::real>& ptable) const
+      {
+      const int w = ws(i); // watermark vector
+      const int q = lut.size().cols();
+      // 'tx' is the set of transmitted symbols that we're considering
+      libbase::vector<libbase::bitfield> tx(q);
+      for (int d = 0; d < q; d++)
+         tx(d) = libbase::bitfield(w ^ lut(i % lut.size().rows(), d), n);
+      // compute the conditional probabilities
+      computer.receive(tx, r, mumin, ptable);
+      }
 };
 
 // Reset debug level, to avoid affecting other files
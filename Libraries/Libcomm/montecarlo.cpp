@@ -28,9 +28,12 @@
 #include "itfunc.h"
 #include "secant.h"
 #include "truerand.h"
-#include "randgen.h"
+#include "philox.h"
+#include "checkpointfile.h"
 #include <sstream>
 #include <limits>
+#include <algorithm>
+#include <boost/bind.hpp>
 
 namespace libcomm {
 
@@ -65,7 +68,6 @@ void montecarlo::slave_getparameter(void)
    {
    cerr << "Date: " << libbase::timer::date() << std::endl;
 
-   seed_experiment();
    double x;
    if (!receive(x))
       exit(1);
@@ -77,28 +79,52 @@ void montecarlo::slave_getparameter(void)
 
 void montecarlo::slave_work(void)
    {
-   // Initialise running values
-   system->reset();
+   // Get the size of this work unit from master
+   double worktime, interval;
+   if (!receive(worktime) || !receive(interval))
+      exit(1);
+   // Get the key for this work unit, and seed the system accordingly
+   int seed, stream, unit;
+   if (!receive(seed) || !receive(stream) || !receive(unit))
+      exit(1);
+   seed_experiment(system, seed, stream, unit);
+   cerr << "Key: " << libbase::int32u(seed) << " " << libbase::int32u(stream)
+         << " " << libbase::int32u(unit) << std::endl;
 
-   // Iterate for 500ms, which is a good compromise between efficiency and usability
+   // Iterate for the required time, sending partial results back to master
+   // at the given interval (the last of these concludes the work unit)
    libbase::walltimer tslave("montecarlo_slave");
-   while (tslave.elapsed() < 0.5)
-      sampleandaccumulate();
-   tslave.stop(); // to avoid expiry
+   bool last = false;
+   while (!last)
+      {
+      // Initialise running values
+      system->reset();
+      // Iterate for one update interval (always at least one sample)
+      const double tstart = tslave.elapsed();
+      do
+         {
+         sampleandaccumulate();
+         } while (tslave.elapsed() - tstart < interval && tslave.elapsed()
+            < worktime);
+      last = (tslave.elapsed() >= worktime);
 
-   // Send system digest and current parameter back to master
-   assertalways(send(sysdigest));
-   assertalways(send(system->get_parameter()));
-   // Send accumulated results back to master
-   libbase::vector<double> state;
-   system->get_state(state);
-   assertalways(send(system->get_samplecount()));
-   assertalways(send(state));
+      // Send system digest and current parameter back to master
+      assertalways(send(sysdigest));
+      assertalways(send(system->get_parameter()));
+      // Send flag to indicate whether this concludes the work unit
+      assertalways(send(int(last)));
+      // Send accumulated results back to master
+      libbase::vector<double> state;
+      system->get_state(state);
+      assertalways(send(system->get_samplecount()));
+      assertalways(send(state));
 
-   // print something to inform the user of our progress
-   vector<double> result, tolerance;
-   updateresults(result, tolerance);
-   display();
+      // print something to inform the user of our progress
+      vector<double> result, tolerance;
+      updateresults(result, tolerance);
+      display();
+      }
+   tslave.stop(); // to avoid expiry
    }
 
 // helper functions
@@ -111,14 +137,23 @@ std::string montecarlo::get_systemstring()
    return systemstring;
    }
 
-void montecarlo::seed_experiment()
+/*!
+ * \brief Seed the given experiment from a key
+ * \param   system   Experiment to be seeded
+ * \param   seed     Run seed
+ * \param   stream   Stream number (slave or worker)
+ * \param   unit     Work unit number
+ *
+ * The experiment is seeded from the given stream and substream of a
+ * counter-based generator, so that different keys give non-overlapping
+ * sequences, and the same key always gives the same sequence.
+ */
+void montecarlo::seed_experiment(experiment *system, libbase::int32u seed,
+      libbase::int32u stream, libbase::int32u unit)
    {
-   libbase::truerand trng;
-   libbase::randgen prng;
-   const libbase::int32u seed = trng.ival();
-   prng.seed(seed);
+   libbase::philox prng;
+   prng.seed(seed, stream, unit);
    system->seedfrom(prng);
-   cerr << "Seed: " << seed << std::endl;
    }
 
 void montecarlo::createfunctors(void)
@@ -201,9 +236,10 @@ void montecarlo::writestate(std::ostream& sout) const
    sout << "## System: " << sysdigest << std::endl;
    sout << "## Parameter: " << system->get_parameter() << std::endl;
    sout << "## Samples: " << get_samplecount() << std::endl;
-   sout << "## State: " << state.size() << '\t';
-   state.serialize(sout, '\t');
    sout << std::flush;
+   // Write state values to binary checkpoint file
+   checkpointfile(get_checkpointname()).write(sysdigest,
+         system->get_parameter(), get_samplecount(), state);
    trace << "DEBUG (montecarlo): position after = " << sout.tellp()
          << std::endl;
    }
@@ -216,15 +252,35 @@ void montecarlo::lookforstate(std::istream& sin)
    double parameter = 0;
    libbase::int64u samplecount = 0;
    vector<double> state;
-   // read through entire file
+   // nothing to find if results file is new
    trace << "DEBUG (montecarlo): looking for state." << std::endl;
+   sin.seekg(0, std::ios_base::end);
+   if (sin.tellg() == std::streampos(0))
+      return;
+   // look in binary checkpoint file, if there is one
+   const checkpointfile ckpt(get_checkpointname());
+   if (ckpt.exists())
+      {
+      if (ckpt.read(sysdigest, system->get_parameter(), samplecount, state))
+         {
+         cerr << "NOTICE: Reloading state with " << samplecount
+               << " samples." << std::endl;
+         system->accumulate_state(samplecount, state);
+         }
+      return;
+      }
+   // otherwise read through entire (legacy) file, for any state saved as text
    sin.seekg(0);
    while (!sin.eof())
       {
       std::string s;
       getline(sin, s);
       if (s.substr(0, 10) == "## System:")
-         digest = s.substr(10);
+         {
+         std::istringstream is(s.substr(10));
+         is >> digest;
+         state.init(0);
+         }
       else if (s.substr(0, 13) == "## Parameter:")
          std::istringstream(s.substr(13)) >> parameter;
       else if (s.substr(0, 11) == "## Samples:")
@@ -238,7 +294,8 @@ void montecarlo::lookforstate(std::istream& sin)
    // reset file
    sin.clear();
    // check that results correspond to system under simulation
-   if (digest == std::string(sysdigest) && parameter == system->get_parameter())
+   if (digest == std::string(sysdigest) && parameter == system->get_parameter()
+         && state.size() > 0)
       {
       cerr << "NOTICE: Reloading state with " << samplecount << " samples."
             << std::endl;
@@ -246,6 +303,42 @@ void montecarlo::lookforstate(std::istream& sin)
       }
    }
 
+void montecarlo::discardstate() const
+   {
+   trace << "DEBUG (montecarlo): discarding state." << std::endl;
+   checkpointfile(get_checkpointname()).erase(sysdigest,
+         system->get_parameter());
+   }
+
+/*!
+ * \brief Write the interim results and state
+ *
+ * During a sweep this covers every point still being simulated, so that all
+ * their states are saved (including to the checkpoint file); otherwise only
+ * the bound system is written.
+ */
+void montecarlo::writeinterim(std::ostream& sout, vector<double>& result,
+      vector<double>& tolerance)
+   {
+   if (points.empty())
+      {
+      resultsfile::writeinterim(sout, result, tolerance);
+      return;
+      }
+   experiment *const bound_system = system;
+   for (size_t k = 0; k < points.size(); k++)
+      {
+      const sweeppoint& p = points[k];
+      if (!p.active || p.system->get_samplecount() == 0)
+         continue;
+      system = p.system;
+      updateresults(result, tolerance);
+      writeresults(sout, result, tolerance);
+      writestate(sout);
+      }
+   system = bound_system;
+   }
+
 // overrideable user-interface functions
 
 /*!
@@ -262,13 +355,38 @@ void montecarlo::display() const
       clog << "Timer: " << t << ", ";
       if (isenabled())
          clog << getnumslaves() << " clients, ";
+      else if (threads > 1)
+         clog << "local (" << threads << " threads), ";
       else
          clog << "local, ";
       clog << getcputime() / t.elapsed() << "x usage, ";
-      clog << "pass " << system->get_samplecount() << "." << std::endl;
-      clog << "System parameter: " << system->get_parameter() << std::endl;
-      clog << "Results:" << std::endl;
-      system->prettyprint_results(clog);
+      if (points.empty())
+         clog << "pass " << system->get_samplecount() << "." << std::endl;
+      else
+         clog << "pass " << slave_samplecount << "." << std::endl;
+      if (points.empty())
+         {
+         clog << "System parameter: " << system->get_parameter() << std::endl;
+         clog << "Results:" << std::endl;
+         system->prettyprint_results(clog);
+         }
+      else
+         {
+         clog << "Sweep:" << std::endl;
+         for (size_t k = 0; k < points.size(); k++)
+            {
+            const sweeppoint& p = points[k];
+            clog << p.system->get_parameter() << '\t';
+            clog << p.system->get_samplecount() << " samples\t";
+            if (!p.active)
+               clog << "done";
+            else if (p.acc < std::numeric_limits<double>::max())
+               clog << "[+/- " << 100 * p.acc << "%]";
+            else
+               clog << "[no events]";
+            clog << std::endl;
+            }
+         }
       clog << "Press 'q' to interrupt." << std::endl;
       clog.precision(prec);
       tupdate.start();
@@ -283,9 +401,14 @@ montecarlo::montecarlo() :
    createfunctors();
    bound = false;
    system = NULL;
+   slave_samplecount = 0;
+   units = 0;
    // set default parameter settings
    set_confidence(0.95);
    set_accuracy(0.10);
+   set_threads(1);
+   libbase::truerand trng;
+   set_seed(trng.ival());
    }
 
 montecarlo::~montecarlo()
@@ -333,6 +456,20 @@ void montecarlo::set_accuracy(double accuracy)
    montecarlo::accuracy = accuracy;
    }
 
+void montecarlo::set_threads(int threads)
+   {
+   assertalways(threads >= 1);
+   trace << "DEBUG (montecarlo): setting number of local threads to "
+         << threads << std::endl;
+   montecarlo::threads = threads;
+   }
+
+void montecarlo::set_seed(libbase::int32u seed)
+   {
+   trace << "DEBUG (montecarlo): setting run seed to " << seed << std::endl;
+   montecarlo::seed = seed;
+   }
+
 // main process
 
 /*!
@@ -390,6 +527,7 @@ void montecarlo::initslave(slave *s, std::string systemstring)
       return;
    if (!send(s, system->get_parameter()))
       return;
+   slave_point.erase(s);
    trace << "DEBUG (estimate): Slave (" << s << ") initialized ok."
          << std::endl;
    }
@@ -411,9 +549,87 @@ void montecarlo::initnewslaves(std::string systemstring)
       }
    }
 
+/*!
+ * \brief Estimate the number of samples still needed for convergence
+ * \param   acc   Largest tolerance currently reached
+ * \param   n     Number of samples accumulated so far
+ *
+ * Since the confidence interval shrinks with the square root of the number
+ * of samples, this is estimated from the ratio of the tolerance reached to
+ * the tolerance required.
+ *
+ * \note While there is no error event the remaining work cannot be
+ * estimated; in this case the sample count is assumed to need tripling.
+ */
+double montecarlo::get_remaining(double acc, libbase::int64u n) const
+   {
+   double remaining;
+   if (acc < std::numeric_limits<double>::max())
+      remaining = n * ((acc / accuracy) * (acc / accuracy) - 1);
+   else
+      remaining = 2.0 * n;
+   if (n < min_samples)
+      remaining = std::max(remaining, double(min_samples - n));
+   return std::max(remaining, 0.0);
+   }
+
+/*!
+ * \brief Determine the size of the next work unit for slaves
+ * \param   remaining  Number of samples still needed for convergence
+ * \param   rate       Measured throughput, in samples/sec across the cluster
+ * \param[out] worktime  Wall time the slave should work for
+ * \param[out] interval  Wall time between partial results from the slave
+ *
+ * A work unit is set to a quarter of the time expected to remain, so that
+ * work units are long while far from convergence (reducing the load on the
+ * master) and become short as convergence approaches (reducing the samples
+ * computed in excess). Partial results are streamed at a tenth of the work
+ * unit, to keep the convergence check reasonably fine-grained.
+ *
+ * \note Until the throughput is known work units default to the shortest
+ * size.
+ */
+void montecarlo::get_workunit(double remaining, double rate,
+      double& worktime, double& interval)
+   {
+   // limits on work unit size and update interval
+   const double min_worktime = 0.5;
+   const double max_worktime = 60;
+   const double max_interval = 5;
+   // determine the wall time needed, and the corresponding work unit size
+   worktime = min_worktime;
+   if (rate > 0)
+      worktime = std::max(min_worktime, std::min(max_worktime, remaining
+            / rate / 4));
+   interval = std::max(min_worktime, std::min(max_interval, worktime / 10));
+   }
+
+/*!
+ * \brief Assign a work unit to the given slave
+ * \param   s          Slave to be given work
+ * \param   worktime   Wall time the slave should work for
+ * \param   interval   Wall time between partial results from the slave
+ * \return  True if the work unit was sent successfully
+ *
+ * Along with its size, the work unit carries the key from which the slave
+ * seeds its system: the run seed, the slave's stream number (allocated
+ * when the slave is first given work), and a new work unit number.
+ */
+bool montecarlo::assignwork(slave *s, double worktime, double interval)
+   {
+   std::map<slave *, libbase::int32u>::iterator i = slave_stream.find(s);
+   if (i == slave_stream.end())
+      i = slave_stream.insert(std::make_pair(s, libbase::int32u(
+            slave_stream.size() + 1))).first;
+   const libbase::int32u unit = units++;
+   return call(s, "slave_work") && send(s, worktime) && send(s, interval)
+         && send(s, int(seed)) && send(s, int(i->second)) && send(s, int(unit));
+   }
+
 /*!
  * \brief Get idle slaves to work if we're not yet done
  * \param   converged  True if results have already converged
+ * \param   acc        Largest tolerance currently reached
  * 
  * If there are any slaves in the IDLE state, ask them to start working. We ask *all* IDLE
  * slaves to work, as long as the results have not yet converged. Therefore, this happens
@@ -422,17 +638,25 @@ void montecarlo::initnewslaves(std::string systemstring)
  * be discarded during the next turn. This method avoids the master hanging up waiting for
  * results from slaves that will never come (happens if the machine is locked up but the
  * TCP/IP stack is still running).
+ *
+ * The size of each work unit is determined by get_workunit(), based on the
+ * throughput measured so far in this estimate.
  */
-void montecarlo::workidleslaves(bool converged)
+void montecarlo::workidleslaves(bool converged, double acc)
    {
+   const double elapsed = t.elapsed();
+   const double rate = (elapsed > 0) ? slave_samplecount / elapsed : 0;
+   double worktime, interval;
+   get_workunit(get_remaining(acc, system->get_samplecount()), rate,
+         worktime, interval);
    for (slave *s; (!converged) && (s = idleslave());)
       {
       trace << "DEBUG (estimate): Idle slave found (" << s
             << "), assigning work." << std::endl;
-      if (!call(s, "slave_work"))
+      if (!assignwork(s, worktime, interval))
          continue;
-      trace << "DEBUG (estimate): Slave (" << s << ") work assigned ok."
-            << std::endl;
+      trace << "DEBUG (estimate): Slave (" << s << ") work assigned ok ("
+            << worktime << "s)." << std::endl;
       }
    }
 
@@ -443,9 +667,18 @@ void montecarlo::workidleslaves(bool converged)
  * If there are any slaves in the EVENT_PENDING state, read their results. Values
  * returned are accumulated into the running totals.
  * 
+ * Slaves return partial results during a work unit; after reading these,
+ * the slave is put back in the working state, since it has not yet
+ * concluded its work unit.
+ *
  * If any slave returns a result that does not correspond to the same system
- * or parameter that are now being simulated, this is discarded and the slave
- * is marked as 'new'.
+ * or parameter that are now being simulated, this is discarded; once the
+ * slave concludes its work unit, it is marked as 'new'. During a parameter
+ * sweep, results are accumulated into the point they correspond to, and the
+ * wall time since the slave's last assignment or report is added to the
+ * point's cost. Results for a point that is no longer active (ie. that has
+ * converged or been abandoned) are also discarded, but since the slave is
+ * still set up for this system, it is simply left idle.
  */
 bool montecarlo::readpendingslaves()
    {
@@ -457,7 +690,9 @@ bool montecarlo::readpendingslaves()
       // get digest and parameter for simulated system
       std::string simdigest;
       double simparameter;
-      if (!receive(s, simdigest) || !receive(s, simparameter))
+      int last;
+      if (!receive(s, simdigest) || !receive(s, simparameter) || !receive(s,
+            last))
          continue;
       // set up space for results that need to be returned
       libbase::int64u estsamplecount = 0;
@@ -465,19 +700,58 @@ bool montecarlo::readpendingslaves()
       // get results
       if (!receive(s, estsamplecount) || !receive(s, eststate))
          continue;
+      // determine the slave time spent on these results
+      double elapsed = 0;
+      if (!points.empty())
+         {
+         const double now = t.elapsed();
+         elapsed = now - slave_since[s];
+         slave_since[s] = now;
+         }
       // check that results correspond to system under simulation
-      if (std::string(sysdigest) != simdigest || simparameter
-            != system->get_parameter())
+      experiment *target = findsystem(simdigest, simparameter);
+      if (target == NULL && !points.empty() && std::string(sysdigest)
+            == simdigest)
+         {
+         trace << "DEBUG (sweep): Slave returned results for inactive point ("
+               << s << "), discarding." << std::endl;
+         if (last)
+            updatecputime(s);
+         else
+            keepworking(s);
+         continue;
+         }
+      if (target == NULL)
          {
          trace << "DEBUG (estimate): Slave returned invalid results (" << s
-               << "), re-initializing." << std::endl;
-         resetslave(s);
+               << ")";
+         if (last)
+            {
+            trace << ", re-initializing." << std::endl;
+            resetslave(s);
+            }
+         else
+            {
+            trace << ", discarding." << std::endl;
+            keepworking(s);
+            }
          continue;
          }
       // accumulate
-      system->accumulate_state(estsamplecount, eststate);
-      // update usage information and return flag
-      updatecputime(s);
+      target->accumulate_state(estsamplecount, eststate);
+      slave_samplecount += estsamplecount;
+      if (!points.empty())
+         {
+         sweeppoint& p = points[findpoint(simparameter)];
+         p.samplecount += estsamplecount;
+         p.worktime += elapsed;
+         p.pending = std::max(0.0, p.pending - estsamplecount);
+         }
+      // update usage information (only when slave is ready for it)
+      if (last)
+         updatecputime(s);
+      else
+         keepworking(s);
       results_available = true;
       trace << "DEBUG (estimate): Read from slave (" << s << ") succeeded."
             << std::endl;
@@ -485,6 +759,267 @@ bool montecarlo::readpendingslaves()
    return results_available;
    }
 
+/*!
+ * \brief Find the system into which given slave results should go
+ * \param   simdigest      Digest of the system simulated by the slave
+ * \param   simparameter   Parameter at which the slave simulated
+ * \return  The system to accumulate results into, or NULL if the results
+ *          do not correspond to anything now being simulated
+ */
+experiment *montecarlo::findsystem(const std::string& simdigest,
+      double simparameter)
+   {
+   if (std::string(sysdigest) != simdigest)
+      return NULL;
+   if (points.empty())
+      return (simparameter == system->get_parameter()) ? system : NULL;
+   const int k = findpoint(simparameter);
+   return (k < 0) ? NULL : points[k].system;
+   }
+
+/*!
+ * \brief Find the active sweep point at the given parameter
+ * \return  Index of the point, or -1 if there is no active point there
+ */
+int montecarlo::findpoint(double parameter) const
+   {
+   for (size_t k = 0; k < points.size(); k++)
+      if (points[k].active && points[k].system->get_parameter() == parameter)
+         return int(k);
+   return -1;
+   }
+
+/*!
+ * \brief Choose the sweep point to which the next work unit should go
+ * \return  Index of the point, or -1 if all points have converged
+ *
+ * The point chosen is the active one with the largest expected remaining
+ * work, in slave-seconds. This is determined from the number of samples
+ * still needed (less those expected from work already assigned) and the
+ * slave time spent per sample returned so far. Points for which no samples have
+ * been returned yet have unknown cost; these are given priority until they
+ * have some work assigned.
+ */
+int montecarlo::nextpoint() const
+   {
+   int best = -1;
+   double bestwork = -1;
+   for (size_t k = 0; k < points.size(); k++)
+      {
+      const sweeppoint& p = points[k];
+      if (!p.active)
+         continue;
+      double work;
+      if (p.samplecount == 0)
+         work = (p.pending > 0) ? 0 : std::numeric_limits<double>::max();
+      else
+         {
+         const double remaining = get_remaining(p.acc,
+               p.system->get_samplecount()) - p.pending;
+         work = std::max(remaining, 0.0) * p.worktime / p.samplecount;
+         }
+      if (work > bestwork)
+         {
+         best = int(k);
+         bestwork = work;
+         }
+      }
+   return best;
+   }
+
+/*!
+ * \brief Get idle slaves to work on the sweep points that need it most
+ *
+ * Each idle slave is given a work unit at the point chosen by nextpoint();
+ * if the slave was last used at a different point, it is first sent the
+ * new parameter value. The size of the work unit is determined by
+ * get_workunit(), based on the throughput measured for that point.
+ */
+void montecarlo::workidleslaves_sweep()
+   {
+   for (int k; (k = nextpoint()) >= 0;)
+      {
+      slave *s = idleslave();
+      if (s == NULL)
+         break;
+      sweeppoint& p = points[k];
+      trace << "DEBUG (sweep): Idle slave found (" << s
+            << "), assigning work at parameter " << p.system->get_parameter()
+            << "." << std::endl;
+      // set up slave at this point, if necessary
+      std::map<slave *, int>::iterator i = slave_point.find(s);
+      if (i == slave_point.end() || i->second != k)
+         {
+         if (!call(s, "slave_getparameter") || !send(s,
+               p.system->get_parameter()))
+            continue;
+         slave_point[s] = k;
+         }
+      // determine work unit size
+      const double cost = (p.samplecount > 0) ? p.worktime / p.samplecount
+            : 0;
+      const double rate = (cost > 0) ? getnumslaves() / cost : 0;
+      double worktime, interval;
+      get_workunit(get_remaining(p.acc, p.system->get_samplecount()), rate,
+            worktime, interval);
+      // assign work
+      if (!assignwork(s, worktime, interval))
+         continue;
+      slave_since[s] = t.elapsed();
+      if (cost > 0)
+         p.pending += worktime / cost;
+      else
+         p.pending += 1;
+      }
+   }
+
+/*!
+ * \brief Write the results for a sweep point to the results file
+ * \param   k           Index of the point
+ * \param   savestate   Flag to indicate whether the state is also written
+ *
+ * \note The results file must be set up before calling this method; it is
+ * left set up afterwards.
+ */
+void montecarlo::writepoint(int k, bool savestate)
+   {
+   experiment *const bound_system = system;
+   system = points[k].system;
+   vector<double> result, tolerance;
+   updateresults(result, tolerance);
+   writefinalresults(result, tolerance, savestate);
+   system = bound_system;
+   // set up the file again, ready for the next write
+   setupfile(false);
+   }
+
+/*!
+ * \brief Main loop for a local worker thread
+ * \param   worker   The worker's own copy of the system being simulated
+ *
+ * The worker samples its system in batches of about 100ms; at the end of
+ * each batch the accumulated state is added to the set waiting to be merged
+ * by the main thread, and the worker's accumulator is reset. The batch
+ * length is a compromise between locking overhead and the latency with which
+ * the worker notices a request to stop.
+ */
+void montecarlo::worker_process(experiment *worker)
+   {
+   vector<double> state;
+   while (true)
+      {
+      // Initialise running values
+      worker->reset();
+      // Sample for one batch (always at least one sample)
+      libbase::walltimer tbatch("montecarlo_worker");
+      do
+         {
+         vector<double> result;
+         worker->sample(result);
+         worker->accumulate(result);
+         } while (tbatch.elapsed() < 0.1);
+      tbatch.stop(); // to avoid expiry
+      // Post accumulated results for the main thread
+      worker->get_state(state);
+      boost::mutex::scoped_lock lock(worker_mutex);
+      if (worker_stop)
+         break;
+      if (worker_samplecount == 0)
+         worker_state = state;
+      else
+         worker_state += state;
+      worker_samplecount += worker->get_samplecount();
+      worker_event.notify_one();
+      }
+   }
+
+/*!
+ * \brief Start the local worker threads
+ * \param   systemstring   Serialized system description
+ * \param   workers        Group to hold the created threads
+ * \param   systems        List to hold the workers' system copies
+ *
+ * Each worker gets its own copy of the system, created from the serialized
+ * description in the same way as for slaves; this guarantees that no
+ * components are shared with the bound system or with other workers. All
+ * copies are created and seeded here, before any thread is started; each
+ * worker is seeded from its own stream, under the same work unit number.
+ */
+void montecarlo::startworkers(const std::string& systemstring,
+      boost::thread_group& workers, std::vector<experiment *>& systems)
+   {
+   assert(systems.empty());
+   worker_stop = false;
+   worker_samplecount = 0;
+   worker_state.init(0);
+   const libbase::int32u unit = units++;
+   for (int i = 0; i < threads; i++)
+      {
+      experiment *worker;
+      std::istringstream is(systemstring);
+      is >> worker;
+      worker->set_parameter(system->get_parameter());
+      seed_experiment(worker, seed, i, unit);
+      systems.push_back(worker);
+      }
+   cerr << "Key: " << seed << " [0-" << threads - 1 << "] " << unit
+         << std::endl;
+   for (int i = 0; i < threads; i++)
+      workers.create_thread(boost::bind(&montecarlo::worker_process, this,
+            systems[i]));
+   trace << "DEBUG (estimate): Started " << threads << " local workers."
+         << std::endl;
+   }
+
+/*!
+ * \brief Stop the local worker threads
+ * \param   workers        Group holding the running threads
+ * \param   systems        List holding the workers' system copies
+ *
+ * Workers stop at the end of their current batch; results from batches
+ * completing after this point are discarded.
+ */
+void montecarlo::stopworkers(boost::thread_group& workers,
+      std::vector<experiment *>& systems)
+   {
+      {
+      boost::mutex::scoped_lock lock(worker_mutex);
+      worker_stop = true;
+      }
+   workers.join_all();
+   for (size_t i = 0; i < systems.size(); i++)
+      delete systems[i];
+   systems.clear();
+   trace << "DEBUG (estimate): Stopped local workers." << std::endl;
+   }
+
+/*!
+ * \brief Read and accumulate results posted by local workers
+ * \return  True if any new results have been added, false otherwise
+ *
+ * Waits for a worker to post results, but not indefinitely, so that the
+ * main loop can still respond to user interrupts. Any results posted are
+ * accumulated into the running totals.
+ */
+bool montecarlo::readpendingworkers()
+   {
+   libbase::int64u samplecount;
+   vector<double> state;
+      {
+      boost::mutex::scoped_lock lock(worker_mutex);
+      if (worker_samplecount == 0)
+         worker_event.timed_wait(lock, boost::posix_time::milliseconds(500));
+      if (worker_samplecount == 0)
+         return false;
+      samplecount = worker_samplecount;
+      state = worker_state;
+      worker_samplecount = 0;
+      }
+   // accumulate
+   system->accumulate_state(samplecount, state);
+   return true;
+   }
+
 // Main process
 
 /*!
@@ -510,20 +1045,31 @@ void montecarlo::estimate(vector<double>& result, vector<double>& tolerance)
       setupfile();
 
    // Set up for master-slave system (if necessary)
-   // and seed the experiment
+   // and seed the experiment (or start the local workers)
+   boost::thread_group workers;
+   std::vector<experiment *> worker_systems;
    if (isenabled())
       {
       resetslaves();
       resetcputime();
+      slave_samplecount = 0;
+      cerr << "Seed: " << seed << std::endl;
       }
+   else if (threads > 1)
+      startworkers(systemstring, workers, worker_systems);
    else
-      seed_experiment();
+      {
+      const libbase::int32u unit = units++;
+      seed_experiment(system, seed, 0, unit);
+      cerr << "Key: " << seed << " 0 " << unit << std::endl;
+      }
 
    // Repeat the experiment until all the following are true:
    // 1) We have the accuracy we need
    // 2) We have enough samples for the accuracy to be meaningful
    // An interrupt from the user overrides everything...
    bool converged = false;
+   double acc = std::numeric_limits<double>::max();
    while (!converged)
       {
       bool results_available = false;
@@ -533,12 +1079,17 @@ void montecarlo::estimate(vector<double>& result, vector<double>& tolerance)
          // first initialize any new slaves
          initnewslaves(systemstring);
          // get idle slaves to work if we're not yet done
-         workidleslaves(converged);
+         workidleslaves(converged, acc);
          // wait for results, but not indefinitely - this allows user to break
          waitforevent(true, 0.5);
          // accumulate results from any pending slaves
          results_available = readpendingslaves();
          }
+      else if (threads > 1)
+         {
+         // wait for results, but not indefinitely - this allows user to break
+         results_available = readpendingworkers();
+         }
       else
          {
          sampleandaccumulate();
@@ -548,7 +1099,7 @@ void montecarlo::estimate(vector<double>& result, vector<double>& tolerance)
       if (results_available)
          {
          updateresults(result, tolerance);
-         const double acc = tolerance.max();
+         acc = tolerance.max();
          // check if we have reached the required accuracy
          if (acc <= accuracy && system->get_samplecount() >= min_samples)
             converged = true;
@@ -564,6 +1115,10 @@ void montecarlo::estimate(vector<double>& result, vector<double>& tolerance)
          break;
       }
 
+   // stop any local workers
+   if (threads > 1 && !isenabled())
+      stopworkers(workers, worker_systems);
+
    // write final results
    if (resultsfile::isinitialized())
       writefinalresults(result, tolerance, interrupt());
@@ -571,4 +1126,144 @@ void montecarlo::estimate(vector<double>& result, vector<double>& tolerance)
    t.stop();
    }
 
+/*!
+ * \brief Simulate the system at a set of parameter values concurrently
+ * \param   pset        Set of parameter values to simulate
+ * \param   min_error   Stop simulating further parameter values when a
+ *                      result falls below this threshold
+ *
+ * This requires the master-slave system; slaves are given work tagged with
+ * the parameter value, as chosen by nextpoint(). Each point is simulated
+ * with its own copy of the bound system, created from its serialization,
+ * until convergence to the given accuracy & confidence. The results for
+ * each point are written to the results file as soon as it converges (so
+ * that points may appear out of order). When a point converges with a
+ * result below 'min_error', all later points in the set are abandoned.
+ *
+ * \note Saved states for each point are reloaded at the start. Interim
+ * results and state for every point still being simulated are written on the
+ * usual 30-second timer (see writeinterim()), so that progress is kept if the
+ * sweep is killed. At the end, the results and state of any points that did
+ * not converge (because they were abandoned, or the sweep was interrupted)
+ * are written to the results file.
+ */
+void montecarlo::sweep(const vector<double>& pset, double min_error)
+   {
+   assertalways(isenabled());
+   assert(points.empty());
+   t.start();
+
+   // create string representation of system
+   std::string systemstring = get_systemstring();
+   // compute its digest
+   std::istringstream is(systemstring);
+   sysdigest.process(is);
+
+   // create a system copy for each point, and reload any saved state
+   experiment *const bound_system = system;
+   points.resize(pset.size());
+   for (int k = 0; k < pset.size(); k++)
+      {
+      sweeppoint& p = points[k];
+      std::istringstream is(systemstring);
+      is >> p.system;
+      p.system->set_parameter(pset(k));
+      p.system->reset();
+      p.samplecount = 0;
+      p.worktime = 0;
+      p.pending = 0;
+      p.acc = std::numeric_limits<double>::max();
+      p.active = true;
+      p.converged = false;
+      if (resultsfile::isinitialized())
+         {
+         system = p.system;
+         readstate();
+         system = bound_system;
+         }
+      }
+   if (resultsfile::isinitialized())
+      setupfile(false);
+
+   // Set up for master-slave system
+   resetslaves();
+   resetcputime();
+   slave_samplecount = 0;
+   slave_point.clear();
+   slave_since.clear();
+   cerr << "Seed: " << seed << std::endl;
+
+   // Repeat until all points have converged
+   // An interrupt from the user overrides everything...
+   while (nextpoint() >= 0)
+      {
+      // first initialize any new slaves
+      initnewslaves(systemstring);
+      // get idle slaves to work on the points that need it most
+      workidleslaves_sweep();
+      // wait for results, but not indefinitely - this allows user to break
+      waitforevent(true, 0.5);
+      // accumulate results from any pending slaves, and update statistics
+      if (readpendingslaves())
+         {
+         for (int k = 0; k < int(points.size()); k++)
+            {
+            sweeppoint& p = points[k];
+            if (!p.active || p.system->get_samplecount() == 0)
+               continue;
+            vector<double> result, tolerance;
+            system = p.system;
+            updateresults(result, tolerance);
+            p.acc = tolerance.max();
+            // check if we have reached the required accuracy
+            if (p.acc <= accuracy && system->get_samplecount() >= min_samples)
+               {
+               cerr << "Converged at parameter = " << system->get_parameter()
+                     << " with " << system->get_samplecount() << " samples"
+                     << std::endl;
+               system = bound_system;
+               p.active = false;
+               p.converged = true;
+               if (resultsfile::isinitialized())
+                  writepoint(k, false);
+               // abandon later points if this result is small enough
+               if (result.min() < min_error)
+                  for (int j = k + 1; j < int(points.size()); j++)
+                     points[j].active = false;
+               }
+            system = bound_system;
+            }
+         // save interim results and state of points still being simulated
+         if (resultsfile::isinitialized())
+            {
+            vector<double> result, tolerance;
+            writeinterimresults(result, tolerance);
+            }
+         // print something to inform the user of our progress
+         display();
+         }
+      // consider our work done if the user has interrupted the processing
+      // (note: this overrides everything)
+      if (interrupt())
+         break;
+      }
+
+   // write results and state for any unconverged points
+   for (int k = 0; k < int(points.size()); k++)
+      if (!points[k].converged && points[k].system->get_samplecount() > 0
+            && resultsfile::isinitialized())
+         writepoint(k, true);
+   if (resultsfile::isinitialized())
+      releasefile();
+
+   // clean up
+   for (size_t k = 0; k < points.size(); k++)
+      delete points[k].system;
+   points.clear();
+   slave_point.clear();
+   slave_since.clear();
+
+   t.stop();
+   }
+
 } // end namespace
@@ -33,6 +33,10 @@
 #include "masterslave.h"
 #include "resultsfile.h"
 
+#include <boost/thread.hpp>
+#include <vector>
+#include <map>
+
 namespace libcomm {
 
 /*!
@@ -43,6 +47,33 @@ namespace libcomm {
  * - $Revision: 5613 $
  * - $Date: 2011-06-29 17:57:30 +0100 (Wed, 29 Jun 2011) $
  * - $Author: jabriffa $
+ *
+ * \note When the master-slave system is not enabled, sampling can be spread
+ * over a number of local worker threads (see set_threads()). Each worker owns
+ * an independently-seeded copy of the bound system, samples in short batches,
+ * and posts its accumulated state for the main thread to merge into the
+ * bound system, much as is done with results returned by slaves.
+ *
+ * \note With the master-slave system, a set of parameter values may also be
+ * simulated at once (see sweep()). Each slave is given work at a specific
+ * parameter value, chosen as the unconverged point with the largest
+ * expected remaining work.
+ *
+ * \note Experiments are seeded deterministically from a run seed (see
+ * set_seed()), so that any frame can be reproduced later. Each seeding is
+ * identified by a key (seed, stream, unit), used to select an independent
+ * stream of a counter-based generator (see seed_experiment()). The stream
+ * is the slave number with the master-slave system, and the worker number
+ * (zero if serial) with local computation. The unit is a running count of
+ * work units assigned (or of estimates, with local computation). Slaves and
+ * local runs print the key in use, and the frames computed under a key can
+ * be replayed with ShowErrorEvent.
+ *
+ * \note When saving the simulation state, the results file only holds the
+ * system digest, parameter, and sample count; the state values themselves
+ * are kept in a binary checkpoint file alongside (see checkpointfile), with
+ * the same name as the results file and a '.ckpt' extension. States saved
+ * as text in results files by earlier versions can still be reloaded.
  */
 
 class montecarlo : public libbase::masterslave, private resultsfile {
@@ -62,6 +93,35 @@ class montecarlo : public libbase::masterslave, private resultsfile {
    libbase::walltimer t; //!< timer to keep track of running estimate
    mutable libbase::walltimer tupdate; //!< timer to keep track of display rate
    sha sysdigest; //!< digest of the currently-simulated system
+   libbase::int32u seed; //!< run seed, from which all experiments are seeded
+   libbase::int32u units; //!< number of seeding keys issued so far
+   libbase::int64u slave_samplecount; //!< samples returned by slaves in this estimate
+   // @}
+   /*! \name Parameter sweep */
+   //! State of a single point in a parameter sweep
+   struct sweeppoint {
+      experiment *system; //!< copy of system set at this parameter value
+      libbase::int64u samplecount; //!< samples returned by slaves
+      double worktime; //!< slave time spent on samples returned
+      double pending; //!< samples expected from work units not yet returned
+      double acc; //!< largest tolerance reached
+      bool active; //!< flag to indicate that the point is still simulated
+      bool converged; //!< flag to indicate that the point has converged
+   };
+   std::vector<sweeppoint> points; //!< points being swept (empty otherwise)
+   std::map<slave *, int> slave_point; //!< point each slave is set up for
+   std::map<slave *, double> slave_since; //!< time of each slave's last assignment or report
+   // @}
+   /*! \name Slave seeding */
+   std::map<slave *, libbase::int32u> slave_stream; //!< stream number of each slave
+   // @}
+   /*! \name Local worker threads */
+   int threads; //!< number of local worker threads (1 for serial sampling)
+   boost::mutex worker_mutex; //!< lock for the shared worker state below
+   boost::condition_variable worker_event; //!< signalled when a batch is posted
+   bool worker_stop; //!< flag to indicate that workers should stop
+   libbase::int64u worker_samplecount; //!< samples posted but not yet merged
+   libbase::vector<double> worker_state; //!< state posted but not yet merged
    // @}
    /*! \name Slave process functions & their functors */
    void slave_getcode(void);
@@ -74,7 +134,11 @@ class montecarlo : public libbase::masterslave, private resultsfile {
 private:
    /*! \name Helper functions */
    std::string get_systemstring();
-   void seed_experiment();
+   //! Filename for binary checkpoint file associated with results file
+   std::string get_checkpointname() const
+      {
+      return get_filename() + ".ckpt";
+      }
    void createfunctors(void);
    void destroyfunctors(void);
    // @}
@@ -84,8 +148,23 @@ private:
          libbase::vector<double>& tolerance) const;
    void initslave(slave *s, std::string systemstring);
    void initnewslaves(std::string systemstring);
-   void workidleslaves(bool converged);
+   double get_remaining(double acc, libbase::int64u n) const;
+   static void get_workunit(double remaining, double rate, double& worktime,
+         double& interval);
+   bool assignwork(slave *s, double worktime, double interval);
+   void workidleslaves(bool converged, double acc);
    bool readpendingslaves();
+   experiment *findsystem(const std::string& simdigest, double simparameter);
+   int findpoint(double parameter) const;
+   int nextpoint() const;
+   void workidleslaves_sweep();
+   void writepoint(int k, bool savestate);
+   void worker_process(experiment *worker);
+   void startworkers(const std::string& systemstring,
+         boost::thread_group& workers, std::vector<experiment *>& systems);
+   void stopworkers(boost::thread_group& workers,
+         std::vector<experiment *>& systems);
+   bool readpendingworkers();
    // @}
 protected:
    // System-specific file-handler functions
@@ -94,6 +173,9 @@ protected:
          libbase::vector<double>& tolerance) const;
    void writestate(std::ostream& sout) const;
    void lookforstate(std::istream& sin);
+   void discardstate() const;
+   void writeinterim(std::ostream& sout, libbase::vector<double>& result,
+         libbase::vector<double>& tolerance);
    /*! \name Overrideable user-interface functions */
    /*! \brief User-interrupt check
     * This function should return true if the user has requested an interrupt.
@@ -127,6 +209,10 @@ public:
    void set_confidence(double confidence);
    //! Set target accuracy, say, 0.10 => 10% of mean
    void set_accuracy(double accuracy);
+   //! Set number of local worker threads (only used with local computation)
+   void set_threads(int threads);
+   //! Set run seed, from which all experiments are seeded
+   void set_seed(libbase::int32u seed);
    //! Associates with given results file
    void set_resultsfile(const std::string& fname)
       {
@@ -142,6 +228,16 @@ public:
       {
       return accuracy;
       }
+   //! Get number of local worker threads
+   int get_threads() const
+      {
+      return threads;
+      }
+   //! Get run seed
+   libbase::int32u get_seed() const
+      {
+      return seed;
+      }
    // @}
    /*! \name Simulation results */
    //! Number of samples taken to produce the result
@@ -155,9 +251,14 @@ public:
       return t;
       }
    // @}
+   /*! \name Experiment seeding */
+   static void seed_experiment(experiment *system, libbase::int32u seed,
+         libbase::int32u stream, libbase::int32u unit);
+   // @}
    /*! \name Main process */
    void estimate(libbase::vector<double>& result,
          libbase::vector<double>& tolerance);
+   void sweep(const libbase::vector<double>& pset, double min_error = 0);
    // @}
 };
 
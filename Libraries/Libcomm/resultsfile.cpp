@@ -25,6 +25,7 @@
 #include "resultsfile.h"
 
 #include <fstream>
+#include <sstream>
 
 #ifdef WIN32
 #  include <io.h>
@@ -33,6 +34,7 @@
 #else
 #  include <unistd.h>
 #  include <sys/types.h>
+#  include <sys/stat.h>
 #endif
 
 namespace libcomm {
@@ -59,18 +61,50 @@ void resultsfile::writeheaderifneeded(std::fstream& file)
       }
    }
 
-/*! \brief Close and truncate the file, and update digest
+/*! \brief Replace the interim region with the given block
+ * The block is first appended to the file, as many times as necessary for a
+ * complete copy to lie beyond the space it will take at the write position.
+ * It is then written in place, replacing the previous interim region. This
+ * ensures that an interruption at any point leaves a complete copy of either
+ * the previous or the new block as the last one in the file.
+ *
+ * \note This method does not change the write position; the interim region
+ * size and digest are updated to correspond with the new block.
+ */
+void resultsfile::writeblock(std::fstream& file, const std::string& block)
+   {
+   const std::streamoff n = block.size();
+   if (tailsize > 0)
+      {
+      std::streampos pos = fileptr + tailsize;
+      do
+         {
+         file.seekp(pos);
+         file.write(block.data(), n);
+         pos += n;
+         } while (pos - n < fileptr + n);
+      file.flush();
+      }
+   file.seekp(fileptr);
+   file.write(block.data(), n);
+   file.flush();
+   assertalways(file.good());
+   // update interim region size and digest
+   tailsize = n;
+   std::istringstream sin(block);
+   taildigest.process(sin);
+   }
+
+/*! \brief Close and truncate the file, and update status
  * Truncation is needed to remove any detritus from previously-saved states.
  */
 void resultsfile::finishwithfile(std::fstream& file)
    {
-   std::streampos length = file.tellp();
    // close and truncate file
    file.close();
-   truncate(length);
-   // re-open and update digest
-   file.open(fname.c_str(), std::ios::in);
-   filedigest.process(file);
+   truncate(fileptr + tailsize);
+   // update file status
+   getfilestatus(filesize, filetime);
    }
 
 void resultsfile::truncate(std::streampos length)
@@ -86,17 +120,44 @@ void resultsfile::truncate(std::streampos length)
 #endif
    }
 
+void resultsfile::getfilestatus(std::streamoff& size, time_t& mtime) const
+   {
+   assert(!fname.empty());
+#ifdef WIN32
+   struct _stat st;
+   assertalways(_stat(fname.c_str(), &st)==0);
+#else
+   struct stat st;
+   assertalways(::stat(fname.c_str(), &st)==0);
+#endif
+   size = st.st_size;
+   mtime = st.st_mtime;
+   }
+
+/*! \brief Check for user modifications since the last update
+ * The file is considered unmodified if its size and modification time are
+ * unchanged, and the interim region matches the digest kept; only the
+ * interim region is read back from the file.
+ */
 void resultsfile::checkformodifications(std::fstream& file)
    {
    assert(file.good());
    trace << "DEBUG (resultsfile): checking file for modifications." << std::endl;
    // check for user modifications
-   sha curdigest;
-   file.seekg(0);
-   curdigest.process(file);
-   // reset file
-   file.clear();
-   if (curdigest == filedigest)
+   std::streamoff cursize;
+   time_t curtime;
+   getfilestatus(cursize, curtime);
+   bool modified = (cursize != filesize || curtime != filetime);
+   if (!modified && tailsize > 0)
+      {
+      sha curdigest;
+      file.seekg(fileptr);
+      curdigest.process(file);
+      // reset file
+      file.clear();
+      modified = (curdigest != taildigest);
+      }
+   if (!modified)
       file.seekp(fileptr);
    else
       {
@@ -104,6 +165,7 @@ void resultsfile::checkformodifications(std::fstream& file)
       // set current write position to end-of-file
       file.seekp(0, std::ios_base::end);
       fileptr = file.tellp();
+      tailsize = 0;
       }
    }
 
@@ -120,14 +182,17 @@ void resultsfile::init(const std::string& fname)
 // Results handling interface
 
 /*! \brief Set up the results file and look for a state
+ * \param findstate Flag to indicate whether to look for a saved state
+ *
  * If the file does not exist, a new one is created. Otherwise, the write
- * point is set to the end of file and a digest of the current file contents
- * is kept. A search for a saved state is also initiated by this method.
+ * point is set to the end of file and the current file status is kept. A
+ * search for a saved state is also initiated by this method, unless otherwise
+ * requested.
  *
  * \note The current simulation must be already set up at this point, so that
  * a valid comparison can be made.
  */
-void resultsfile::setupfile()
+void resultsfile::setupfile(bool findstate)
    {
    assert(!fname.empty());
    assert(!filesetup);
@@ -145,19 +210,37 @@ void resultsfile::setupfile()
       }
    assertalways(file.good());
    // look for saved-state
-   lookforstate(file);
-   // set write position at end
+   if (findstate)
+      lookforstate(file);
+   // set write position at end, with an empty interim region
+   file.clear();
    file.seekp(0, std::ios_base::end);
    fileptr = file.tellp();
-   // update digest
-   file.seekg(0);
-   filedigest.process(file);
+   tailsize = 0;
+   // update file status
+   file.close();
+   getfilestatus(filesize, filetime);
    // start timer for interim results writing
    t.start();
    // update flags
    filesetup = true;
    }
 
+/*! \brief Look for a saved state
+ * This can be used independently of the file setup, and does nothing if the
+ * file does not exist yet.
+ *
+ * \note The current simulation must be already set up at this point, so that
+ * a valid comparison can be made.
+ */
+void resultsfile::readstate()
+   {
+   assert(!fname.empty());
+   std::fstream file(fname.c_str(), std::ios::in);
+   if (file)
+      lookforstate(file);
+   }
+
 /*! \brief Write current results and state
  * This method can be called as many times as required; usually this is
  * called after every update. File writes are limited to occur no more often
@@ -179,8 +262,9 @@ void resultsfile::writeinterimresults(libbase::vector<double>& result,
    assertalways(file.good());
    checkformodifications(file);
    writeheaderifneeded(file);
-   writeresults(file, result, tolerance);
-   writestate(file);
+   std::ostringstream sout;
+   writeinterim(sout, result, tolerance);
+   writeblock(file, sout.str());
    finishwithfile(file);
    // restart timer
    t.start();
@@ -190,7 +274,7 @@ void resultsfile::writeinterimresults(libbase::vector<double>& result,
  * This method is called when the final result is reached. A file write is
  * guaranteed to occur. The write-limiting timer is also stopped to avoid
  * lapsing on object destruction. If requested, the final state is also
- * written.
+ * written; otherwise any saved state is discarded.
  *
  * \note This method also updates the write position so that this result is not
  * overwritten.
@@ -205,15 +289,33 @@ void resultsfile::writefinalresults(libbase::vector<double>& result,
    assertalways(file.good());
    checkformodifications(file);
    writeheaderifneeded(file);
-   writeresults(file, result, tolerance);
+   std::ostringstream sout;
+   writeresults(sout, result, tolerance);
    if (savestate)
-      writestate(file);
-   // update write-position
-   fileptr = file.tellp();
+      writestate(sout);
+   else
+      discardstate();
+   writeblock(file, sout.str());
+   // update write-position, leaving an empty interim region
+   fileptr += tailsize;
+   tailsize = 0;
    finishwithfile(file);
    // stop timer and clear setup flag (in preparation for next simulation run)
    t.stop();
    filesetup = false;
    }
 
+/*! \brief Release the results file without writing
+ * This is used when the file was set up but nothing further is to be written.
+ * Any interim region already written is left in place, as after an
+ * interruption.
+ */
+void resultsfile::releasefile()
+   {
+   assert(filesetup);
+   assert(t.isrunning());
+   t.stop();
+   filesetup = false;
+   }
+
 } // end namespace
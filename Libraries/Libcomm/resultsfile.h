@@ -30,6 +30,8 @@
 #include "walltimer.h"
 #include "sha.h"
 #include <iostream>
+#include <string>
+#include <ctime>
 
 namespace libcomm {
 
@@ -46,9 +48,18 @@ namespace libcomm {
  * and closes the file for every write, ensuring that written results are
  * flushed, and also allowing the user to manipulate the file between writes.
  *
- * The handler keeps track of the file digest between writes, checking for
- * any external changes. In such cases, the file is considered 'modified'
- * and the next write happens at the end of the file.
+ * The handler keeps track of the file size and modification time between
+ * writes, together with a digest of the interim region it last wrote (ie.
+ * the part of the file following the write position). Any external change to
+ * these means the file is considered 'modified', and the next write happens
+ * at the end of the file. This check only needs to read back the interim
+ * region, so that its cost does not depend on the size of the file.
+ *
+ * Each write is prepared in memory and committed so that the file always
+ * holds a complete copy of the last-saved state, even if the simulator is
+ * interrupted half-way through a write: when replacing an interim region, a
+ * copy of the new one is first appended beyond the space it will take, after
+ * which it is written in place and the file is truncated.
  *
  * The handler also allows 'interim' result writing. In this case, the result
  * is written together with the simulation state. This allows the user to
@@ -72,6 +83,14 @@ namespace libcomm {
  *       called after every update. The handler limits file writes to occur
  *       no more often than 30 seconds.
  *    d) writefinalresults() one last time; this is guaranteed to happen.
+ *       If the state is not saved here, discardstate() is called instead.
+ *
+ * When several simulations share the same results file (as in a parameter
+ * sweep), readstate() may be used to load the saved state for each one
+ * beforehand; the file is then set up without looking for a state, and
+ * writeinterimresults() saves all simulations in progress (through
+ * writeinterim()). After each writefinalresults() the file is set up again,
+ * and releasefile() is called once nothing more is to be written.
  */
 
 class resultsfile {
@@ -83,14 +102,19 @@ private:
    bool filesetup; //!< Flag to indicate that the results file was set up
    bool headerwritten; //!< Flag to indicate that the results header has been written
    std::streampos fileptr; //!< Position in file where we should write the next result
-   sha filedigest; //!< Digest of file as at last update
+   std::streamoff tailsize; //!< Size of interim region following the write position
+   std::streamoff filesize; //!< Size of file as at last update
+   time_t filetime; //!< Modification time of file as at last update
+   sha taildigest; //!< Digest of interim region as at last update
    libbase::walltimer t; //!< Timer to keep track of running estimate
    // @}
 private:
    /*! \name Results file helper functions */
    void writeheaderifneeded(std::fstream& file);
+   void writeblock(std::fstream& file, const std::string& block);
    void finishwithfile(std::fstream& file);
    void truncate(std::streampos length);
+   void getfilestatus(std::streamoff& size, time_t& mtime) const;
    void checkformodifications(std::fstream& file);
    // @}
 protected:
@@ -101,12 +125,33 @@ protected:
          libbase::vector<double>& tolerance) const = 0;
    virtual void writestate(std::ostream& sout) const = 0;
    virtual void lookforstate(std::istream& sin) = 0;
+   /*! \brief Discard any saved state
+    * Called when final results are written without the state, so that a later
+    * run does not reload samples from a completed simulation. Default action
+    * is to do nothing, for handlers that keep the state only in the results
+    * file (where it is overwritten by the final results).
+    */
+   virtual void discardstate() const
+      {
+      }
+   /*! \brief Write the contents of an interim region
+    * Default action is to write the results and state of the current
+    * simulation; handlers where several simulations share the results file
+    * may write all those still in progress instead.
+    */
+   virtual void writeinterim(std::ostream& sout,
+         libbase::vector<double>& result, libbase::vector<double>& tolerance)
+      {
+      writeresults(sout, result, tolerance);
+      writestate(sout);
+      }
    // @}
 public:
    /*! \name Constructor/destructor */
    // Constructor/destructor
    resultsfile() :
-      filesetup(false), headerwritten(false), t("resultsfile", false)
+      filesetup(false), headerwritten(false), tailsize(0), filesize(0),
+            filetime(0), t("resultsfile", false)
       {
       }
    virtual ~resultsfile()
@@ -127,14 +172,21 @@ public:
       {
       return !fname.empty();
       }
+   //! Get filename for associated results file
+   const std::string& get_filename() const
+      {
+      return fname;
+      }
    // @}
 
    /*! \name Results handling interface */
-   void setupfile();
+   void setupfile(bool findstate = true);
+   void readstate();
    void writeinterimresults(libbase::vector<double>& result, libbase::vector<
          double>& tolerance);
    void writefinalresults(libbase::vector<double>& result, libbase::vector<
          double>& tolerance, bool savestate = false);
+   void releasefile();
    // @}
 };
 
@@ -26,6 +26,7 @@
 #define __safe_bcjr_h
 
 #include "bcjr.h"
+#include "logfixed.h"
 
 namespace libcomm {
 
@@ -38,6 +39,10 @@ namespace libcomm {
  * - $Date: 2010-12-09 09:56:06 +0000 (Thu, 09 Dec 2010) $
  * - $Author: jabriffa $
  *
+ * Specializations below use the normalized algorithm for types that cannot
+ * hold the unnormalized metrics. For the fixed-point types, normalization
+ * keeps the metrics near the top of the representable range, as in a
+ * hardware decoder; without it they would soon saturate.
  */
 
 template <class real, class dbl = double>
@@ -138,6 +143,64 @@ public:
       }
 };
 
+/*!
+ * \brief   Safe version of BCJR - 16-bit fixed-point specialization
+ * (normalized).
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ */
+
+template <>
+class safe_bcjr<libbase::logfixed16, double> : public bcjr<libbase::logfixed16,
+      double, true> {
+protected:
+   // default constructor
+   safe_bcjr() :
+      bcjr<libbase::logfixed16, double, true> ()
+      {
+      }
+public:
+   // constructor & destructor
+   safe_bcjr(fsm& encoder, const int tau) :
+      bcjr<libbase::logfixed16, double, true> (encoder, tau)
+      {
+      }
+};
+
+/*!
+ * \brief   Safe version of BCJR - 8-bit fixed-point specialization
+ * (normalized).
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ */
+
+template <>
+class safe_bcjr<libbase::logfixed8, double> : public bcjr<libbase::logfixed8,
+      double, true> {
+protected:
+   // default constructor
+   safe_bcjr() :
+      bcjr<libbase::logfixed8, double, true> ()
+      {
+      }
+public:
+   // constructor & destructor
+   safe_bcjr(fsm& encoder, const int tau) :
+      bcjr<libbase::logfixed8, double, true> (encoder, tau)
+      {
+      }
+};
+
 } // end namespace
 
 #endif
@@ -33,6 +33,74 @@ namespace libcomm {
 #  define DEBUG 1
 #endif
 
+template <class GF_q, class real> sum_prod_alg_abstract<GF_q, real>::sum_prod_alg_abstract(
+      int n, int m, const array1vi_t& non_zero_col_pos,
+      const array1vi_t& non_zero_row_pos,
+      const libbase::matrix<GF_q>& pchk_matrix) :
+   length_n(n), dim_m(m)
+   {
+   //default values for clipping method
+   this->almostzero = real(1E-100);
+   this->clipping_method = 0;
+   //default update schedule
+   this->schedule_method = 0;
+
+   //number the edges row by row
+   this->check_start.init(m + 1);
+   this->num_edges = 0;
+   for (int loop_m = 0; loop_m < m; loop_m++)
+      {
+      this->check_start(loop_m) = this->num_edges;
+      this->num_edges += non_zero_row_pos(loop_m).size();
+      }
+   this->check_start(m) = this->num_edges;
+
+   //set up the check node side of the edge list
+   this->edge_var.init(this->num_edges);
+   this->edge_val.init(this->num_edges);
+   int pos = 0;
+   int edge = 0;
+   for (int loop_m = 0; loop_m < m; loop_m++)
+      {
+      const int non_zeros = non_zero_row_pos(loop_m).size();
+      for (int loop_n = 0; loop_n < non_zeros; loop_n++)
+         {
+         pos = non_zero_row_pos(loop_m)(loop_n) - 1;//we count from zero;
+         edge = this->check_start(loop_m) + loop_n;
+         this->edge_var(edge) = pos;
+         this->edge_val(edge) = pchk_matrix(loop_m, pos);
+         }
+      }
+
+   //set up the variable node side of the edge list
+   this->var_start.init(n + 1);
+   this->var_edges.init(this->num_edges);
+   int count = 0;
+   for (int loop_n = 0; loop_n < n; loop_n++)
+      {
+      this->var_start(loop_n) = count;
+      const int non_zeros = non_zero_col_pos(loop_n).size();
+      for (int loop_m = 0; loop_m < non_zeros; loop_m++)
+         {
+         pos = non_zero_col_pos(loop_n)(loop_m) - 1;//we count from zero;
+         //find the edge within check pos that connects to this variable
+         edge = this->check_start(pos);
+         while (edge < this->check_start(pos + 1) && this->edge_var(edge)
+               != loop_n)
+            edge++;
+         assertalways(edge < this->check_start(pos + 1));
+         this->var_edges(count++) = edge;
+         }
+      }
+   this->var_start(n) = count;
+   assertalways(count == this->num_edges);
+
+   //allocate the message arenas
+   const int num_of_elements = GF_q::elements();
+   this->q_mxn.init(this->num_edges * num_of_elements);
+   this->r_mxn.init(this->num_edges * num_of_elements);
+   }
+
 template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::spa_iteration(
       array1vd_t& ro)
    {
@@ -48,19 +116,20 @@ template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::spa_it
    // if the parity check is satisfied the conditional probability is 1 and 0 otherwise
    // so we are simply adding up the products for which the parity check is satisfied.
 
-   //the number of symbols in N_m, eg the number of variables that participate in check m
-   int size_N_m;
+   if (1 == this->schedule_method)
+      {
+      //layered schedule: one check row at a time
+      this->spa_layered_iteration();
+      //compute the new probabilities for all symbols given the information in this iteration.
+      this->compute_probs(ro);
+      return;
+      }
 
    //loop over all check nodes - the horizontal step
    for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
       {
-      // get the bits that participate in this check
-      size_N_m = this->N_m(loop_m).size();
-      for (int loop_n = 0; loop_n < size_N_m; loop_n++)
-         {
-         //this will compute the relevant r_nms fixing the x_n given by loop_n
-         this->compute_r_mn(loop_m, loop_n, this->N_m(loop_m));
-         }
+      //this will compute the relevant r_nms for the edges of this check
+      this->compute_r_m(loop_m);
       }
 
 #if DEBUG>=2
@@ -69,20 +138,15 @@ template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::spa_it
    this->print_marginal_probs(3, libbase::trace);
 #endif
 
-   //this array holds the checks that use symbol n
-   array1i_t M_n;
-   //the number of checks in that array
-   int size_M_n;
-
    //loop over all the bit nodes - the vertical step
 
    for (int loop_n = 0; loop_n < this->length_n; loop_n++)
       {
-      M_n = this->M_n(loop_n);
-      size_M_n = M_n.size().length();
-      for (int loop_m = 0; loop_m < size_M_n; loop_m++)
+      // go through the edges of this variable, ie the checks that use it
+      for (int loop_m = this->var_start(loop_n); loop_m < this->var_start(
+            loop_n + 1); loop_m++)
          {
-         this->compute_q_mn(loop_m, loop_n, M_n);
+         this->compute_q_mn(loop_n, this->var_edges(loop_m));
          }
       }
 #if DEBUG>=2
@@ -104,6 +168,27 @@ template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::spa_it
 
    }
 
+template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::spa_layered_iteration()
+   {
+   for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
+      {
+      //the vertical step for the variables in this check, using the
+      //latest r_mxn values from all other checks
+      for (int loop_e = this->check_start(loop_m); loop_e
+            < this->check_start(loop_m + 1); loop_e++)
+         {
+         this->compute_q_mn(this->edge_var(loop_e), loop_e);
+         }
+      //the horizontal step for this check
+      this->compute_r_m(loop_m);
+      }
+#if DEBUG>=2
+   libbase::trace
+   << "After the layered iteration, the marginal matrix at col x is given by:" << std::endl;
+   this->print_marginal_probs(3, libbase::trace);
+#endif
+   }
+
 template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::compute_probs(
       array1vd_t& ro)
    {
@@ -113,20 +198,21 @@ template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::comput
    //initialise some helper variables
    int num_of_elements = GF_q::elements();
    real a_n = real(0.0);
-   int size_of_M_n = 0;
-   int pos_m;
+   int base;
    for (int loop_n = 0; loop_n < this->length_n; loop_n++)
       {
       ro(loop_n) = this->received_probs(loop_n);
-      size_of_M_n = this->M_n(loop_n).size();
-      for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+      for (int loop_m = this->var_start(loop_n); loop_m < this->var_start(
+            loop_n + 1); loop_m++)
          {
-         for (int loop_m = 0; loop_m < size_of_M_n; loop_m++)
+         base = this->var_edges(loop_m) * num_of_elements;
+         for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
             {
-            pos_m = this->M_n(loop_n)(loop_m) - 1;//we count from 0
-            ro(loop_n)(loop_e) *= this->marginal_probs(pos_m, loop_n).r_mxn(
-                  loop_e);
+            ro(loop_n)(loop_e) *= this->r_mxn(base + loop_e);
             }
+         }
+      for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+         {
          //Use appropriate clipping method
          perform_clipping(ro(loop_n)(loop_e));
          }
@@ -143,149 +229,98 @@ template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::comput
 template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::print_marginal_probs(
       std::ostream& sout)
    {
-   int num_of_elements = GF_q::elements();
-   bool used;
    for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
       {
+      sout << std::endl << "row=" << loop_m + 1;
       sout << std::endl << "[";
-      for (int loop_n = 0; loop_n < this->length_n; loop_n++)
+      for (int loop_e = this->check_start(loop_m); loop_e
+            < this->check_start(loop_m + 1); loop_e++)
          {
-         sout << " <q=(";
-         used = this->marginal_probs(loop_m, loop_n).q_mxn.size() > 0;
-         if (used)
-            {
-            for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-               {
-               sout << this->marginal_probs(loop_m, loop_n).q_mxn(loop_e)
-                     << ", ";
-               }
-            sout << this->marginal_probs(loop_m, loop_n).q_mxn(num_of_elements
-                  - 1);
-            }
-         else
-            {
-            sout << " n/a ";
-            }
-         sout << "), q_conv=(";
-         if (used)
-            {
-            for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-               {
-               sout << this->marginal_probs(loop_m, loop_n).qmn_conv(loop_e)
-                     << ", ";
-               }
-            sout << this->marginal_probs(loop_m, loop_n).qmn_conv(
-                  num_of_elements - 1);
-            }
-         else
-            {
-            sout << " n/a ";
-            }
-         sout << "), r=(";
-         if (used)
-            {
-            for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-               {
-               sout << this->marginal_probs(loop_m, loop_n).r_mxn(loop_e)
-                     << ", ";
-               }
-            sout << this->marginal_probs(loop_m, loop_n).r_mxn(num_of_elements
-                  - 1);
-            }
-         else
-            {
-            sout << "n/a ";
-            }
-         sout << "), val=(";
-         if (used)
-            {
-            sout << this->marginal_probs(loop_m, loop_n).val;
-            }
-         else
-            {
-            sout << " n/a ";
-            }
-         sout << ")>";
+         this->print_edge(loop_e, sout);
          }
       sout << "]" << std::endl;
       }
    }
+
 template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::print_marginal_probs(
       int col, std::ostream& sout)
    {
-   int num_of_elements = GF_q::elements();
    int tmp_row;
-   int tmp_col;
+   int tmp_edge;
    sout << "only printing the necessary values for col=" << col;
    col--;//we count from 0
-   array1i_t tmp_N_m;
-   int num_of_elements_in_col = this->M_n(col).size();
-   int num_of_elements_in_row = 0;
 
-   for (int loop_m = 0; loop_m < num_of_elements_in_col; loop_m++)
+   for (int loop_m = this->var_start(col); loop_m < this->var_start(col + 1); loop_m++)
       {
-      tmp_row = this->M_n(col)(loop_m) - 1;
+      //find the row of this edge
+      tmp_edge = this->var_edges(loop_m);
+      tmp_row = 0;
+      while (this->check_start(tmp_row + 1) <= tmp_edge)
+         tmp_row++;
       sout << std::endl << "row=" << tmp_row + 1;
       sout << std::endl << "[";
-      tmp_N_m = this->N_m(tmp_row);
-      num_of_elements_in_row = tmp_N_m.size();
-      for (int loop_n = 0; loop_n < num_of_elements_in_row; loop_n++)
+      for (int loop_e = this->check_start(tmp_row); loop_e
+            < this->check_start(tmp_row + 1); loop_e++)
          {
-         tmp_col = tmp_N_m(loop_n) - 1;
-         sout << std::endl << " <q=(";
-         for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-            {
-            sout << this->marginal_probs(tmp_row, tmp_col).q_mxn(loop_e)
-                  << ", ";
-            }
-         sout << this->marginal_probs(tmp_row, tmp_col).q_mxn(num_of_elements
-               - 1);
-         bool used = this->marginal_probs(tmp_row, tmp_col).qmn_conv.size() > 0;
-         if (used)
-            {
-            sout << "),\n q_conv=(";
-            for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-               {
-               sout << this->marginal_probs(tmp_row, tmp_col).qmn_conv(loop_e)
-                     << ", ";
-               }
-            sout << this->marginal_probs(tmp_row, tmp_col).qmn_conv(
-                  num_of_elements - 1);
-            }
-         sout << "),\n r=(";
-
-         for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
-            {
-            sout << this->marginal_probs(tmp_row, tmp_col).r_mxn(loop_e)
-                  << ", ";
-            }
-         sout << this->marginal_probs(tmp_row, tmp_col).r_mxn(num_of_elements
-               - 1);
-
-         sout << "), val=(";
-
-         sout << this->marginal_probs(tmp_row, tmp_col).val;
-
-         sout << ")>";
+         this->print_edge(loop_e, sout);
          }
       sout << "]" << std::endl;
       }
    }
 
+template <class GF_q, class real> void sum_prod_alg_abstract<GF_q, real>::print_edge(
+      int edge, std::ostream& sout)
+   {
+   int num_of_elements = GF_q::elements();
+   int base = edge * num_of_elements;
+   sout << std::endl << " <col=" << this->edge_var(edge) + 1 << ", q=(";
+   for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
+      {
+      sout << this->q_mxn(base + loop_e) << ", ";
+      }
+   sout << this->q_mxn(base + num_of_elements - 1);
+   bool used = this->qmn_conv.size() > 0;
+   if (used)
+      {
+      sout << "),\n q_conv=(";
+      for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
+         {
+         sout << this->qmn_conv(base + loop_e) << ", ";
+         }
+      sout << this->qmn_conv(base + num_of_elements - 1);
+      }
+   sout << "),\n r=(";
+   for (int loop_e = 0; loop_e < num_of_elements - 1; loop_e++)
+      {
+      sout << this->r_mxn(base + loop_e) << ", ";
+      }
+   sout << this->r_mxn(base + num_of_elements - 1);
+   sout << "), val=(";
+   sout << this->edge_val(edge);
+   sout << ")>";
+   }
+
 }
 
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 namespace libcomm {
 using libbase::mpreal;
+using libbase::logfixed16;
+using libbase::logfixed8;
 using libbase::gf;
 
 template class sum_prod_alg_abstract<gf<1, 0x3> > ;
+template class sum_prod_alg_abstract<gf<1, 0x3> , logfixed16> ;
+template class sum_prod_alg_abstract<gf<1, 0x3> , logfixed8> ;
 template class sum_prod_alg_abstract<gf<2, 0x7> > ;
 template class sum_prod_alg_abstract<gf<3, 0xB> > ;
 template class sum_prod_alg_abstract<gf<3, 0xB> , mpreal> ;
 template class sum_prod_alg_abstract<gf<4, 0x13> > ;
 template class sum_prod_alg_abstract<gf<4, 0x13> , mpreal> ;
+template class sum_prod_alg_abstract<gf<4, 0x13> , logfixed16> ;
+template class sum_prod_alg_abstract<gf<4, 0x13> , logfixed8> ;
 template class sum_prod_alg_abstract<gf<5, 0x25> > ;
 template class sum_prod_alg_abstract<gf<6, 0x43> > ;
 template class sum_prod_alg_abstract<gf<7, 0x89> > ;
@@ -45,6 +45,21 @@ namespace libcomm {
  * using the distributive law and hence be computed much faster. The version
  * that is implemented here is based on Declercqs and Fossorier's 2006 paper:
  * Decoding Algorithms for Nonbinary LDPC Codes over GF(q)
+ *
+ * The Tanner graph is held as a compressed edge list, with one entry for each
+ * non-zero element of the parity check matrix. Edges are numbered row by row,
+ * so that the edges of each check node are contiguous; each variable node
+ * keeps a list of its edges. The q-ary messages along the edges are kept in
+ * contiguous arenas, with the message for edge e starting at position e*q.
+ * Memory requirements are therefore proportional to the number of non-zero
+ * entries, rather than to the size of the parity check matrix.
+ *
+ * Two update schedules are available. With flooding, each iteration updates
+ * all check nodes and then all variable nodes. With the layered (row-serial)
+ * schedule, each check row in turn first updates the messages from its
+ * variables, using the latest messages from all other checks, and then
+ * computes its own messages; new information is therefore used within the
+ * same iteration, which typically halves the number of iterations needed.
  */
 template <class GF_q, class real = double> class sum_prod_alg_abstract : public sum_prod_alg_inf<
       GF_q, real> {
@@ -58,33 +73,11 @@ public:
    // @}
 
    /*! \brief constructor
-    * initialise the main variables
+    * initialise the main variables and set up the edge list
     */
    sum_prod_alg_abstract(int n, int m, const array1vi_t& non_zero_col_pos,
          const array1vi_t& non_zero_row_pos,
-         const libbase::matrix<GF_q>& pchk_matrix) :
-      length_n(n), dim_m(m), M_n(non_zero_col_pos), N_m(non_zero_row_pos)
-      {
-      //default values for clipping method
-      this->almostzero = real(1E-100);
-      this->clipping_method = 0;
-
-      this->marginal_probs.init(m, n);
-
-      int non_zeros = 0;
-      int pos = 0;
-
-      for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
-         {
-         non_zeros = this->N_m(loop_m).size();
-         for (int loop_n = 0; loop_n < non_zeros; loop_n++)
-            {
-            pos = this->N_m(loop_m)(loop_n) - 1;//we count from zero;
-
-            this->marginal_probs(loop_m, pos).val = pchk_matrix(loop_m, pos);
-            }
-         }
-      }
+         const libbase::matrix<GF_q>& pchk_matrix);
    /*! \brief default destructor
     *
     */
@@ -102,6 +95,38 @@ public:
     */
    virtual std::string spa_type()=0;
 
+   /*! \brief set the order in which the nodes are updated
+    * (flooding or layered)
+    */
+   void set_schedule(std::string schedule_type)
+      {
+      if ("flooding" == schedule_type)
+         {
+         this->schedule_method = 0;
+         }
+      else if ("layered" == schedule_type)
+         {
+         this->schedule_method = 1;
+         }
+      else
+         {
+         std::string error_msg(schedule_type + " is not a valid SPA schedule");
+         failwith(error_msg.c_str());
+         }
+      }
+
+   /*!\brief returns the update schedule used
+    *
+    */
+   std::string get_schedule_type()
+      {
+      if (this->schedule_method == 1)
+         {
+         return "layered";
+         }
+      return "flooding";
+      }
+
    /*! \brief set the way the algorithm should deal with
     * clipping, ie replacing probabilities below a certain value
     */
@@ -175,18 +200,32 @@ public:
 
 protected:
    /*! \brief carries out the horizontal step of SPA
-    * The r_mxn probabilities are computed
+    * The r_mxn probabilities are computed for edge e of check node m
     */
-   virtual void compute_r_mn(int m, int n, const array1i_t & tmpN_m)=0;
+   virtual void compute_r_mn(int m, int e)=0;
+   /*! \brief carries out the horizontal step of SPA for all edges of check m
+    * By default this simply computes the r_mxn probabilities one edge at a
+    * time; implementations can override it to share the work between edges.
+    */
+   virtual void compute_r_m(int m)
+      {
+      for (int loop_e = this->check_start(m); loop_e < this->check_start(m
+            + 1); loop_e++)
+         {
+         this->compute_r_mn(m, loop_e);
+         }
+      }
    /*! \brief carried out the horizontal step of the SPA
-    * the q_mxn probabilities are computed
+    * the q_mxn probabilities are computed for edge e of variable node n
     */
-   virtual void compute_q_mn(int m, int n, const array1i_t & M_n)=0;
+   virtual void compute_q_mn(int n, int e)=0;
 
 private:
+   void spa_layered_iteration();
    void compute_probs(array1vd_t& ro);
    void print_marginal_probs(std::ostream& sout);
    void print_marginal_probs(int col, std::ostream& sout);
+   void print_edge(int edge, std::ostream& sout);
 
 protected:
 
@@ -198,31 +237,35 @@ protected:
     * for a proper definition of the following variables.
     */
 
-   //!this struct holds the probabilities that check m is satisfied if symbol n of the received word is
-   //fixed at symbols and the other symbols(<>n) have separable distributions given by q_mxn
-   struct marginals {
-      array1d_t q_mxn;
-      array1d_t qmn_conv;//! this holds the fast FFT transforms of the q_mxns
-      array1d_t r_mxn;
-      GF_q val; //this holds the non_zero entry at position (m,n)
-   };
-   // @}
-
    //the number of cols
    int length_n;
    //the number of rows
    int dim_m;
+   //the number of edges, ie the number of non-zero entries
+   int num_edges;
 
    array1vd_t received_probs;
 
-   //the positions of the non-zero entries per col
-   array1vi_t M_n;
-
-   //the positions of the non-zero entries per row
-   array1vi_t N_m;
-
-   //! this matrix holds the r_mxn probabilities
-   libbase::matrix<marginals> marginal_probs;
+   //! the edges of check m are check_start(m) to check_start(m+1)-1
+   array1i_t check_start;
+   //! the variable node (col, counting from zero) at each edge
+   array1i_t edge_var;
+   //! the edges of variable n are var_edges(var_start(n)) to
+   //! var_edges(var_start(n+1)-1)
+   array1i_t var_start;
+   //! the edge list of each variable node, in check order
+   array1i_t var_edges;
+   //! the non-zero entry of the parity check matrix at each edge
+   libbase::vector<GF_q> edge_val;
+
+   //! message arena holding the q_mxn probabilities for all edges
+   array1d_t q_mxn;
+   //! message arena holding the fast FFT transforms of the q_mxns
+   array1d_t qmn_conv;
+   //! message arena holding the probabilities that check m is satisfied if
+   //! symbol n is fixed and the other symbols have separable distributions
+   //! given by q_mxn
+   array1d_t r_mxn;
 
    //! the clipping method used
    // 0-replace 0 with almostzero
@@ -232,6 +275,11 @@ protected:
    //! this is the value we assign to zero probs
    real almostzero;
 
+   //! the update schedule used
+   // 0-flooding
+   // 1-layered
+   int schedule_method;
+
 };
 
 } // end namespace
@@ -25,6 +25,10 @@
 #include "sum_prod_alg_gdl.h"
 #include <cmath>
 
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
 namespace libcomm {
 
 // Determine debug level:
@@ -36,6 +40,183 @@ namespace libcomm {
 
 using libbase::gf;
 
+// Fast Hadamard transform kernels
+
+namespace {
+
+//! Number of elements in the field, as a compile-time constant
+template <class GF_q>
+struct field_size {
+};
+
+template <int m, int poly>
+struct field_size<gf<m, poly> > {
+   enum {
+      value = 1 << m
+   };
+};
+
+/*!
+ * \brief Butterfly stages h, 2h, .., q/2 of the Hadamard transform of size q
+ * Each stage combines the pairs of elements that are h apart; the stages are
+ * unrolled by template recursion.
+ */
+template <class real, int q, int h>
+struct fwht_stages {
+   static void apply(real* x)
+      {
+      for (int i = 0; i < q; i += 2 * h)
+         for (int j = i; j < i + h; j++)
+            {
+            const real tmp1 = x[j];
+            const real tmp2 = x[j + h];
+            x[j] = tmp1 + tmp2;
+            x[j + h] = tmp1 - tmp2;
+            }
+      fwht_stages<real, q, 2 * h>::apply(x);
+      }
+};
+
+template <class real, int q>
+struct fwht_stages<real, q, q> {
+   static void apply(real* x)
+      {
+      }
+};
+
+#if defined(__SSE2__)
+
+// SSE2 realization for double precision: one register holds two elements
+
+template <int q, int h>
+struct fwht_stages<double, q, h> {
+   static void apply(double* x)
+      {
+      for (int i = 0; i < q; i += 2 * h)
+         for (int j = i; j < i + h; j += 2)
+            {
+            const __m128d tmp1 = _mm_loadu_pd(x + j);
+            const __m128d tmp2 = _mm_loadu_pd(x + j + h);
+            _mm_storeu_pd(x + j, _mm_add_pd(tmp1, tmp2));
+            _mm_storeu_pd(x + j + h, _mm_sub_pd(tmp1, tmp2));
+            }
+      fwht_stages<double, q, 2 * h>::apply(x);
+      }
+};
+
+// first stage: the pair is within a register
+template <int q>
+struct fwht_stages<double, q, 1> {
+   static void apply(double* x)
+      {
+      const __m128d sign = _mm_set_pd(-1.0, 1.0);
+      for (int i = 0; i < q; i += 2)
+         {
+         const __m128d tmp = _mm_loadu_pd(x + i);
+         const __m128d tmp1 = _mm_unpacklo_pd(tmp, tmp);
+         const __m128d tmp2 = _mm_unpackhi_pd(tmp, tmp);
+         _mm_storeu_pd(x + i, _mm_add_pd(tmp1, _mm_mul_pd(tmp2, sign)));
+         }
+      fwht_stages<double, q, 2>::apply(x);
+      }
+};
+
+template <int q>
+struct fwht_stages<double, q, q> {
+   static void apply(double* x)
+      {
+      }
+};
+
+// GF(2) has a single stage, without anything to pair across registers
+template <>
+struct fwht_stages<double, 2, 1> {
+   static void apply(double* x)
+      {
+      const double tmp1 = x[0];
+      const double tmp2 = x[1];
+      x[0] = tmp1 + tmp2;
+      x[1] = tmp1 - tmp2;
+      }
+};
+
+#endif
+
+/*!
+ * \brief Hadamard transform of size q, in place
+ * Sizes up to 256 (ie up to GF(2^8)) are unrolled at compile time; larger
+ * sizes use a run-time loop over the stages.
+ */
+template <class real, int q, bool unrolled = (q <= 256)>
+struct fwht {
+   static void apply(real* x)
+      {
+      fwht_stages<real, q, 1>::apply(x);
+      }
+};
+
+template <class real, int q>
+struct fwht<real, q, false> {
+   static void apply(real* x)
+      {
+      for (int h = 1; h < q; h *= 2)
+         for (int i = 0; i < q; i += 2 * h)
+            for (int j = i; j < i + h; j++)
+               {
+               const real tmp1 = x[j];
+               const real tmp2 = x[j + h];
+               x[j] = tmp1 + tmp2;
+               x[j + h] = tmp1 - tmp2;
+               }
+      }
+};
+
+/*!
+ * \brief Forward-backward products of the transforms along a check
+ * For each edge of the check, this computes the product of the Fourier
+ * coefficients of all the other edges. The forward partial products are kept
+ * in conv_prod, with row i (of q elements) holding the product over the
+ * first i edges; the backward partial product uses the last row. The result
+ * for each edge overwrites its forward row, which is then no longer needed.
+ * The zero coefficient is always 1, as the distributions are normalised, and
+ * is not computed.
+ */
+template <class GF_q, class real>
+void forward_backward(const int first, const int last, const real* conv,
+      real* conv_prod)
+   {
+   const int q = field_size<GF_q>::value;
+   const int degree = last - first;
+   // forward pass: row i holds the product over edges first .. first+i-1
+   for (int loop2 = 1; loop2 < q; loop2++)
+      conv_prod[loop2] = real(1.0);
+   for (int loop1 = 1; loop1 < degree; loop1++)
+      {
+      const real* c = conv + (first + loop1 - 1) * q;
+      const real* f = conv_prod + (loop1 - 1) * q;
+      real* r = conv_prod + loop1 * q;
+      for (int loop2 = 1; loop2 < q; loop2++)
+         r[loop2] = f[loop2] * c[loop2];
+      }
+   // backward pass: the last row holds the product over edges after the
+   // current one
+   real* bwd = conv_prod + degree * q;
+   for (int loop2 = 1; loop2 < q; loop2++)
+      bwd[loop2] = real(1.0);
+   for (int loop1 = degree - 1; loop1 >= 0; loop1--)
+      {
+      const real* c = conv + (first + loop1) * q;
+      real* f = conv_prod + loop1 * q;
+      for (int loop2 = 1; loop2 < q; loop2++)
+         {
+         f[loop2] *= bwd[loop2];
+         bwd[loop2] *= c[loop2];
+         }
+      }
+   }
+
+} // end namespace
+
 template <class GF_q, class real>
 void sum_prod_alg_gdl<GF_q, real>::spa_init(const array1vd_t& recvd_probs)
    {
@@ -76,53 +257,38 @@ void sum_prod_alg_gdl<GF_q, real>::spa_init(const array1vd_t& recvd_probs)
 
    //some helper variables
    int pos = 0;
-   int non_zeros = 0;
+   int base = 0;
    int h_m_n = 0;
 
-   array1vd_t qmn_conv;
-
    //simply set q_mxn(0)=P_n(0)=P(x_n=0) and q_mxn(1)=P_n(1)=P(x_n=1)
-   for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
+   for (int loop_m = 0; loop_m < this->num_edges; loop_m++)
       {
-      non_zeros = this->N_m(loop_m).size();
-      for (int loop_n = 0; loop_n < non_zeros; loop_n++)
+      pos = this->edge_var(loop_m);
+      base = loop_m * num_of_elements;
+      h_m_n = this->edge_val(loop_m);
+      //In fact the probability we are given are not for the x_i but for
+      //the value h_m_n*xi hence all we need to do is copy the values into
+      //the array with a slightly amended index:
+      //probs(h_m_n*x)=received_prob(x) for all x in GF_q and 0!=h_m_n in GF_q.
+      // Declerq&Fossorier: Decoding Algs for non-binary LDPC Codes over GF(q)
+      // (when h_m_n=1 the permutation is the identity)
+      for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
          {
-         pos = this->N_m(loop_m)(loop_n) - 1;//we count from zero;
-         h_m_n = this-> marginal_probs(loop_m, pos).val;
-         this->marginal_probs(loop_m, pos).q_mxn = this->received_probs(pos);
-
-         // If h_m_n is not 1 we need to permute the probs.
-         if (1 != h_m_n)
-            {
-            //In fact the probability we are given are not for the x_i but for
-            //the value h_m_n*xi hence all we need to do is copy the values into
-            //the array with a slightly amended index:
-            //probs(h_m_n*x)=received_prob(x) for all x in GF_q and 0!=h_m_n in GF_q.
-            // Declerq&Fossorier: Decoding Algs for non-binary LDPC Codes over GF(q)
-            for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
-               {
-               //perms(h_m_n)(loop)=GF_q(h_m_n)*GF_q(loop) - a look-up is quicker than a
-               //computation (I hope)
-               this ->marginal_probs(loop_m, pos).qmn_conv(this->perms(h_m_n)(
-                     loop_e)) = this->received_probs(pos)(loop_e);
-               }
-            }
-         else
-            {
-            //no permutation needed as h_m_n=1
-            this->marginal_probs(loop_m, pos).qmn_conv = this->received_probs(
-                  pos);
-            }
-         this ->compute_convs(this ->marginal_probs(loop_m, pos).qmn_conv, 0,
-               num_of_elements - 1);
+         this->q_mxn(base + loop_e) = this->received_probs(pos)(loop_e);
+         //perms(h_m_n)(loop)=GF_q(h_m_n)*GF_q(loop) - a look-up is quicker than a
+         //computation (I hope)
+         this->qmn_conv(base + this->perms(h_m_n)(loop_e))
+               = this->received_probs(pos)(loop_e);
          }
-      this->marginal_probs(loop_m, pos).r_mxn = 0.0;
+      this->compute_convs(&this->qmn_conv(base));
       }
+   //start with uniform r_mxn values, as needed by the layered schedule
+   this->r_mxn = 1.0;
 
 #if DEBUG>=2
    libbase::trace << " Memory Usage:\n ";
-   libbase::trace << this->marginal_probs.size()
-   * sizeof(sum_prod_alg_abstract<GF_q,real>::marginals) / double(1 << 20)
+   libbase::trace << (this->q_mxn.size() + this->qmn_conv.size()
+         + this->r_mxn.size()) * sizeof(real) / double(1 << 20)
    << " MB" << std::endl;
 
    libbase::trace << std::endl << "The marginal matrix is given by:" << std::endl;
@@ -132,95 +298,34 @@ void sum_prod_alg_gdl<GF_q, real>::spa_init(const array1vd_t& recvd_probs)
    }
 
 template <class GF_q, class real>
-void sum_prod_alg_gdl<GF_q, real>::compute_convs(array1d_t & conv_out,
-      int pos1, int pos2)
+void sum_prod_alg_gdl<GF_q, real>::compute_convs(real* conv_out)
    {
    //this is in fact the Hadamard transform using the butterfly property of
    //the fast Fourier transform.
-   if ((pos2 - pos1) == 1)
-      {
-      real tmp1 = conv_out(pos1);
-      real tmp2 = conv_out(pos2);
-      conv_out(pos1) = tmp1 + tmp2;
-      conv_out(pos2) = tmp1 - tmp2;
-      }
-   else
-      {
-      int midpoint = pos1 + (pos2 - pos1 + 1) / 2;
-      this->compute_convs(conv_out, pos1, midpoint - 1);
-      this->compute_convs(conv_out, midpoint, pos2);
-      pos2 = midpoint;
-      for (int loop1 = pos1; loop1 < midpoint; loop1++)
-         {
-         real tmp1 = conv_out(loop1);
-         real tmp2 = conv_out(pos2);
-         conv_out(loop1) = tmp1 + tmp2;
-         conv_out(pos2) = tmp1 - tmp2;
-         pos2++;
-         }
-      }
+   fwht<real, field_size<GF_q>::value>::apply(conv_out);
    }
 
 //specialisation for GF(2)
 template <>
-void sum_prod_alg_gdl<gf<1, 0x3> , double>::compute_r_mn(int m, int n,
-      const array1i_t & tmpN_m)
+void sum_prod_alg_gdl<gf<1, 0x3> , double>::store_r_mn(int e)
    {
-   //the number of participating symbols
-   int num_of_var_syms = tmpN_m.size();
-
-   int pos_n = tmpN_m(n) - 1;//we count from 1;
-
-   int pos_n_dash;
-
-   double q_nm_conv_prod = 1.0;
-   for (int loop2 = 0; loop2 < num_of_var_syms; loop2++)
-      {
-      if (loop2 != n)
-         {
-         pos_n_dash = tmpN_m(loop2) - 1;//we count from zero
-         q_nm_conv_prod *= this->marginal_probs(m, pos_n_dash).qmn_conv(1);
-         }
-      }
-   this->marginal_probs(m, pos_n).r_mxn(0) = 0.5 * (1.0 + q_nm_conv_prod);
-   this->marginal_probs(m, pos_n).r_mxn(1) = 0.5 * (1.0 - q_nm_conv_prod);
-
+   const double q_nm_conv_prod = this->conv_tmp(1);
+   this->r_mxn(2 * e) = 0.5 * (1.0 + q_nm_conv_prod);
+   this->r_mxn(2 * e + 1) = 0.5 * (1.0 - q_nm_conv_prod);
    }
 
 template <class GF_q, class real>
-void sum_prod_alg_gdl<GF_q, real>::compute_r_mn(int m, int n,
-      const array1i_t & tmpN_m)
+void sum_prod_alg_gdl<GF_q, real>::store_r_mn(int e)
    {
-   //the number of participating symbols
-   int num_of_var_syms = tmpN_m.size();
    int num_of_elements = GF_q::elements();
 
-   int pos_n = tmpN_m(n) - 1;//we count from 1;
    //note the following should never be a division by zero!
-   int h_m_n = this->marginal_probs(m, pos_n).val;
-
-   int pos_n_dash;
-
-   array1d_t q_nm_conv_prod;
-   q_nm_conv_prod.init(num_of_elements);
-   q_nm_conv_prod = 1.0;
-   for (int loop2 = 1; loop2 < num_of_elements; loop2++)
-      {
-      for (int loop1 = 0; loop1 < num_of_var_syms; loop1++)
-         {
-         if (loop1 != n)
-            {
-            pos_n_dash = tmpN_m(loop1) - 1;//we count from zero
-
-            //this uses the FFT of the q_mxn to work out the r_mn
-            q_nm_conv_prod(loop2)
-                  *= this->marginal_probs(m, pos_n_dash).qmn_conv(loop2);
-            }
-         }
-      }
+   int h_m_n = this->edge_val(e);
 
    //apply the FFT again to get the proper values
-   this->compute_convs(q_nm_conv_prod, 0, num_of_elements - 1);
+   array1d_t& q_nm_conv_prod = this->conv_tmp;
+   q_nm_conv_prod(0) = real(1.0);
+   this->compute_convs(&q_nm_conv_prod(0));
 
    /*
     * ensure that the values in q_nm_conv_prod make sense, ie
@@ -232,7 +337,7 @@ void sum_prod_alg_gdl<GF_q, real>::compute_r_mn(int m, int n,
    for (int loop1 = 0; loop1 < num_of_elements; loop1++)
       {
       //Clipping HACK
-      perform_clipping(q_nm_conv_prod(loop1));
+      this->perform_clipping(q_nm_conv_prod(loop1));
       sum_qnm += q_nm_conv_prod(loop1);
       }
 
@@ -240,41 +345,81 @@ void sum_prod_alg_gdl<GF_q, real>::compute_r_mn(int m, int n,
    assertalways(sum_qnm != real(0.0));
    q_nm_conv_prod /= sum_qnm;
 
+   int base = e * num_of_elements;
    for (int loop1 = 0; loop1 < num_of_elements; loop1++)
       {
       //perms(h_m_n)(loop)=GF_q(h_m_n)*GF_q(loop) - a look-up is quicker than a
       //computation (I hope)
-      this ->marginal_probs(m, pos_n).r_mxn(loop1) = q_nm_conv_prod(
-            this->perms(h_m_n)(loop1));
+      this->r_mxn(base + loop1) = q_nm_conv_prod(this->perms(h_m_n)(loop1));
+      }
+   }
+
+template <class GF_q, class real>
+void sum_prod_alg_gdl<GF_q, real>::compute_r_mn(int m, int e)
+   {
+   int num_of_elements = GF_q::elements();
+
+   //this uses the FFT of the q_mxn to work out the r_mn
+   array1d_t& q_nm_conv_prod = this->conv_tmp;
+   q_nm_conv_prod = 1.0;
+   for (int loop1 = this->check_start(m); loop1 < this->check_start(m + 1); loop1++)
+      {
+      if (loop1 != e)
+         {
+         int base = loop1 * num_of_elements;
+         for (int loop2 = 1; loop2 < num_of_elements; loop2++)
+            {
+            q_nm_conv_prod(loop2) *= this->qmn_conv(base + loop2);
+            }
+         }
       }
+   this->store_r_mn(e);
    }
 
 template <class GF_q, class real>
-void sum_prod_alg_gdl<GF_q, real>::compute_q_mn(int m, int n,
-      const array1i_t & M_n)
+void sum_prod_alg_gdl<GF_q, real>::compute_r_m(int m)
+   {
+   int num_of_elements = GF_q::elements();
+   const int first = this->check_start(m);
+   const int last = this->check_start(m + 1);
+
+   //this uses the FFT of the q_mxn to work out the r_mn for all edges
+   real* conv_prod = &this->conv_prod(0);
+   forward_backward<GF_q> (first, last, &this->qmn_conv(0), conv_prod);
+
+   for (int loop_e = first; loop_e < last; loop_e++)
+      {
+      const real* r = conv_prod + (loop_e - first) * num_of_elements;
+      for (int loop2 = 1; loop2 < num_of_elements; loop2++)
+         this->conv_tmp(loop2) = r[loop2];
+      this->store_r_mn(loop_e);
+      }
+   }
+
+template <class GF_q, class real>
+void sum_prod_alg_gdl<GF_q, real>::compute_q_mn(int n, int e)
    {
    //initialise some helper variables
    int num_of_elements = GF_q::elements();
    array1d_t q_mn(this -> received_probs(n));
    real a_nxm = q_mn.sum();//sum up the values in q_mn
    assertalways(a_nxm!=real(0));
-   int m_dash = 0;
-   int pos_m = M_n(m) - 1;//we count from 1;
+   int base = 0;
 
    //compute q_mn(sym) = a_mxn * P_n(sym) * \prod_{m'\in M(n)\m} r_m'xn(0) for all sym in GF_q
-   int size_of_M_n = M_n.size().length();
-
-   for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+   for (int loop_m = this->var_start(n); loop_m < this->var_start(n + 1); loop_m++)
       {
-      for (int loop_m = 0; loop_m < size_of_M_n; loop_m++)
+      if (e != this->var_edges(loop_m))
          {
-         if (m != loop_m)
+         base = this->var_edges(loop_m) * num_of_elements;
+         for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
             {
-            m_dash = M_n(loop_m) - 1; //we start counting from zero
-
-            q_mn(loop_e) *= this->marginal_probs(m_dash, n).r_mxn(loop_e);
+            q_mn(loop_e) *= this->r_mxn(base + loop_e);
             }
          }
+      }
+   for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+      {
       //Clipping HACK
       perform_clipping(q_mn(loop_e));
       }
@@ -289,14 +434,14 @@ void sum_prod_alg_gdl<GF_q, real>::compute_q_mn(int m, int n,
       std::cerr << "received probs:" << q_mn;
       for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
          {
-         for (int loop_m = 0; loop_m < size_of_M_n; loop_m++)
+         for (int loop_m = this->var_start(n); loop_m < this->var_start(n + 1); loop_m++)
             {
-            if (m != loop_m)
+            if (e != this->var_edges(loop_m))
                {
-               m_dash = M_n(loop_m) - 1; //we start counting from zero
+               base = this->var_edges(loop_m) * num_of_elements;
                std::cerr << "q_mn(" << loop_e << ")=" << q_mn(loop_e) << " x "
-                     << this->marginal_probs(m_dash, n).r_mxn(loop_e) << std::endl;
-               q_mn(loop_e) *= this->marginal_probs(m_dash, n).r_mxn(loop_e);
+                     << this->r_mxn(base + loop_e) << std::endl;
+               q_mn(loop_e) *= this->r_mxn(base + loop_e);
                }
             }
          //Clipping HACK - just for error display purposes
@@ -326,33 +471,39 @@ void sum_prod_alg_gdl<GF_q, real>::compute_q_mn(int m, int n,
    assertalways(a_nxm!=real(0));
    q_mn /= a_nxm; //normalise
    //store the values
-   this->marginal_probs(pos_m, n).q_mxn = q_mn;
-   //compute the FFT and store it for the next iteration
-   int h_m_n = this->marginal_probs(pos_m, n).val;
+   base = e * num_of_elements;
+   int h_m_n = this->edge_val(e);
    for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
       {
+      this->q_mxn(base + loop_e) = q_mn(loop_e);
+      //compute the FFT and store it for the next iteration
       //perms(h_m_n)(loop)=GF_q(h_m_n)*GF_q(loop) - a look-up is quicker than a
       //computation (I hope)
-      this ->marginal_probs(pos_m, n).qmn_conv(this->perms(h_m_n)(loop_e))
-            = q_mn(loop_e);
+      this->qmn_conv(base + this->perms(h_m_n)(loop_e)) = q_mn(loop_e);
       }
-   this ->compute_convs(this ->marginal_probs(pos_m, n).qmn_conv, 0,
-         num_of_elements - 1);
+   this->compute_convs(&this->qmn_conv(base));
 
    }
 }
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 
 namespace libcomm {
 using libbase::mpreal;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 template class sum_prod_alg_gdl<gf<1, 0x3> > ;
+template class sum_prod_alg_gdl<gf<1, 0x3> , logfixed16> ;
+template class sum_prod_alg_gdl<gf<1, 0x3> , logfixed8> ;
 template class sum_prod_alg_gdl<gf<2, 0x7> > ;
 template class sum_prod_alg_gdl<gf<3, 0xB> > ;
 template class sum_prod_alg_gdl<gf<3, 0xB> , mpreal> ;
 template class sum_prod_alg_gdl<gf<4, 0x13> > ;
 template class sum_prod_alg_gdl<gf<4, 0x13> , mpreal> ;
+template class sum_prod_alg_gdl<gf<4, 0x13> , logfixed16> ;
+template class sum_prod_alg_gdl<gf<4, 0x13> , logfixed8> ;
 template class sum_prod_alg_gdl<gf<5, 0x25> > ;
 template class sum_prod_alg_gdl<gf<6, 0x43> > ;
 template class sum_prod_alg_gdl<gf<7, 0x89> > ;
@@ -27,9 +27,17 @@
 
 #include "sum_prod_alg_abstract.h"
 #include <string>
+#include <algorithm>
 
 namespace libcomm {
 
+/*! \brief Sum Product Algorithm using the generalised distributive law
+ * The check node update is carried out in the Fourier (Hadamard) domain,
+ * where the convolution of the incoming distributions becomes a pointwise
+ * product. All edges of a check are updated together, using forward and
+ * backward partial products, so that each check costs O(d q) products and
+ * d transforms of O(q log q), where d is the check degree.
+ */
 template <class GF_q, class real = double>
 class sum_prod_alg_gdl : public sum_prod_alg_abstract<GF_q, real> {
 public:
@@ -55,18 +63,8 @@ public:
             non_zero_col_pos, non_zero_row_pos, pchk_matrix)
       {
       int num_of_elements = GF_q::elements();
-      int non_zeros = 0;
       int pos = 0;
-      for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
-         {
-         non_zeros = this->N_m(loop_m).size();
-         for (int loop_n = 0; loop_n < non_zeros; loop_n++)
-            {
-            pos = this->N_m(loop_m)(loop_n) - 1;//we count from zero;
-            this->marginal_probs(loop_m, pos).qmn_conv.init(num_of_elements);
-            this->marginal_probs(loop_m, pos).r_mxn.init(num_of_elements);
-            }
-         }
+      this->qmn_conv.init(this->num_edges * num_of_elements);
 
       this->perms.init(num_of_elements);
       this->perms(0).init(num_of_elements);
@@ -82,42 +80,64 @@ public:
             pos++;
             }
          }
+
+      //scratch space for the partial products of the largest check
+      int max_degree = 0;
+      for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
+         {
+         max_degree = std::max(max_degree, this->check_start(loop_m + 1)
+               - this->check_start(loop_m));
+         }
+      this->conv_prod.init((max_degree + 1) * num_of_elements);
+      this->conv_tmp.init(num_of_elements);
       }
    virtual ~sum_prod_alg_gdl()
       {
       //nothing to do
       }
    void spa_init(const array1vd_t& ptable);
-   void compute_r_mn(int m, int n, const array1i_t & tmpN_m);
-   void compute_q_mn(int m, int n, const array1i_t & M_n);
+   void compute_r_mn(int m, int e);
+   void compute_r_m(int m);
+   void compute_q_mn(int n, int e);
    std::string spa_type()
       {
       return "gdl";
       }
 
-private:
    /*! \brief compute the Fast Hadamard transform
-    * This method will compute the Fast Fourier Transform of the
-    * elements passed in through conv_out. It does this recursively.
-    * Note the result is equivalent to the following matrix-vector
-    * multiplication:
-    * Let m be the size of conv_out, ie m=|GF_q|=power of 2
-    * Let H_m be the standard (mxm)-Hadamard matrix, ie
+    * This method will compute the Fast Fourier Transform of the q=|GF_q|
+    * elements starting at conv_out, in place. Note the result is equivalent
+    * to the following matrix-vector multiplication:
+    * Let H_q be the standard (qxq)-Hadamard matrix, ie
     * H_2k=H_2 "*" H_k where "*" is the Kronecker product of 2 matrices and
     *      [ 1   1 ]
     * H_2= [       ]
     *      [ 1  -1 ]
-    * then the result of this method is equal to H_m*conv_out^t where
+    * then the result of this method is equal to H_q*conv_out^t where
     * conv_out^t is the transpose of the conv_out vector
     *
+    * The transform is computed iteratively, one butterfly stage at a time;
+    * for fields up to GF(256) the stages are unrolled at compile time, and
+    * for double precision they are vectorised using SSE2 where available.
+    */
+   static void compute_convs(real* conv_out);
+
+private:
+   /*! \brief finish the horizontal step for edge e
+    * This takes the product of the other Fourier transforms in conv_tmp,
+    * transforms it back, normalises it and stores it as the r_mxn of edge e.
     */
-   void compute_convs(array1d_t & conv_out, int pos1, int pos2);
+   void store_r_mn(int e);
 
 private:
    /*! \brief this holds a look-up table of the finite field multiplication
     *
     */
    array1vi_t perms;
+   //! forward partial products of the transforms along a check
+   array1d_t conv_prod;
+   //! transform of the outgoing message for a single edge
+   array1d_t conv_tmp;
 
 };
 
@@ -68,26 +68,25 @@ void sum_prod_alg_trad<GF_q, real>::spa_init(const array1vd_t& recvd_probs)
 
    //some helper variables
    int pos = 0;
-   int non_zeros = 0;
+   int base = 0;
 
    //simply set q_mxn(0)=P_n(0)=P(x_n=0) and q_mxn(1)=P_n(1)=P(x_n=1)
-   for (int loop_m = 0; loop_m < this->dim_m; loop_m++)
+   for (int loop_m = 0; loop_m < this->num_edges; loop_m++)
       {
-      non_zeros = this->N_m(loop_m).size();
-      for (int loop_n = 0; loop_n < non_zeros; loop_n++)
+      pos = this->edge_var(loop_m);
+      base = loop_m * num_of_elements;
+      for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
          {
-         pos = this->N_m(loop_m)(loop_n) - 1;//we count from zero;
-         this->marginal_probs(loop_m, pos).q_mxn = this->received_probs(pos);
-         this->marginal_probs(loop_m, pos).r_mxn.init(num_of_elements);
-         this->marginal_probs(loop_m, pos).r_mxn = 0.0;
+         this->q_mxn(base + loop_e) = this->received_probs(pos)(loop_e);
          }
       }
+   //start with uniform r_mxn values, as needed by the layered schedule
+   this->r_mxn = 1.0;
 
 #if DEBUG>=2
    libbase::trace << " Memory Usage:\n ";
-   libbase::trace << this->marginal_probs.size()
-   * sizeof(sum_prod_alg_abstract<GF_q,real>::marginals) / double(1 << 20)
-   << " MB" << std::endl;
+   libbase::trace << (this->q_mxn.size() + this->r_mxn.size()) * sizeof(real)
+   / double(1 << 20) << " MB" << std::endl;
 
    libbase::trace << std::endl << "The marginal matrix is given by:" << std::endl;
    this->print_marginal_probs(libbase::trace);
@@ -96,28 +95,26 @@ void sum_prod_alg_trad<GF_q, real>::spa_init(const array1vd_t& recvd_probs)
    }
 
 template <class GF_q, class real>
-void sum_prod_alg_trad<GF_q, real>::compute_r_mn(int m, int n,
-      const array1i_t & tmpN_m)
+void sum_prod_alg_trad<GF_q, real>::compute_r_mn(int m, int e)
    {
    //the number of remaining symbols that can vary
-   int num_of_var_syms = tmpN_m.size() - 1;
+   int num_of_var_syms = this->check_start(m + 1) - this->check_start(m) - 1;
    int num_of_elements = GF_q::elements();
    //for each check node we need to consider num_of_elements^num_of_var_symbols cases
    int num_of_cases = int(pow(num_of_elements, num_of_var_syms));
-   int pos_n = tmpN_m(n) - 1;//we count from 1;
    int bitmask = num_of_elements - 1;
 
-   //only use the entries that are variable
-   array1i_t rel_N_m;
-   rel_N_m.init(num_of_var_syms);
-   int indx = 0;
+   //only use the edges that are variable
+   array1i_t rel_edges;
+   rel_edges.init(num_of_var_syms);
+   int indx = this->check_start(m);
    for (int loop = 0; loop < num_of_var_syms; loop++)
       {
-      if (indx == n)
+      if (indx == e)
          {
          indx++;
          }
-      rel_N_m(loop) = tmpN_m(indx);
+      rel_edges(loop) = indx;
       indx++;
       }
    //go through all cases - this will use bitwise manipulation
@@ -128,11 +125,15 @@ void sum_prod_alg_trad<GF_q, real>::compute_r_mn(int m, int n,
 
    int int_sym_val;
    int bits;
-   int pos_n_dash;
+   int edge_dash;
    real q_nm_prod = real(1.0);
 
-   this->marginal_probs(m, pos_n).r_mxn = 0.0;
-   GF_q check_value = this->marginal_probs(m, pos_n).val;
+   const int base = e * num_of_elements;
+   for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+      {
+      this->r_mxn(base + loop_e) = 0.0;
+      }
+   GF_q check_value = this->edge_val(e);
 
    for (int loop1 = 0; loop1 < num_of_cases; loop1++)
       {
@@ -142,7 +143,7 @@ void sum_prod_alg_trad<GF_q, real>::compute_r_mn(int m, int n,
       for (int loop2 = 0; loop2 < num_of_var_syms; loop2++)
          {
 
-         pos_n_dash = rel_N_m(loop2) - 1;//we count from zero
+         edge_dash = rel_edges(loop2);
 
          //extract int value of the first symbol
          int_sym_val = bits & bitmask;
@@ -150,43 +151,40 @@ void sum_prod_alg_trad<GF_q, real>::compute_r_mn(int m, int n,
          bits = bits >> GF_q::dimension();
 
          //the parity check symbol at this position
-         h_m_n_dash = this->marginal_probs(m, pos_n_dash).val;
+         h_m_n_dash = this->edge_val(edge_dash);
          //compute the value that at this check
          tmp_chk_val = h_m_n_dash * GF_q(int_sym_val);
 
          //add it to the syndrome
          syndrome_sym = syndrome_sym + tmp_chk_val;
          //look up the prob that the chk_val was actually sent
-         q_nm_prod *= this->marginal_probs(m, pos_n_dash).q_mxn(int_sym_val);
+         q_nm_prod *= this->q_mxn(edge_dash * num_of_elements + int_sym_val);
          }
       //adjust the appropriate rmn value
       int_sym_val = syndrome_sym / check_value;
-      this->marginal_probs(m, pos_n).r_mxn(int_sym_val) += q_nm_prod;
+      this->r_mxn(base + int_sym_val) += q_nm_prod;
       }
    }
 
 template <class GF_q, class real>
-void sum_prod_alg_trad<GF_q, real>::compute_q_mn(int m, int n,
-      const array1i_t & M_n)
+void sum_prod_alg_trad<GF_q, real>::compute_q_mn(int n, int e)
    {
 
    //initialise some helper variables
    int num_of_elements = GF_q::elements();
    array1d_t q_mn(this -> received_probs(n));
 
-   int m_dash = 0;
-   int pos_m = M_n(m) - 1;//we count from 1;
+   int base = 0;
 
    //compute q_mn(sym) = a_mxn * P_n(sym) * \prod_{m'\in M(n)\m} r_m'xn(0) for all sym in GF_q
-   int size_of_M_n = M_n.size().length();
-   for (int loop_m = 0; loop_m < size_of_M_n; loop_m++)
+   for (int loop_m = this->var_start(n); loop_m < this->var_start(n + 1); loop_m++)
       {
-      if (m != loop_m)
+      if (e != this->var_edges(loop_m))
          {
-         m_dash = M_n(loop_m) - 1; //we start counting from zero
+         base = this->var_edges(loop_m) * num_of_elements;
          for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
             {
-            q_mn(loop_e) *= this->marginal_probs(m_dash, n).r_mxn(loop_e);
+            q_mn(loop_e) *= this->r_mxn(base + loop_e);
             }
          }
       }
@@ -197,23 +195,34 @@ void sum_prod_alg_trad<GF_q, real>::compute_q_mn(int m, int n,
    q_mn /= a_nxm; //normalise
 
    //store the values
-   this->marginal_probs(pos_m, n).q_mxn = q_mn;
+   base = e * num_of_elements;
+   for (int loop_e = 0; loop_e < num_of_elements; loop_e++)
+      {
+      this->q_mxn(base + loop_e) = q_mn(loop_e);
+      }
    }
 
 }
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 
 namespace libcomm {
 using libbase::mpreal;
+using libbase::logfixed16;
+using libbase::logfixed8;
 using libbase::gf;
 
 template class sum_prod_alg_trad<gf<1, 0x3> > ;
+template class sum_prod_alg_trad<gf<1, 0x3> , logfixed16> ;
+template class sum_prod_alg_trad<gf<1, 0x3> , logfixed8> ;
 template class sum_prod_alg_trad<gf<2, 0x7> > ;
 template class sum_prod_alg_trad<gf<3, 0xB> > ;
 template class sum_prod_alg_trad<gf<3, 0xB> , mpreal> ;
 template class sum_prod_alg_trad<gf<4, 0x13> > ;
 template class sum_prod_alg_trad<gf<4, 0x13> , mpreal> ;
+template class sum_prod_alg_trad<gf<4, 0x13> , logfixed16> ;
+template class sum_prod_alg_trad<gf<4, 0x13> , logfixed8> ;
 template class sum_prod_alg_trad<gf<5, 0x25> > ;
 template class sum_prod_alg_trad<gf<6, 0x43> > ;
 template class sum_prod_alg_trad<gf<7, 0x89> > ;
@@ -50,8 +50,8 @@ public:
       //nothing to do
       }
    void spa_init(const array1vd_t& ptable);
-   void compute_r_mn(int m, int n, const array1i_t & tmpN_m);
-   void compute_q_mn(int m, int n, const array1i_t & M_n);
+   void compute_r_mn(int m, int e);
+   void compute_q_mn(int n, int e);
 
    std::string spa_type()
       {
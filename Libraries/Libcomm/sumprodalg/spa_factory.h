@@ -89,15 +89,20 @@ public:
 
 //Explicit realisations
 #include "mpreal.h"
+#include "logfixed.h"
 
 namespace libcomm {
 
 template class spa_factory<libbase::gf<1, 0x3> > ;
+template class spa_factory<libbase::gf<1, 0x3>, libbase::logfixed16> ;
+template class spa_factory<libbase::gf<1, 0x3>, libbase::logfixed8> ;
 template class spa_factory<libbase::gf<2, 0x7> > ;
 template class spa_factory<libbase::gf<3, 0xB> > ;
 template class spa_factory<libbase::gf<3, 0xB>, libbase::mpreal> ;
 template class spa_factory<libbase::gf<4, 0x13> > ;
 template class spa_factory<libbase::gf<4, 0x13>, libbase::mpreal> ;
+template class spa_factory<libbase::gf<4, 0x13>, libbase::logfixed16> ;
+template class spa_factory<libbase::gf<4, 0x13>, libbase::logfixed8> ;
 template class spa_factory<libbase::gf<5, 0x25> > ;
 template class spa_factory<libbase::gf<6, 0x43> > ;
 template class spa_factory<libbase::gf<7, 0x89> > ;
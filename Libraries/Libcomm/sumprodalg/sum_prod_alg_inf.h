@@ -80,6 +80,16 @@ public:
     *
     */
    virtual void perform_clipping(real& num)=0;
+
+   /*! \brief set the order in which the nodes are updated, ie
+    * flooding (all checks, then all variables) or layered (row by row)
+    */
+   virtual void set_schedule(std::string schedule_type)=0;
+
+   /*!\brief returns the update schedule used
+    *
+    */
+   virtual std::string get_schedule_type()=0;
 };
 
 }
@@ -0,0 +1,147 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "tempering_annealer.h"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace libcomm {
+
+// Constructors / Destructors
+
+/*!
+ * \brief Default constructor
+ * By default, there is one replica for each available processor core.
+ */
+tempering_annealer::tempering_annealer()
+   {
+   set_replicas(std::max(2, int(boost::thread::hardware_concurrency())));
+   }
+
+// Internal functions
+
+/*!
+ * \brief Iterations for one round, at the replica's temperature
+ * This is the same process as at each temperature step of the annealer.
+ */
+void tempering_annealer::work_replica(replica& x)
+   {
+   x.stat.reset();
+   x.E = x.system->energy();
+   int i, c;
+   for (i = 0, c = 0; i < min_iter && c < min_changes; i++)
+      {
+      double deltaE = x.system->perturb();
+      if (deltaE < 0 || x.r.fval_closed() < exp(-deltaE / x.T))
+         {
+         c++;
+         x.E += deltaE;
+         x.stat.insert(x.E);
+         }
+      else
+         x.system->unperturb();
+      }
+   x.iterations = i;
+   x.changes = c;
+   }
+
+// Setup functions
+
+void tempering_annealer::set_replicas(const int replicas)
+   {
+   assertalways(replicas >= 1);
+   tempering_annealer::replicas = replicas;
+   }
+
+// Main process
+
+void tempering_annealer::improve()
+   {
+   // set stderr to precision 4
+   int prec = std::clog.precision(4);
+
+   // set up replicas, in order of increasing temperature
+   std::vector<replica> x(replicas);
+   for (int k = 0; k < replicas; k++)
+      {
+      x[k].system = system->clone();
+      x[k].system->seedfrom(r);
+      x[k].r.seed(r.ival());
+      x[k].T = (replicas > 1) ? Tstop * pow(Tstart / Tstop, k / double(
+            replicas - 1)) : Tstop;
+      }
+   // 'best' holds a copy of the lowest-energy state found so far
+   anneal_system *best = system->clone();
+   double Ebest = best->energy();
+
+   int round = 0;
+   for (double T = Tstart; T > Tstop; T *= rate, round++)
+      {
+      // run an iteration round on all replicas, one per thread
+      boost::thread_group workers;
+      for (int k = 1; k < replicas; k++)
+         workers.create_thread(boost::bind(&tempering_annealer::work_replica,
+               this, boost::ref(x[k])));
+      work_replica(x[0]);
+      workers.join_all();
+      // keep the best state, and output some statistics for the user
+      for (int k = 0; k < replicas; k++)
+         {
+         if (x[k].E < Ebest)
+            {
+            Ebest = x[k].E;
+            best->copyfrom(*x[k].system);
+            }
+         display(x[k].T, 100 * double(x[k].changes) / double(x[k].iterations),
+               x[k].stat);
+         }
+      // offer state exchanges between neighbouring replicas
+      for (int k = round % 2; k + 1 < replicas; k += 2)
+         {
+         const double a = (1 / x[k].T - 1 / x[k + 1].T) * (x[k].E - x[k
+               + 1].E);
+         if (a >= 0 || r.fval_closed() < exp(a))
+            {
+            std::swap(x[k].system, x[k + 1].system);
+            std::swap(x[k].E, x[k + 1].E);
+            }
+         }
+      if (interrupt())
+         break;
+      }
+
+   // keep the best state found, and clean up
+   system->copyfrom(*best);
+   delete best;
+   for (int k = 0; k < replicas; k++)
+      delete x[k].system;
+
+   // revert stderr to original precision
+   std::clog.precision(prec);
+   }
+
+} // end namespace
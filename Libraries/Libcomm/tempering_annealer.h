@@ -0,0 +1,94 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __tempering_annealer_h
+#define __tempering_annealer_h
+
+#include "config.h"
+#include "annealer.h"
+#include <vector>
+
+namespace libcomm {
+
+/*!
+ * \brief   Parallel Tempering Annealing Algorithm.
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Runs a number of replicas of the attached system, each at a fixed
+ * temperature; the temperatures are spaced geometrically between the stop
+ * and start temperatures. Processing is done in rounds: in each round, every
+ * replica goes through the usual iterations at its own temperature, each on
+ * its own thread. Neighbouring replicas are then offered an exchange of
+ * states, which is accepted with probability min(1,exp((1/Ti-1/Tj)(Ei-Ej))),
+ * alternating between even and odd pairs on successive rounds.
+ *
+ * The number of rounds is the number of temperature steps in the annealing
+ * schedule, so that each replica does as much work as a single annealing run.
+ * The state with the lowest energy at the end of any round is kept, and is
+ * copied to the attached system when done.
+ *
+ * After each round, display() is called once for each replica, in order of
+ * increasing temperature, with its acceptance rate and energy statistics.
+ */
+
+class tempering_annealer : public annealer {
+private:
+   /*! \name Internal representation */
+   //! State and statistics for the replica at a given temperature
+   struct replica {
+      anneal_system *system; //!< System currently at this temperature
+      libbase::randgen r; //!< Generator for acceptance decisions
+      double T; //!< Temperature
+      double E; //!< Energy of current system
+      libbase::rvstatistics stat; //!< Energy statistics for last round
+      int iterations; //!< Number of iterations in last round
+      int changes; //!< Number of state changes in last round
+   };
+   int replicas; //!< Number of replicas
+   // @}
+private:
+   /*! \name Internal functions */
+   void work_replica(replica& x);
+   // @}
+public:
+   /*! \name Constructors / Destructors */
+   tempering_annealer();
+   // @}
+
+   /*! \name Setup functions */
+   void set_replicas(const int replicas);
+   // @}
+
+   // Main process
+   void improve();
+};
+
+} // end namespace
+
+#endif
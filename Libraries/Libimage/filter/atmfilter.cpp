@@ -23,7 +23,8 @@
  */
 
 #include "atmfilter.h"
-#include <list>
+#include "slidingwindow.h"
+#include <vector>
 #include <algorithm>
 #include <numeric>
 
@@ -40,46 +41,65 @@ void atmfilter<T>::init(const int d, const int alpha)
 
 // filter process loop (only updates output matrix)
 
+/*!
+ * \brief Filter process for rows [first,last]
+ * Progress is only shown if 'report' is set.
+ */
 template <class T>
-void atmfilter<T>::process(const libbase::matrix<T>& in,
-      libbase::matrix<T>& out) const
+void atmfilter<T>::process_part(const libbase::matrix<T>& in,
+      libbase::matrix<T>& out, const int first, const int last,
+      const bool report) const
    {
    const int M = in.size().rows();
    const int N = in.size().cols();
 
-   out.init(M, N);
-   using std::list;
-   list<T> lst;
+   // sorted list of neighbouring pixels
+   std::vector<T> lst;
+   lst.reserve((2 * m_d + 1) * (2 * m_d + 1));
 
-   for (int i = 0; i < M; i++)
+   for (int i = first; i <= last; i++)
       {
-      display_progress(i, M);
+      if (report)
+         display_progress(i - first, last - first + 1);
+      const int i1 = std::max(i - m_d, 0);
+      const int i2 = std::min(i + m_d, M - 1);
+      // create sorted list of neighbouring pixels for the first column
+      lst.clear();
+      for (int ii = i1; ii <= i2; ii++)
+         for (int jj = 0; jj <= std::min(m_d, N - 1); jj++)
+            lst.push_back(in(ii, jj));
+      std::sort(lst.begin(), lst.end());
       for (int j = 0; j < N; j++)
          {
-         // create list of neighbouring pixels
-         lst.clear();
-         for (int ii = std::max(i - m_d, 0); ii <= std::min(i + m_d, M - 1); ii++)
-            for (int jj = std::max(j - m_d, 0); jj <= std::min(j + m_d, N - 1); jj++)
-               lst.push_back(in(ii, jj));
-         // sort the list
-         lst.sort();
-         // erase the first and last alpha elements
-         typename list<T>::iterator p1 = lst.begin();
-         typename list<T>::iterator p2 = lst.end();
-         for (int k = 0; k < m_alpha; k++)
-            {
-            p1++;
-            p2--;
-            }
+         // update list with the columns leaving and entering neighbourhood
+         if (j > 0 && j - m_d - 1 >= 0)
+            for (int ii = i1; ii <= i2; ii++)
+               lst.erase(std::lower_bound(lst.begin(), lst.end(), in(ii, j
+                     - m_d - 1)));
+         if (j > 0 && j + m_d < N)
+            for (int ii = i1; ii <= i2; ii++)
+               {
+               const T x = in(ii, j + m_d);
+               lst.insert(std::upper_bound(lst.begin(), lst.end(), x), x);
+               }
          // compute the mean, skipping the first and last alpha elements
          const int n = lst.size() - 2 * m_alpha;
          T d = 0;
-         d = accumulate(p1, p2, d);
+         d = std::accumulate(lst.begin() + m_alpha, lst.end() - m_alpha, d);
          out(i, j) = d / n;
          }
       }
    }
 
+template <class T>
+void atmfilter<T>::process(const libbase::matrix<T>& in,
+      libbase::matrix<T>& out) const
+   {
+   out.init(in.size());
+   process_rows(in.size().rows(), boost::bind(&atmfilter<T>::process_part,
+         this, boost::cref(in), boost::ref(out), _1, _2, _3));
+   }
+
 // Explicit Realizations
 
 template class atmfilter<double> ;
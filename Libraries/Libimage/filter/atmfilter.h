@@ -39,6 +39,11 @@ namespace libimage {
  * - $Author: jabriffa $
  *
  * This filter computes the alpha-trimmed mean within a given neighbourhood.
+ *
+ * Rows are processed in parallel. Within each row, the neighbourhood is kept
+ * as a sorted window, updated by removing the column that leaves it and
+ * inserting the one that enters; the trimmed values are summed in increasing
+ * order, as before.
  */
 
 template <class T>
@@ -46,6 +51,9 @@ class atmfilter : public filter<T> {
 protected:
    int m_d; //!< greatest distance from current pixel in neighbourhood
    int m_alpha; //!< number of outliers to trim at each end before computing mean
+private:
+   void process_part(const libbase::matrix<T>& in, libbase::matrix<T>& out,
+         const int first, const int last, const bool report) const;
 public:
    atmfilter(const int d, const int alpha)
       {
@@ -23,6 +23,7 @@
  */
 
 #include "awfilter.h"
+#include "slidingwindow.h"
 
 namespace libimage {
 
@@ -53,6 +54,33 @@ void awfilter<T>::reset()
       rvglobal.reset();
    }
 
+/*!
+ * \brief Local variance for rows [offset+first,offset+last]
+ * Results are stored in rows [first,last] of 'var'.
+ */
+template <class T>
+void awfilter<T>::update_part(const libbase::matrix<T>& in,
+      libbase::matrix<double>& var, const int offset, const int first,
+      const int last) const
+   {
+   const int N = in.size().cols();
+
+   boxsum<T> b(in, m_d);
+   b.seek(offset + first);
+   for (int i = first; i <= last; i++)
+      {
+      if (i > first)
+         b.next();
+      for (int j = 0; j < N; j++)
+         var(i, j) = b.var(j);
+      }
+   }
+
+/*!
+ * \copydoc filter::update()
+ * Local variances are computed in parallel, a stripe of rows at a time; they
+ * are added to the global statistics in pixel order, as before.
+ */
 template <class T>
 void awfilter<T>::update(const libbase::matrix<T>& in)
    {
@@ -61,20 +89,21 @@ void awfilter<T>::update(const libbase::matrix<T>& in)
 
    const int M = in.size().rows();
    const int N = in.size().cols();
+   const int stripe = 256;
 
-   for (int i = 0; i < M; i++)
+   libbase::matrix<double> var;
+   for (int i = 0; i < M; i += stripe)
       {
       display_progress(i, M);
-      for (int j = 0; j < N; j++)
-         {
-         // compute mean and variance of neighbouring pixels
-         libbase::rvstatistics rv;
-         for (int ii = std::max(i - m_d, 0); ii <= std::min(i + m_d, M - 1); ii++)
-            for (int jj = std::max(j - m_d, 0); jj <= std::min(j + m_d, N - 1); jj++)
-               rv.insert(in(ii, jj));
-         // add to the global sum
-         rvglobal.insert(rv.var());
-         }
+      const int rows = std::min(stripe, M - i);
+      // compute variance of neighbouring pixels
+      var.init(rows, N);
+      process_rows(rows, boost::bind(&awfilter<T>::update_part, this,
+            boost::cref(in), boost::ref(var), i, _1, _2));
+      // add to the global sum
+      for (int ii = 0; ii < rows; ii++)
+         for (int j = 0; j < N; j++)
+            rvglobal.insert(var(ii, j));
       }
    }
 
@@ -90,26 +119,30 @@ void awfilter<T>::estimate()
 
 // filter process loop (only updates output matrix)
 
+/*!
+ * \brief Filter process for rows [first,last]
+ * Progress is only shown if 'report' is set.
+ */
 template <class T>
-void awfilter<T>::process(const libbase::matrix<T>& in, libbase::matrix<T>& out) const
+void awfilter<T>::process_part(const libbase::matrix<T>& in,
+      libbase::matrix<T>& out, const int first, const int last,
+      const bool report) const
    {
-   const int M = in.size().rows();
    const int N = in.size().cols();
 
-   out.init(M, N);
-
-   for (int i = 0; i < M; i++)
+   boxsum<T> b(in, m_d);
+   b.seek(first);
+   for (int i = first; i <= last; i++)
       {
-      display_progress(i, M);
+      if (report)
+         display_progress(i - first, last - first + 1);
+      if (i > first)
+         b.next();
       for (int j = 0; j < N; j++)
          {
          // compute mean and variance of neighbouring pixels
-         libbase::rvstatistics rv;
-         for (int ii = std::max(i - m_d, 0); ii <= std::min(i + m_d, M - 1); ii++)
-            for (int jj = std::max(j - m_d, 0); jj <= std::min(j + m_d, N - 1); jj++)
-               rv.insert(in(ii, jj));
-         const double mean = rv.mean();
-         const double var = rv.var();
+         const double mean = b.mean(j);
+         const double var = b.var(j);
          // compute result
          out(i, j) = T(mean + (std::max<double>(0, var - m_noise) / std::max<
                double>(var, m_noise)) * (in(i, j) - mean));
@@ -117,6 +150,14 @@ void awfilter<T>::process(const libbase::matrix<T>& in, libbase::matrix<T>& out)
       }
    }
 
+template <class T>
+void awfilter<T>::process(const libbase::matrix<T>& in, libbase::matrix<T>& out) const
+   {
+   out.init(in.size());
+   process_rows(in.size().rows(), boost::bind(&awfilter<T>::process_part,
+         this, boost::cref(in), boost::ref(out), _1, _2, _3));
+   }
+
 // Explicit Realizations
 
 template class awfilter<double> ;
@@ -45,6 +45,9 @@ namespace libimage {
  * variance itself - this is actually computed as the mean value of the image
  * local variance. This class allows this to be done by using the appropriate
  * constructor. The estimator function is also publicly available.
+ *
+ * Local means and variances are computed with sliding-window box sums, and
+ * rows are processed in parallel.
  */
 
 template <class T>
@@ -56,6 +59,11 @@ protected:
    double m_noise; //!< estimate of noise energy to remove
    // internal variables
    libbase::rvstatistics rvglobal;
+private:
+   void update_part(const libbase::matrix<T>& in, libbase::matrix<double>& var,
+         const int offset, const int first, const int last) const;
+   void process_part(const libbase::matrix<T>& in, libbase::matrix<T>& out,
+         const int first, const int last, const bool report) const;
 public:
    awfilter(const int d, const double noise)
       {
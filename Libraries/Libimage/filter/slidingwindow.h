@@ -0,0 +1,210 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#ifndef __slidingwindow_h
+#define __slidingwindow_h
+
+#include "config.h"
+#include "matrix.h"
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace libimage {
+
+/*!
+ * \brief   Accumulator type for window sums
+ * Sums of integer pixels are held exactly, as 64-bit integers; all others
+ * are held in double precision.
+ */
+
+template <class T>
+struct window_accumulator {
+   typedef double type;
+};
+
+template <>
+struct window_accumulator<int> {
+   typedef libbase::int64s type;
+};
+
+/*!
+ * \brief   Sliding-Window Box Sums
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ *
+ * Gives the number of pixels, their sum, and the sum of their squares, within
+ * the (2d+1)x(2d+1) neighbourhood of each pixel in a row of an image; the
+ * neighbourhood is clipped at the image edges. For the current row, column
+ * sums over the neighbourhood rows are kept, and the window sums are obtained
+ * by sliding along the row: each step adds the column sum that enters the
+ * window and subtracts the one that leaves, so that each window sum costs
+ * O(1). Moving to the next row updates the column sums with the row that
+ * enters and the row that leaves the neighbourhood. Unlike differences of
+ * running sums along the whole row, the magnitude of the accumulated sums
+ * stays that of a single window.
+ *
+ * Statistics are computed as in libbase::rvstatistics; for integer images the
+ * sums are exact, so the results are identical.
+ */
+
+template <class T>
+class boxsum {
+public:
+   typedef typename window_accumulator<T>::type A;
+private:
+   const libbase::matrix<T>& in; //!< Input image
+   int d; //!< Greatest distance from current pixel in neighbourhood
+   int M, N; //!< Image size
+   int i; //!< Current row
+   std::vector<A> c1, c2; //!< Column sums of values and squares
+   std::vector<A> w1, w2; //!< Window sums of values and squares
+private:
+   //! Adds row r to column sums, with the given sign
+   void addrow(const int r, const int sign)
+      {
+      for (int j = 0; j < N; j++)
+         {
+         const A x = A(in(r, j));
+         c1[j] += sign * x;
+         c2[j] += sign * x * x;
+         }
+      }
+   /*! \brief Works the window sums for the current row, sliding along it
+    * The leaving column is subtracted before the entering one is added, to
+    * keep the intermediate sums within the magnitude of a window.
+    */
+   void slide()
+      {
+      A s1 = 0, s2 = 0;
+      for (int j = 0; j < std::min(d, N); j++)
+         {
+         s1 += c1[j];
+         s2 += c2[j];
+         }
+      for (int j = 0; j < N; j++)
+         {
+         if (j - d - 1 >= 0)
+            {
+            s1 -= c1[j - d - 1];
+            s2 -= c2[j - d - 1];
+            }
+         if (j + d < N)
+            {
+            s1 += c1[j + d];
+            s2 += c2[j + d];
+            }
+         w1[j] = s1;
+         w2[j] = s2;
+         }
+      }
+public:
+   boxsum(const libbase::matrix<T>& in, const int d) :
+      in(in), d(d), M(in.size().rows()), N(in.size().cols()), i(-1), c1(N),
+            c2(N), w1(N), w2(N)
+      {
+      }
+   //! Sets up for row i, working the column sums directly
+   void seek(const int i)
+      {
+      this->i = i;
+      std::fill(c1.begin(), c1.end(), A(0));
+      std::fill(c2.begin(), c2.end(), A(0));
+      for (int r = std::max(i - d, 0); r <= std::min(i + d, M - 1); r++)
+         addrow(r, 1);
+      slide();
+      }
+   //! Moves on to the next row, updating the column sums
+   void next()
+      {
+      if (i - d >= 0)
+         addrow(i - d, -1);
+      i++;
+      if (i + d < M)
+         addrow(i + d, 1);
+      slide();
+      }
+   //! Number of pixels in neighbourhood of column j
+   int count(const int j) const
+      {
+      return (std::min(i + d, M - 1) - std::max(i - d, 0) + 1) * (std::min(j
+            + d, N - 1) - std::max(j - d, 0) + 1);
+      }
+   //! Sum of pixels in neighbourhood of column j
+   A sum(const int j) const
+      {
+      return w1[j];
+      }
+   //! Sum of squared pixels in neighbourhood of column j
+   A sumsq(const int j) const
+      {
+      return w2[j];
+      }
+   //! Mean of pixels in neighbourhood of column j
+   double mean(const int j) const
+      {
+      return double(sum(j)) / double(count(j));
+      }
+   //! Variance of pixels in neighbourhood of column j
+   double var(const int j) const
+      {
+      const double n = count(j);
+      const double _mean = double(sum(j)) / n;
+      const double _var = double(sumsq(j)) / n - _mean * _mean;
+      // avoid negative values due to FP resolution - return zero instead.
+      return (_var > 0) ? _var : 0;
+      }
+};
+
+/*!
+ * \brief Process image rows in parallel
+ * \param M Number of rows
+ * \param f Function object, called as f(first, last, report) for each part
+ *
+ * The rows are split into contiguous parts, one for each processor core,
+ * and each part is processed on its own thread. Only the part processed on
+ * the calling thread (which is the first) has the 'report' flag set; this
+ * is used to limit progress display to the calling thread.
+ */
+template <class F>
+void process_rows(const int M, F f)
+   {
+   const int threads = std::max(1, std::min(M,
+         int(boost::thread::hardware_concurrency())));
+   boost::thread_group workers;
+   for (int t = 1; t < threads; t++)
+      workers.create_thread(boost::bind<void>(f, int(libbase::int64s(M) * t
+            / threads), int(libbase::int64s(M) * (t + 1) / threads) - 1, false));
+   f(0, M / threads - 1, true);
+   workers.join_all();
+   }
+
+} // end namespace
+
+#endif
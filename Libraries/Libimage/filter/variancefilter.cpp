@@ -23,7 +23,7 @@
  */
 
 #include "variancefilter.h"
-#include "rvstatistics.h"
+#include "slidingwindow.h"
 
 namespace libimage {
 
@@ -38,24 +38,31 @@ void variancefilter<T>::init(const int d)
 // filter process loop (only updates output matrix)
 
 template <class T>
-void variancefilter<T>::process(const libbase::matrix<T>& in,
-      libbase::matrix<T>& out) const
+void variancefilter<T>::process_part(const libbase::matrix<T>& in,
+      libbase::matrix<T>& out, const int first, const int last) const
    {
-   const int M = in.size().rows();
    const int N = in.size().cols();
 
-   out.init(M, N);
-
-   for (int i = 0; i < M; i++)
+   boxsum<T> b(in, m_d);
+   b.seek(first);
+   for (int i = first; i <= last; i++)
+      {
+      if (i > first)
+         b.next();
+      // compute the variance of neighbouring pixels
       for (int j = 0; j < N; j++)
-         {
-         // compute the variance of neighbouring pixels
-         libbase::rvstatistics r;
-         for (int ii = std::max(i - m_d, 0); ii <= std::min(i + m_d, M - 1); ii++)
-            for (int jj = std::max(j - m_d, 0); jj <= std::min(j + m_d, N - 1); jj++)
-               r.insert(double(in(ii, jj)));
-         out(i, j) = T(r.var());
-         }
+         out(i, j) = T(b.var(j));
+      }
+   }
+
+template <class T>
+void variancefilter<T>::process(const libbase::matrix<T>& in,
+      libbase::matrix<T>& out) const
+   {
+   out.init(in.size());
+   process_rows(in.size().rows(), boost::bind(
+         &variancefilter<T>::process_part, this, boost::cref(in),
+         boost::ref(out), _1, _2));
    }
 
 // Explicit Realizations
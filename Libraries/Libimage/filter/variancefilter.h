@@ -36,6 +36,9 @@
 
  Version 1.20 (10 Nov 2006)
  * defined class and associated data within "libimage" namespace.
+
+ Version 1.30
+ * uses sliding-window box sums, with rows processed in parallel.
  */
 
 namespace libimage {
@@ -44,6 +47,9 @@ template <class T>
 class variancefilter : public filter<T> {
 protected:
    int m_d;
+private:
+   void process_part(const libbase::matrix<T>& in, libbase::matrix<T>& out,
+         const int first, const int last) const;
 public:
    variancefilter()
       {
@@ -23,11 +23,14 @@
  */
 
 #include "pacifier.h"
-#include "cputimer.h"
+#include "walltimer.h"
 #include "randgen.h"
 #include "truerand.h"
 
 #include <boost/program_options.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <sstream>
@@ -67,152 +70,251 @@ public:
       }
 };
 
-template <class T>
-class mylist;
-
-template <class T>
-class pair {
-public:
-   T value;
-   typename mylist<T>::iterator index;
-};
-
 /*!
- * \brief Container for S-Random interleaver creation
- * The base container must have the following abilities:
- * - removing an element from the middle with erase()
- * - return number of elements with size()
- * - return true when empty with empty()
- * This container has the following additional abilities:
- * - initializing with numerical sequence
- * - random-access iterator return
+ * \brief Set of candidate values for S-Random interleaver creation
+ * Holds the values [0,tau-1] in a segment tree, where each value carries a
+ * count of the reasons it may not be chosen: once for each value in the
+ * spread window that is too close to it, and a large count once it is used.
+ * The count is changed over a range of values in O(log tau) time, and the
+ * values with a zero count can be counted and indexed in the same time.
+ *
+ * Each node holds the pending change for its range, the smallest count in
+ * its range (including its own pending change), and the number of values in
+ * its range that have this smallest count.
  */
-template <class T>
-class mylist : public std::vector<T> {
+class candidates {
 private:
-   typedef std::vector<T> Base;
+   int tau; //!< Number of values
+   int size; //!< Number of leaves (a power of two, at least tau)
+   std::vector<int> add; //!< Change pending for node range
+   std::vector<int> low; //!< Smallest count in node range
+   std::vector<int> num; //!< Number of values with smallest count
+private:
+   void update(const int node)
+      {
+      const int l = 2 * node;
+      const int r = l + 1;
+      const int m = std::min(low[l], low[r]);
+      low[node] = add[node] + m;
+      num[node] = (low[l] == m ? num[l] : 0) + (low[r] == m ? num[r] : 0);
+      }
+   void change(const int node, const int lo, const int hi, const int first,
+         const int last, const int delta)
+      {
+      if (last < lo || first > hi)
+         return;
+      if (first <= lo && hi <= last)
+         {
+         add[node] += delta;
+         low[node] += delta;
+         return;
+         }
+      const int mid = (lo + hi) / 2;
+      change(2 * node, lo, mid, first, last, delta);
+      change(2 * node + 1, mid + 1, hi, first, last, delta);
+      update(node);
+      }
 public:
-   mylist(const int x = 0) :
-      Base(x)
+   /*! \brief Set up for values [0,tau-1], all unused and unrestricted
+    * Leaves beyond the last value are permanently excluded.
+    */
+   void init(const int tau)
       {
+      this->tau = tau;
+      for (size = 1; size < tau; size <<= 1)
+         ;
+      add.assign(2 * size, 0);
+      low.assign(2 * size, 0);
+      num.assign(2 * size, 0);
+      for (int i = 0; i < size; i++)
+         {
+         add[size + i] = low[size + i] = (i < tau) ? 0 : tau + 1;
+         num[size + i] = 1;
+         }
+      for (int node = size - 1; node >= 1; node--)
+         update(node);
       }
-   typename Base::iterator getiteratorat(const int x)
+   //! Changes the count for values [first,last] (clipped to range)
+   void change(const int first, const int last, const int delta)
       {
-      typename Base::iterator it = Base::begin();
-      for (int i = 0; i < x; i++)
-         it++;
-      return it;
+      change(1, 0, size - 1, std::max(first, 0), std::min(last, tau - 1),
+            delta);
       }
-   void sequence()
+   //! Number of values that may be chosen
+   int available() const
       {
-      typename Base::iterator it;
-      int i = 0;
-      for (it = Base::begin(); it != Base::end(); it++)
-         *it = i++;
+      return low[1] == 0 ? num[1] : 0;
       }
-   mylist<pair<T> > pairup()
+   //! Returns the k-th value (counting from zero) that may be chosen
+   int select(int k) const
       {
-      mylist<pair<T> > result(Base::size());
-      typename Base::iterator thisit;
-      typename mylist<pair<T> >::iterator pairit = result.begin();
-      for (thisit = Base::begin(); thisit != Base::end(); thisit++)
+      assert(k >= 0 && k < available());
+      int node = 1;
+      int offset = 0; // sum of pending changes above the current node
+      while (node < size)
          {
-         pairit->value = *thisit;
-         pairit->index = thisit;
-         pairit++;
+         offset += add[node];
+         const int l = 2 * node;
+         const int count = (low[l] + offset == 0) ? num[l] : 0;
+         if (k < count)
+            node = l;
+         else
+            {
+            k -= count;
+            node = l + 1;
+            }
          }
-      return result;
+      return node - size;
       }
 };
 
-//! Check if the last element inserted satisfies the spread criterion
-
-bool satisfiesspread(const myvector<int>& lut, const int n, const int i,
-      const int spread)
+/*!
+ * \brief Single attempt at creating an S-Random interleaver
+ * \return True if all entries were filled
+ *
+ * Each entry is chosen uniformly from the unused values that satisfy the
+ * spread criterion with the preceding 'spread' entries; the attempt fails
+ * when there are none. Values within 'spread' of an entry are excluded for
+ * the following 'spread' positions, so each entry costs O(log tau) time.
+ */
+bool attempt_srandom(myvector<int>& lut, const int tau, const int spread,
+      libbase::randgen& prng, candidates& values)
    {
-   for (int j = std::max(0, i - spread); j < i; j++)
-      if (abs(lut(j) - n) < spread)
+   values.init(tau);
+   for (int i = 0; i < tau; i++)
+      {
+      const int count = values.available();
+      if (count == 0)
          return false;
+      const int n = values.select(prng.ival(count));
+      lut(i) = n;
+      // mark as used, and exclude neighbours for the spread window
+      values.change(n, n, tau + 1);
+      values.change(n - spread + 1, n + spread - 1, 1);
+      // release neighbours of the entry that leaves the spread window
+      if (i >= spread)
+         {
+         const int m = lut(i - spread);
+         values.change(m - spread + 1, m + spread - 1, -1);
+         }
+      }
    return true;
    }
 
+/*!
+ * \brief State shared by worker threads during the search at a given spread
+ */
+class search {
+private:
+   boost::mutex mutex; //!< Lock for all members
+   libbase::pacifier p; //!< Progress reporter
+   int tau; //!< Interleaver length
+   int spread; //!< Spread under consideration
+   int max_attempts; //!< Number of attempts before giving up
+   int attempts; //!< Number of attempts started so far
+   bool found; //!< Flag indicating a solution was found
+public:
+   myvector<int> lut; //!< Solution, when found
+   libbase::int32u seed; //!< Seed used for the solution, when found
+private:
+   //! Claims the next attempt, returning false if no more are needed
+   bool next()
+      {
+      boost::mutex::scoped_lock lock(mutex);
+      if (found || attempts >= max_attempts)
+         return false;
+      std::cerr << p.update(attempts, max_attempts);
+      attempts++;
+      return true;
+      }
+   //! Records a solution, unless another worker got there first
+   void post(const myvector<int>& lut, const libbase::int32u seed)
+      {
+      boost::mutex::scoped_lock lock(mutex);
+      if (found)
+         return;
+      found = true;
+      this->lut = lut;
+      this->seed = seed;
+      }
+public:
+   search(const int tau, const int spread, const int max_attempts) :
+      tau(tau), spread(spread), max_attempts(max_attempts), attempts(0),
+            found(false)
+      {
+      }
+   /*! \brief Main loop for a worker thread
+    * Each attempt uses a fresh seed from the worker's own seed generator,
+    * so that a solution can be recreated from its seed alone.
+    */
+   void worker(libbase::int32u seeder_seed)
+      {
+      libbase::randgen seeder;
+      seeder.seed(seeder_seed);
+      libbase::randgen prng;
+      candidates values;
+      myvector<int> lut(tau);
+      while (next())
+         {
+         const libbase::int32u seed = seeder.ival();
+         prng.seed(seed);
+         if (attempt_srandom(lut, tau, spread, prng, values))
+            post(lut, seed);
+         }
+      }
+   //! Returns the string needed to clear the progress display
+   std::string stop()
+      {
+      return p.update(max_attempts, max_attempts);
+      }
+   //! Number of attempts made
+   int get_attempts() const
+      {
+      return attempts;
+      }
+   //! Flag indicating a solution was found
+   bool get_found() const
+      {
+      return found;
+      }
+};
+
 //! S-Random creation process
 
 myvector<int> create_srandom(const int tau, int& spread, libbase::int32u& seed,
-      const int max_attempts)
+      const int max_attempts, const int threads)
    {
-   // set up time-keepers
-   libbase::pacifier p;
    // set up random-number generation
    libbase::truerand trng;
-   libbase::randgen seeder;
-   seeder.seed(trng.ival());
-   libbase::randgen prng;
-   // initialize space for results
-   myvector<int> lut(tau);
 
-   bool failed = true;
-   while (failed)
+   while (true)
       {
       std::cerr << "Searching for solution at spread " << spread << std::endl;
       // loop for a number of attempts at the given Spread, then
       // reduce and continue as necessary
-      libbase::cputimer tmain("Attempt timer");
-      int attempt;
-      for (attempt = 0; attempt < max_attempts && failed; attempt++)
-         {
-         std::cerr << p.update(attempt, max_attempts);
-         // re-seed random generator
-         seed = seeder.ival();
-         prng.seed(seed);
-         // set up working variables
-         mylist<int> unused(tau);
-         unused.sequence();
-         // loop to fill all entries in the interleaver - or until we fail
-         failed = false;
-         for (int i = 0; i < tau && !failed; i++)
-            {
-            // set up for the current entry
-            mylist<pair<int> > untried = unused.pairup();
-            // loop for the current entry
-            // until we find a suitable value or totally fail trying
-            while (!failed)
-               {
-               // choose a random number from what's left to try
-               mylist<pair<int> >::iterator ndx = untried.getiteratorat(
-                     prng.ival(untried.size()));
-               const int n = ndx->value;
-               // if it's no good remove it from the list of options
-               if (!satisfiesspread(lut, n, i, spread))
-                  {
-                  untried.erase(ndx);
-                  failed = untried.empty();
-                  continue;
-                  }
-               // if it's a suitable value, insert & mark as used
-               else
-                  {
-                  unused.erase(ndx->index);
-                  lut(i) = n;
-                  break;
-                  }
-               }
-            }
-         }
+      libbase::walltimer tmain("Attempt timer");
+      search s(tau, spread, max_attempts);
+      boost::thread_group workers;
+      for (int i = 1; i < threads; i++)
+         workers.create_thread(boost::bind(&search::worker, &s, trng.ival()));
+      s.worker(trng.ival());
+      workers.join_all();
+      std::cerr << s.stop();
       // show user how fast we're working
       tmain.stop();
-      std::cerr << "Attempts: " << attempt << " in " << tmain << std::endl;
-      std::cerr << "Speed: " << double(attempt) / tmain.elapsed()
+      std::cerr << "Attempts: " << s.get_attempts() << " in " << tmain
+            << std::endl;
+      std::cerr << "Speed: " << double(s.get_attempts()) / tmain.elapsed()
             << " attempts/sec" << std::endl;
-      // if this failed, prepare for the next attempt
-      if (failed)
-         spread--;
+      // if this succeeded, return the solution
+      if (s.get_found())
+         {
+         seed = s.seed;
+         return s.lut;
+         }
+      // otherwise prepare for the next attempt
+      spread--;
       }
-
-   // stop timers
-   std::cerr << p.update(max_attempts, max_attempts);
-
-   return lut;
    }
 
 //! Returns filename according to usual convention
@@ -249,7 +351,7 @@ void serialize_interleaver(std::ostream& sout, myvector<int> lut, int tau,
 
 int main(int argc, char *argv[])
    {
-   libbase::cputimer tmain("Main timer");
+   libbase::walltimer tmain("Main timer");
 
    // Set up user parameters
    namespace po = boost::program_options;
@@ -260,6 +362,8 @@ int main(int argc, char *argv[])
          "interleaver spread to start with");
    desc.add_options()("attempts,n", po::value<int>()->default_value(1000),
          "number of attempts before reducing spread");
+   desc.add_options()("threads,j", po::value<int>()->default_value(1),
+         "number of worker threads");
    po::variables_map vm;
    po::store(po::parse_command_line(argc, argv, desc), vm);
    po::notify(vm);
@@ -275,9 +379,11 @@ int main(int argc, char *argv[])
    const int tau = vm["tau"].as<int> ();
    int spread = vm["spread"].as<int> ();
    const int max_attempts = vm["attempts"].as<int> ();
+   const int threads = vm["threads"].as<int> ();
    // Main process
    libbase::int32u seed = 0;
-   myvector<int> lut = create_srandom(tau, spread, seed, max_attempts);
+   myvector<int> lut = create_srandom(tau, spread, seed, max_attempts,
+         threads);
    // Output
    const std::string fname = compose_filename(tau, spread, seed);
    std::ofstream file(fname.c_str());
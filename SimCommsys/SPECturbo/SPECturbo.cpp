@@ -81,6 +81,52 @@ const double std_result[] = {0.0924156, 0.993763, 0.073373, 0.894948,
       0.690988, 0.0622686, 0.679999, 0.0620079, 0.670621, 0.0619153, 0.666856,
       0.0618174, 0.662668};
 
+/*!
+ * \brief   Standard benchmark system, with the given component decoder
+ *
+ * The exact decoder, decoding whole blocks, gives the standard system;
+ * otherwise the turbo codec is upgraded to format version 4, selecting the
+ * log-domain decoder and/or the sliding window as required.
+ */
+std::string make_systemstring(const std::string& decoder, const int window,
+      const int warmup)
+   {
+   int realization = 0;
+   bool fixedpoint = false;
+   if (decoder == "exact")
+      {
+      if (window == 0)
+         return std_systemstring;
+      }
+   else if (decoder == "max-log-MAP")
+      realization = 1;
+   else if (decoder == "log-MAP")
+      realization = 2;
+   else if (decoder == "max-log-MAP-16")
+      {
+      realization = 1;
+      fixedpoint = true;
+      }
+   else if (decoder == "log-MAP-16")
+      {
+      realization = 2;
+      fixedpoint = true;
+      }
+   else
+      failwith("Unknown component decoder");
+   std::string s = std_systemstring;
+   const std::string oldver = "turbo<double>\n2   # format version\n";
+   const size_t pos = s.find(oldver);
+   assertalways(pos != std::string::npos);
+   s.replace(pos, oldver.length(), "turbo<double>\n4   # format version\n");
+   std::ostringstream sout;
+   sout << realization << "   # component decoder\n";
+   sout << int(fixedpoint) << "   # fixed-point?\n";
+   sout << window << "   # sliding window length\n";
+   sout << warmup << "   # sliding window warm-up length\n";
+   return s + sout.str();
+   }
+
 class mymontecarlo : public libcomm::montecarlo {
 protected:
    bool interrupt()
@@ -121,6 +167,18 @@ int main(int argc, char *argv[])
          "local"), "- 'local', for local-computation model\n"
       "- ':port', for server-mode, bound to given port\n"
       "- 'hostname:port', for client-mode connection");
+   desc.add_options()("threads,j", po::value<int>()->default_value(1),
+         "number of local worker threads (for local-computation model)");
+   desc.add_options()("decoder,d", po::value<std::string>()->default_value(
+         "exact"), "component decoder for standard system:\n"
+      "- 'exact', BCJR using double-precision (reference)\n"
+      "- 'max-log-MAP' or 'log-MAP', with float metrics\n"
+      "- 'max-log-MAP-16' or 'log-MAP-16', with fixed-point metrics");
+   desc.add_options()("window,w", po::value<int>()->default_value(0),
+         "sliding window length for standard system (exact decoder only; "
+            "0 to decode whole blocks)");
+   desc.add_options()("warmup", po::value<int>()->default_value(16),
+         "sliding window warm-up length for standard system");
    desc.add_options()("time,t", po::value<double>()->default_value(60),
          "benchmark duration in seconds");
    desc.add_options()("parameter,r", po::value<double>()->default_value(0.5),
@@ -146,13 +204,16 @@ int main(int argc, char *argv[])
    mymontecarlo estimator;
    estimator.enable(vm["endpoint"].as<std::string> (), vm["quiet"].as<bool> (),
          vm["priority"].as<int> ());
+   estimator.set_threads(vm["threads"].as<int> ());
    // Set up the estimator
    libcomm::experiment *system;
    if (vm.count("system-file"))
       system = libcomm::loadfromfile<libcomm::experiment>(vm["system-file"].as<
             std::string> ());
    else
-      system = libcomm::loadfromstring<libcomm::experiment>(std_systemstring);
+      system = libcomm::loadfromstring<libcomm::experiment>(make_systemstring(
+            vm["decoder"].as<std::string> (), vm["window"].as<int> (),
+            vm["warmup"].as<int> ()));
    estimator.bind(system);
    estimator.set_confidence(vm["confidence"].as<double> ());
    estimator.set_accuracy(vm["tolerance"].as<double> ());
@@ -198,6 +259,20 @@ int main(int argc, char *argv[])
                   - std_result[j]) / std_result[j] << "%)";
          cout << std::endl;
          }
+      // Summarize degradation of the selected decoder (final iteration SER)
+      if (!vm.count("system-file") && (vm["decoder"].as<std::string> ()
+            != "exact" || vm["window"].as<int> () > 0))
+         {
+         const int j = system->count() - 2;
+         const double delta = (estimate(j) - std_result[j]) / std_result[j];
+         cout << "Degradation (" << vm["decoder"].as<std::string> ();
+         if (vm["window"].as<int> () > 0)
+            cout << ", window " << vm["window"].as<int> () << "+"
+                  << vm["warmup"].as<int> ();
+         cout << ", " << system->result_description(j) << "): "
+               << setprecision(3) << 100 * delta << "% +/- " << 100
+               * tolerance(j) << "%" << std::endl;
+         }
 
       // Output timing statistics
       cout << std::endl;
@@ -23,10 +23,10 @@
  */
 
 #include "config.h"
-#include "randgen.h"
 #include "truerand.h"
 #include "serializer_libcomm.h"
 #include "experiment/binomial/commsys_simulator.h"
+#include "montecarlo.h"
 #include "cputimer.h"
 
 #include <boost/program_options.hpp>
@@ -57,17 +57,20 @@ libcomm::experiment *createsystem(const std::string& fname)
    return system;
    }
 
-void seed_experiment(libcomm::experiment *system, libbase::int32u seed)
+void seed_experiment(libcomm::experiment *system, const po::variables_map& vm)
    {
-   if (seed < 0)
+   libbase::int32u seed;
+   if (vm.count("seed"))
+      seed = vm["seed"].as<libbase::int32u> ();
+   else
       {
       libbase::truerand trng;
       seed = trng.ival();
       }
-   libbase::randgen prng;
-   prng.seed(seed);
-   system->seedfrom(prng);
-   cerr << "Seed: " << seed << std::endl;
+   const libbase::int32u stream = vm["stream"].as<libbase::int32u> ();
+   const libbase::int32u unit = vm["unit"].as<libbase::int32u> ();
+   libcomm::montecarlo::seed_experiment(system, seed, stream, unit);
+   cerr << "Key: " << seed << " " << stream << " " << unit << std::endl;
    }
 
 void display_event(libcomm::experiment *system)
@@ -91,6 +94,11 @@ void display_event(libcomm::experiment *system)
  * - $Revision: 6264 $
  * - $Date: 2011-11-18 17:58:59 +0000 (Fri, 18 Nov 2011) $
  * - $Author: jabriffa $
+ *
+ * Simulates the given system until an error event occurs, and displays it.
+ * The system is seeded from a key (seed, stream, unit), in the same way as
+ * by the Monte Carlo estimator; given the key printed by a simulation, any
+ * frame it computed can be replayed by giving its index within the key.
  */
 
 int main(int argc, char *argv[])
@@ -104,8 +112,15 @@ int main(int argc, char *argv[])
          "input file containing system description");
    desc.add_options()("parameter,p", po::value<double>(),
          "simulation parameter");
-   desc.add_options()("seed,s", po::value<int>()->default_value(-1),
-         "system initialization seed (random if -1)");
+   desc.add_options()("seed,s", po::value<libbase::int32u>(),
+         "run seed (random if not given)");
+   desc.add_options()("stream", po::value<libbase::int32u>()->default_value(0),
+         "stream number (slave or worker) of key");
+   desc.add_options()("unit", po::value<libbase::int32u>()->default_value(0),
+         "work unit number of key");
+   desc.add_options()("frame,f", po::value<int>(),
+         "replay the given frame (counting from zero) of the key, "
+         "instead of stopping at the first error event");
    po::variables_map vm;
    po::store(po::parse_command_line(argc, argv, desc), vm);
    po::notify(vm);
@@ -125,24 +140,33 @@ int main(int argc, char *argv[])
 
    // Initialise running values
    system->reset();
-   seed_experiment(system, vm["seed"].as<int> ());
+   seed_experiment(system, vm);
    cerr << "Simulating system at parameter = " << system->get_parameter()
          << std::endl;
-   // Simulate, waiting for an error event
+   // Simulate, waiting for an error event or the requested frame
+   const int frame = vm.count("frame") ? vm["frame"].as<int> () : -1;
    libbase::vector<double> result;
    do
       {
       cerr << "Simulating sample " << system->get_samplecount() << std::endl;
+      libbase::cputimer tsample("Sample timer");
       system->sample(result);
+      tsample.stop();
       system->accumulate(result);
 #if DEBUG>=2
       cerr << "Event for sample " << system->get_samplecount() << ":"
             << std::endl;
       display_event(system);
 #endif
-      } while (result.min() == 0);
-   cerr << "Event found after " << system->get_samplecount() << " samples"
-         << std::endl;
+      if (frame >= 0 && system->get_samplecount() > libbase::int64u(frame))
+         {
+         cerr << "Frame " << frame << " replayed in " << tsample << std::endl;
+         break;
+         }
+      } while (frame >= 0 || result.min() == 0);
+   if (frame < 0)
+      cerr << "Event found at frame " << system->get_samplecount() - 1
+            << std::endl;
    // Display results
    display_event(system);
 
@@ -26,6 +26,7 @@
 #include "serializer_libcomm.h"
 #include "experiment/binomial/commsys_simulator.h"
 #include "montecarlo.h"
+#include "algorithm/fba2.h"
 #include "masterslave.h"
 #include "cputimer.h"
 
@@ -151,6 +152,16 @@ int main(int argc, char *argv[])
          "local"), "- 'local', for local-computation model\n"
       "- ':port', for server-mode, bound to given port\n"
       "- 'hostname:port', for client-mode connection");
+   desc.add_options()("threads,j", po::value<int>()->default_value(1),
+         "number of local worker threads (for local-computation model)");
+   desc.add_options()("fba-threads", po::value<int>()->default_value(1),
+         "number of threads for each forward-backward decoding (BSID systems)");
+   desc.add_options()("batch", po::value<int>()->default_value(1),
+         "number of frames decoded together (1 for no batching)");
+   desc.add_options()("seed,s", po::value<libbase::int32u>(),
+         "run seed, for reproducible simulations (random if not given)");
+   desc.add_options()("sweep", po::bool_switch(),
+         "simulate all parameter values concurrently (server-mode only)");
    desc.add_options()("system-file,i", po::value<std::string>(),
          "input file containing system description");
    desc.add_options()("results-file,o", po::value<std::string>(),
@@ -182,6 +193,11 @@ int main(int argc, char *argv[])
    mymontecarlo estimator;
    estimator.enable(vm["endpoint"].as<std::string> (), vm["quiet"].as<bool> (),
          vm["priority"].as<int> ());
+   estimator.set_threads(vm["threads"].as<int> ());
+   if (vm.count("seed"))
+      estimator.set_seed(vm["seed"].as<libbase::int32u> ());
+   libcomm::fba2_threads::set(vm["fba-threads"].as<int> ());
+   libcomm::commsys_batch::set(vm["batch"].as<int> ());
 
    // If this is a server instance, check the remaining parameters
    if (vm.count("system-file") == 0 || vm.count("results-file") == 0
@@ -206,6 +222,19 @@ int main(int argc, char *argv[])
    estimator.set_confidence(vm["confidence"].as<double> ());
    estimator.set_accuracy(vm["tolerance"].as<double> ());
 
+   // Simulate all SNR values concurrently, if requested
+   if (vm["sweep"].as<bool> () && !estimator.isenabled())
+      cerr << "WARNING: --sweep needs server mode; simulating each parameter"
+            << " value in turn." << std::endl;
+   if (vm["sweep"].as<bool> () && estimator.isenabled())
+      {
+      cerr << "Simulating system at " << pset.size() << " parameter values"
+            << std::endl;
+      estimator.sweep(pset, min_error);
+      cerr << "Statistics: " << estimator.get_timer() << std::endl;
+      return 0;
+      }
+
    // Work out the following for every SNR value required
    for (int i = 0; i < pset.size(); i++)
       {
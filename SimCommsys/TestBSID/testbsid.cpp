@@ -27,8 +27,11 @@
 #include "channel/bsid.h"
 #include "randgen.h"
 #include "rvstatistics.h"
+#include "levenshtein.h"
+#include "hamming.h"
 
 #include <iostream>
+#include <vector>
 
 namespace testbsid {
 
@@ -114,6 +117,88 @@ void testtransmission(int tau, double p, bool ins, bool del, bool sub, bool src)
    cout << std::endl;
    }
 
+/*!
+ * \brief Corrupt a sequence with random insertions, deletions and substitutions
+ * \param prng Random generator
+ * \param s    Source sequence
+ * \param q    Alphabet size
+ * \param p    Probability of each type of error, at each position
+ */
+vector<int> corrupt(randgen& prng, const vector<int>& s, int q, double p)
+   {
+   std::vector<int> t;
+   for (int i = 0; i < s.size(); i++)
+      {
+      while (prng.fval_halfopen() < p)
+         t.push_back(prng.ival(q));
+      if (prng.fval_halfopen() < p)
+         continue;
+      if (prng.fval_halfopen() < p)
+         t.push_back((s(i) + 1 + prng.ival(q - 1)) % q);
+      else
+         t.push_back(s(i));
+      }
+   vector<int> result(int(t.size()));
+   for (int i = 0; i < result.size(); i++)
+      result(i) = t[i];
+   return result;
+   }
+
+/*!
+ * \brief Compare the bit-parallel Levenshtein distance with the reference
+ *
+ * Sequence pairs are generated at random, over binary and larger alphabets,
+ * with lengths on either side of the word boundaries as well as arbitrary
+ * lengths. The full distance is checked for all pairs; for pairs of equal
+ * length, the distance banded by the Hamming distance is also checked, as is
+ * the distance with a smaller bound (which must then exceed the bound).
+ */
+void testlevenshtein()
+   {
+   const int lengths[] = { 1, 2, 63, 64, 65, 127, 128, 129, 191, 192, 193 };
+   const int nlengths = sizeof(lengths) / sizeof(lengths[0]);
+   const int pairs = 20000;
+   randgen prng;
+   prng.seed(0);
+   libbase::levenshtein_bitparallel<int> engine;
+   int banded = 0;
+   for (int n = 0; n < pairs; n++)
+      {
+      // choose alphabet, length and error rate
+      const int q = (n % 2) ? 2 : 2 + prng.ival(14);
+      const int m = (n % 3) ? lengths[prng.ival(nlengths)] : prng.ival(301);
+      const double p = 0.2 * prng.fval_halfopen();
+      // create sequence pair
+      vector<int> s(m);
+      for (int i = 0; i < m; i++)
+         s(i) = prng.ival(q);
+      vector<int> t = corrupt(prng, s, q, p);
+      // make every other pair of equal length, for banded test
+      if (n % 2 == 0 && t.size() != m)
+         {
+         vector<int> u(m);
+         for (int i = 0; i < m; i++)
+            u(i) = (i < t.size()) ? t(i) : prng.ival(q);
+         t = u;
+         }
+      // check full distance
+      const int ld = libbase::levenshtein(s, t);
+      assertalways(engine.distance(s, t) == ld);
+      assertalways(engine.distance(t, s) == ld);
+      // check banded distance
+      if (t.size() == m)
+         {
+         const int hd = libbase::hamming(s, t);
+         assertalways(engine.distance(s, t, hd) == ld);
+         if (ld > 0)
+            assertalways(engine.distance(s, t, ld - 1) > ld - 1);
+         banded++;
+         }
+      }
+   cout << "Bit-parallel Levenshtein distance matches reference on " << pairs
+         << " pairs (" << banded << " banded)." << std::endl << std::endl;
+   }
+
 /*!
  * \brief   Test program for BSID channel
  * \author  Johann Briffa
@@ -128,6 +213,8 @@ int main(int argc, char *argv[])
    {
    // create a test sequence and test BSID transmission
    visualtest();
+   // test the Levenshtein distance used for BSID results
+   testlevenshtein();
    // test insertion-only channels
    testtransmission(1000, 0.01, true, false, false, 0);
    testtransmission(1000, 0.25, true, false, false, 0);
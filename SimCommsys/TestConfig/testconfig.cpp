@@ -25,6 +25,10 @@
 #include "config.h"
 #include "matrix.h"
 #include "multi_array.h"
+#include "logrealfast_v.h"
+#include "randgen.h"
+#include "philox.h"
+#include "cputimer.h"
 
 #include <boost/lambda/lambda.hpp>
 #include <iterator>
@@ -37,6 +41,8 @@ namespace testconfig {
 
 using libbase::vector;
 using libbase::matrix;
+using libbase::logrealfast;
+using libbase::logrealfast_v;
 using std::cout;
 
 void print_whitespace_test()
@@ -315,6 +321,98 @@ void testboost_iterators()
    display_array(A);
    }
 
+void benchmark_logrealfast()
+   {
+   cout << std::endl << "Log-Domain Addition (logrealfast):" << std::endl
+         << std::endl;
+   const int n = 1 << 12;
+   const int repeats = 1 << 10;
+   // operands with log-differences spread beyond the table range
+   libbase::randgen r;
+   r.seed(0);
+   vector<logrealfast> a(n), b(n), c(n), d(n);
+   for (int i = 0; i < n; i++)
+      {
+      a(i) = exp(-16 * r.fval_closed());
+      b(i) = exp(-16 * r.fval_closed());
+      }
+   // scalar addition, using the main LUT
+   libbase::cputimer t;
+   for (int loop = 0; loop < repeats; loop++)
+      for (int i = 0; i < n; i++)
+         {
+         c(i) = a(i);
+         c(i) += b(i);
+         }
+   t.stop();
+   const double t_lut = t.elapsed();
+   cout << "Scalar (LUT): " << t << ", " << n * double(repeats) / t_lut
+         / 1e6 << " Madd/s" << std::endl;
+   // vector addition, using the small table
+   t.start();
+   for (int loop = 0; loop < repeats; loop++)
+      for (int i = 0; i < n; i += 4)
+         {
+         logrealfast_v<4> x, y;
+         x.load(&a(i));
+         y.load(&b(i));
+         x += y;
+         x.store(&d(i));
+         }
+   t.stop();
+   const double t_vec = t.elapsed();
+   cout << "Vector (small table): " << t << ", " << n * double(repeats)
+         / t_vec / 1e6 << " Madd/s" << std::endl;
+   // accuracy, as the error in the log-domain
+   double e_lut = 0, e_vec = 0;
+   for (int i = 0; i < n; i++)
+      {
+      const double exact = log(double(a(i)) + double(b(i)));
+      e_lut = std::max(e_lut, fabs(log(double(c(i))) - exact));
+      e_vec = std::max(e_vec, fabs(log(double(d(i))) - exact));
+      }
+   cout << "Maximum error: LUT = " << e_lut << ", small table = " << e_vec
+         << std::endl;
+   assertalways(e_vec <= e_lut);
+   }
+
+void testphilox()
+   {
+   cout << std::endl << "Philox Random Generator:" << std::endl << std::endl;
+   // known-answer test: first block for key (0,0) and counter zero
+   const libbase::int32u kat[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+         0x9b00dbd8 };
+   libbase::philox g;
+   g.seed(0);
+   for (int i = 0; i < 4; i++)
+      {
+      const libbase::int32u x = g.ival();
+      cout << std::hex << x << std::dec << (i < 3 ? " " : "\n");
+      assertalways(x == kat[i]);
+      }
+   // bulk fill against scalar values, at odd offsets and lengths
+   const int lengths[] = { 1, 3, 4, 5, 15, 16, 17, 63, 65, 257 };
+   const int nlengths = sizeof(lengths) / sizeof(lengths[0]);
+   for (int offset = 0; offset < 9; offset++)
+      for (int l = 0; l < nlengths; l++)
+         {
+         const int n = lengths[l];
+         libbase::philox bulk, scalar;
+         bulk.seed(7, 3, 1);
+         scalar.seed(7, 3, 1);
+         for (int i = 0; i < offset; i++)
+            assertalways(bulk.ival() == scalar.ival());
+         vector<libbase::int32u> x(n);
+         bulk.ival(x);
+         for (int i = 0; i < n; i++)
+            assertalways(x(i) == scalar.ival());
+         // check that scalar values continue from the same point
+         for (int i = 0; i < 5; i++)
+            assertalways(bulk.ival() == scalar.ival());
+         }
+   cout << "Bulk fill matches scalar output." << std::endl;
+   }
+
 /*!
  * \brief   Test program for various base functions and facilities
  * \author  Johann Briffa
@@ -338,6 +436,8 @@ int main(int argc, char *argv[])
    testboost_foreach("1 2 3\n");
    testboost_array();
    testboost_iterators();
+   benchmark_logrealfast();
+   testphilox();
    return 0;
    }
 
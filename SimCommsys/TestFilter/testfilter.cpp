@@ -0,0 +1,152 @@
+/*!
+ * \file
+ *
+ * Copyright (c) 2010 Johann A. Briffa
+ *
+ * This file is part of SimCommSys.
+ *
+ * SimCommSys is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * SimCommSys is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SimCommSys.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * \section svn Version Control
+ * - $Id$
+ */
+
+#include "filter/slidingwindow.h"
+#include "filter/variancefilter.h"
+#include "rvstatistics.h"
+#include "randgen.h"
+#include "matrix.h"
+
+#include <limits>
+#include <cmath>
+#include <iostream>
+
+namespace testfilter {
+
+using libbase::matrix;
+using libbase::randgen;
+using libbase::rvstatistics;
+using std::cout;
+
+//! Creates a random image, with pixels in [offset, offset+256)
+template <class T>
+matrix<T> makeimage(randgen& prng, const int M, const int N,
+      const double offset)
+   {
+   matrix<T> in(M, N);
+   for (int i = 0; i < M; i++)
+      for (int j = 0; j < N; j++)
+         in(i, j) = T(offset + 256 * prng.fval_halfopen());
+   return in;
+   }
+
+/*!
+ * \brief Compare window statistics with those of the direct computation
+ * \param in Input image
+ * \param d Greatest distance from current pixel in neighbourhood
+ * \return Number of windows compared
+ *
+ * For each pixel, the neighbourhood statistics are computed directly with an
+ * rvstatistics object, as the filters did before using boxsum. These are
+ * compared with the boxsum results, and with the output of variancefilter.
+ * Results must be identical for integer images; otherwise they must agree
+ * to within rounding on the scale of the mean square, which is the quantity
+ * from which the variance is obtained.
+ */
+template <class T>
+int comparewindows(const matrix<T>& in, const int d)
+   {
+   const int M = in.size().rows();
+   const int N = in.size().cols();
+   const double eps = std::numeric_limits<T>::epsilon();
+   const double tol = std::numeric_limits<T>::is_integer ? 0 : 1e-12;
+   // filter output
+   libimage::variancefilter<T> filter(d);
+   matrix<T> out;
+   filter.process(in, out);
+   // box sums, for all rows in sequence
+   libimage::boxsum<T> b(in, d);
+   b.seek(0);
+   for (int i = 0; i < M; i++)
+      {
+      if (i > 0)
+         b.next();
+      for (int j = 0; j < N; j++)
+         {
+         rvstatistics r;
+         for (int ii = std::max(i - d, 0); ii <= std::min(i + d, M - 1); ii++)
+            for (int jj = std::max(j - d, 0); jj <= std::min(j + d, N - 1); jj++)
+               r.insert(double(in(ii, jj)));
+         const double scale = r.mean() * r.mean() + r.var();
+         assertalways(b.count(j) == int(r.count()));
+         assertalways(std::abs(b.mean(j) - r.mean()) <= tol * std::abs(r.mean()));
+         assertalways(std::abs(b.var(j) - r.var()) <= tol * scale);
+         assertalways(std::abs(double(out(i, j)) - double(T(r.var()))) <= tol
+               * scale + eps * r.var());
+         }
+      }
+   return M * N;
+   }
+
+//! Compare window statistics for a range of image sizes and window sizes
+template <class T>
+void testboxsum(const char *name, const double offset)
+   {
+   const int sizes[][2] = { { 1, 1 }, { 5, 3 }, { 3, 17 }, { 64, 80 }, { 150,
+         400 } };
+   const int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+   const int ds[] = { 0, 1, 3, 7 };
+   const int nds = sizeof(ds) / sizeof(ds[0]);
+   randgen prng;
+   prng.seed(0);
+   int windows = 0;
+   for (int k = 0; k < nsizes; k++)
+      {
+      const matrix<T> in = makeimage<T> (prng, sizes[k][0], sizes[k][1],
+            offset);
+      for (int n = 0; n < nds; n++)
+         windows += comparewindows(in, ds[n]);
+      }
+   cout << "Box sums (" << name << ", offset " << offset
+         << ") match direct statistics on " << windows << " windows."
+         << std::endl;
+   }
+
+/*!
+ * \brief   Test program for image filter helpers
+ * \author  Johann Briffa
+ *
+ * \section svn Version Control
+ * - $Revision$
+ * - $Date$
+ * - $Author$
+ */
+
+int main(int argc, char *argv[])
+   {
+   // integer images must give identical results
+   testboxsum<int> ("int", 0);
+   // floating-point images, including with a large offset to check precision
+   testboxsum<float> ("float", 0);
+   testboxsum<double> ("double", 0);
+   testboxsum<double> ("double", 1e6);
+   return 0;
+   }
+
+} // end namespace
+
+int main(int argc, char *argv[])
+   {
+   return testfilter::main(argc, argv);
+   }
@@ -26,6 +26,7 @@
 #include "gf_fast.h"
 #include "bitfield.h"
 #include "matrix.h"
+#include "vector.h"
 #include "cputimer.h"
 #include <iostream>
 
@@ -132,6 +133,100 @@ void TestMulDiv()
       }
    }
 
+/*!
+ * \brief Reference multiplication, by shift-and-add of polynomials
+ */
+template <int m, int poly>
+int MultiplySerial(int a, int b)
+   {
+   int r = 0;
+   for (int i = 0; i < m; i++, b >>= 1)
+      {
+      if (b & 1)
+         r ^= a;
+      a <<= 1;
+      if (a & (1 << m))
+         a ^= poly;
+      }
+   return r;
+   }
+
+template <int m, int poly>
+void TestBulkOps()
+   {
+   typedef gf<m, poly> GF;
+   const int q = GF::elements();
+   cout << std::endl << "GF(" << m << ",0x" << hex << poly << dec
+         << ") table-driven and bulk operations:" << std::endl;
+   // check element multiplication and inverse against the reference
+   for (int a = 0; a < q; a++)
+      for (int b = 0; b < q; b++)
+         {
+         const int r = MultiplySerial<m, poly> (a, b);
+         assertalways(GF(a) * GF(b) == r);
+         }
+   for (int a = 1; a < q; a++)
+      assertalways(GF(a).inverse() * GF(a) == 1);
+   // set up vectors (with a length that leaves a partial vector block)
+   const int n = 1021;
+   libbase::vector<GF> x(n), y(n), z(n);
+   for (int i = 0; i < n; i++)
+      {
+      x(i) = (i * 37 + 11) % q;
+      y(i) = (i * 53 + 5) % q;
+      }
+   // check bulk operations against element-wise ones, with and without
+   // vector instructions
+   const bool simd = GF::simd_supported();
+   cout << "Vector multiply-add: " << (simd ? "yes" : "no") << std::endl;
+   for (int v = 0; v <= int(simd); v++)
+      {
+      GF::set_simd(v != 0);
+      for (int a = 0; a < q; a++)
+         {
+         z = y;
+         GF::multiply_add(&z(0), GF(a), &x(0), n);
+         for (int i = 0; i < n; i++)
+            assertalways(z(i) == y(i) + GF(a) * x(i));
+         }
+      }
+   z = y;
+   GF::multiply(&z(0), &x(0), n);
+   GF s = 0;
+   for (int i = 0; i < n; i++)
+      {
+      assertalways(z(i) == y(i) * x(i));
+      s += y(i) * x(i);
+      }
+   assertalways(GF::dot(&y(0), &x(0), n) == s);
+   // time element-wise and bulk multiply-accumulate
+   const int repeats = 1000;
+   const GF a = q - 1;
+   cputimer t1;
+   for (int loop = 0; loop < repeats; loop++)
+      for (int i = 0; i < n; i++)
+         z(i) += a * x(i);
+   t1.stop();
+   cout << repeats << " x " << n << " multiply-add (element-wise) took " << t1;
+   GF::set_simd(false);
+   t1.start();
+   for (int loop = 0; loop < repeats; loop++)
+      GF::multiply_add(&z(0), a, &x(0), n);
+   t1.stop();
+   cout << ", (bulk) took " << t1;
+   if (simd)
+      {
+      GF::set_simd(true);
+      t1.start();
+      for (int loop = 0; loop < repeats; loop++)
+         GF::multiply_add(&z(0), a, &x(0), n);
+      t1.stop();
+      cout << ", (vector) took " << t1;
+      }
+   GF::set_simd(true);
+   cout << std::endl;
+   }
+
 void TestGenPowerGF2()
    {
    cout << std::endl << "Binary generator matrix power sequence:" << std::endl;
@@ -1361,6 +1456,11 @@ int main(int argc, char *argv[])
    TestMulDiv<3, 0xB> ();
    TestGenPowerGF2();
    TestGenPowerGF8();
+   TestBulkOps<1, 0x3> ();
+   TestBulkOps<4, 0x13> ();
+   TestBulkOps<8, 0x11D> ();
+   TestBulkOps<8, 0x11B> ();
+   TestBulkOps<10, 0x409> ();
    // TODO: templatize tests for gf_fast
    TestFastGF2();
    TestFastGF4();
@@ -25,8 +25,11 @@
 #include "fsm/rscc.h"
 #include "fsm/grscc.h"
 #include "fsm/dvbcrsc.h"
+#include "bcjr.h"
 #include "gf.h"
+#include "logfixed.h"
 #include "randgen.h"
+#include "cputimer.h"
 #include <iostream>
 
 namespace testgrscc {
@@ -43,6 +46,9 @@ using libbase::bitfield;
 using libcomm::rscc;
 using libcomm::fsm;
 using libcomm::dvbcrsc;
+using libcomm::bcjr;
+using libbase::logfixed16;
+using libbase::logfixed8;
 
 // Define types for binary and for GF(2^4): m(x) = 1 { 0011 }
 typedef gf<1, 0x3> GF2;
@@ -269,6 +275,167 @@ void TestCirculation()
    TestCirculationUsage(dvbcc, 7);
    }
 
+/*!
+ * \brief   Normalized BCJR decoder, starting at state zero with an open end
+ */
+template <class real>
+class testbcjr : public bcjr<real, double, true> {
+public:
+   testbcjr(fsm& encoder, const int tau) :
+      bcjr<real, double, true> (encoder, tau)
+      {
+      this->setstart(0);
+      this->setend();
+      }
+};
+
+/*!
+ * \brief Decode with the given metric type and compare with 'double' results
+ * \param cc Encoder
+ * \param R Channel likelihoods, as given to the decoder
+ * \param ri_ref A-posteriori input probabilities from the 'double' decoder
+ * \param t_ref Time taken by the 'double' decoder for 'repeats' decodings
+ * \param repeats Number of decodings to time
+ * \param name Name of metric type
+ * \param tol Largest acceptable difference in posterior probability of a
+ * one, after normalization over the input values
+ */
+template <class real>
+void CompareBCJR(fsm& cc, const matrix<double>& R,
+      const matrix<double>& ri_ref, const double t_ref, const int repeats,
+      const char *name, const double tol)
+   {
+   const int tau = R.size().rows();
+   testbcjr<real> dec(cc, tau);
+   matrix<double> ri, ro;
+   libbase::cputimer t;
+   for (int k = 0; k < repeats; k++)
+      dec.decode(R, ri, ro);
+   t.stop();
+   double e = 0;
+   int diff = 0;
+   for (int i = 0; i < tau; i++)
+      {
+      const double p = ri(i, 1) / (ri(i, 0) + ri(i, 1));
+      const double p_ref = ri_ref(i, 1) / (ri_ref(i, 0) + ri_ref(i, 1));
+      e = std::max(e, fabs(p - p_ref));
+      if ((p > 0.5) != (p_ref > 0.5))
+         diff++;
+      }
+   cout << name << ":\t" << diff << " decisions differ, largest difference "
+         << e << ", time relative to double = " << t.elapsed() / t_ref
+         << std::endl;
+   assertalways(diff == 0);
+   assertalways(e <= tol);
+   }
+
+/*!
+ * \brief Encode a random sequence and work out the channel likelihoods
+ * \param cc Encoder
+ * \param tau Sequence length in time-steps
+ * \param sigma Noise standard deviation, for BPSK on an AWGN channel
+ * \param r Random generator for the source sequence and the noise
+ */
+matrix<double> GetLikelihoods(fsm& cc, const int tau, const double sigma,
+      libbase::randgen& r)
+   {
+   const int N = cc.num_output_combinations();
+   const int n = cc.num_outputs();
+   matrix<double> R(tau, N);
+   cc.reset();
+   for (int t = 0; t < tau; t++)
+      {
+      vector<int> ip = cc.convert_input(r.ival(2));
+      const vector<int> op = cc.step(ip);
+      vector<double> y(n);
+      for (int j = 0; j < n; j++)
+         y(j) = (op(j) ? -1 : 1) + r.gval(sigma);
+      for (int X = 0; X < N; X++)
+         {
+         const vector<int> x = cc.convert_output(X);
+         double p = 1;
+         for (int j = 0; j < n; j++)
+            {
+            const double d = y(j) - (x(j) ? -1 : 1);
+            p *= exp(-d * d / (2 * sigma * sigma));
+            }
+         R(t, X) = p;
+         }
+      }
+   return R;
+   }
+
+void TestFixedPointBCJR()
+   {
+   cout << std::endl << "Test fixed-point BCJR on a 200-step RSC trellis:"
+         << std::endl;
+   rscc cc(GetGeneratorBinary());
+   const int tau = 200;
+   libbase::randgen r;
+   r.seed(0);
+   const matrix<double> R = GetLikelihoods(cc, tau, 0.8, r);
+   // reference decoding
+   const int repeats = 200;
+   testbcjr<double> dec(cc, tau);
+   matrix<double> ri, ro;
+   libbase::cputimer t;
+   for (int k = 0; k < repeats; k++)
+      dec.decode(R, ri, ro);
+   t.stop();
+   // fixed-point decodings
+   CompareBCJR<logfixed16> (cc, R, ri, t.elapsed(), repeats, "logfixed16",
+         0.05);
+   CompareBCJR<logfixed8> (cc, R, ri, t.elapsed(), repeats, "logfixed8", 0.25);
+   }
+
+/*!
+ * \brief Decode a set of frames together, and compare with separate decoding
+ * \param cc Encoder
+ * \param frames Number of frames
+ * \param name Name of metric type
+ *
+ * Results must be identical, as the arithmetic for each frame is the same.
+ */
+template <class real>
+void CompareBatchBCJR(fsm& cc, const int frames, const char *name)
+   {
+   const int tau = 200;
+   const int K = cc.num_input_combinations();
+   libbase::randgen r;
+   r.seed(frames);
+   vector<matrix<double> > R(frames), app(frames), ri(frames), ri_batch;
+   for (int f = 0; f < frames; f++)
+      {
+      R(f) = GetLikelihoods(cc, tau, 0.8, r);
+      app(f).init(tau, K);
+      for (int t = 0; t < tau; t++)
+         for (int i = 0; i < K; i++)
+            app(f)(t, i) = r.fval_closed();
+      }
+   testbcjr<real> dec(cc, tau);
+   for (int f = 0; f < frames; f++)
+      dec.fdecode(R(f), app(f), ri(f));
+   dec.fdecode(R, app, ri_batch);
+   int diff = 0;
+   for (int f = 0; f < frames; f++)
+      if (!ri_batch(f).isequalto(ri(f)))
+         diff++;
+   cout << name << ", " << frames << " frames:\t" << diff
+         << " frames differ" << std::endl;
+   assertalways(diff == 0);
+   }
+
+void TestBatchBCJR()
+   {
+   cout << std::endl << "Test multi-frame BCJR on a 200-step RSC trellis:"
+         << std::endl;
+   rscc cc(GetGeneratorBinary());
+   CompareBatchBCJR<double> (cc, 8, "double");
+   CompareBatchBCJR<double> (cc, 5, "double");
+   CompareBatchBCJR<float> (cc, 16, "float");
+   CompareBatchBCJR<float> (cc, 3, "float");
+   }
+
 /*!
  * \brief   Test program for GRSCC class
  * \author  Johann Briffa
@@ -284,6 +451,8 @@ int main(int argc, char *argv[])
    TestCreation();
    CompareCodes();
    TestCirculation();
+   TestFixedPointBCJR();
+   TestBatchBCJR();
    return 0;
    }
 
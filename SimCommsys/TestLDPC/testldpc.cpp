@@ -35,6 +35,7 @@
 #include "linear_code_utils.h"
 #include "randgen.h"
 #include "logrealfast.h"
+#include "cputimer.h"
 #include <fstream>
 
 using std::cerr;
@@ -91,6 +92,54 @@ void compute_conv(array1d_t& conv_out, int pos1, int pos2)
       }
    }
 
+/*!
+ * \brief Compare the Hadamard transform used by the SPA against the recursive
+ * reference version above, for correctness and speed
+ */
+template <class GF_q>
+void benchmark_fwht(const int repeats)
+   {
+   const int q = GF_q::elements();
+   randgen r;
+   r.seed(0);
+   array1d_t ref(q);
+   for (int i = 0; i < q; i++)
+      ref(i) = r.fval_closed();
+   array1d_t fast(ref);
+   compute_conv(ref, 0, q - 1);
+   sum_prod_alg_gdl<GF_q, double>::compute_convs(&fast(0));
+   for (int i = 0; i < q; i++)
+      assertalways(std::abs(ref(i) - fast(i)) < 1e-12);
+
+   libbase::cputimer t1;
+   cout << "q=" << q << ": " << repeats << " transforms (recursive) took ";
+   t1.start();
+   for (int loop = 0; loop < repeats; loop++)
+      compute_conv(ref, 0, q - 1);
+   t1.stop();
+   cout << t1;
+   cout << ", (iterative) took ";
+   t1.start();
+   for (int loop = 0; loop < repeats; loop++)
+      sum_prod_alg_gdl<GF_q, double>::compute_convs(&fast(0));
+   t1.stop();
+   cout << t1 << std::endl;
+   }
+
+void benchmark_fwht()
+   {
+   const int work = 1 << 24;
+   cout << "Fast Hadamard transform micro-benchmark:" << std::endl;
+   benchmark_fwht<gf<1, 0x3> > (work / 2);
+   benchmark_fwht<gf<2, 0x7> > (work / 4);
+   benchmark_fwht<gf<3, 0xB> > (work / 8);
+   benchmark_fwht<gf<4, 0x13> > (work / 16);
+   benchmark_fwht<gf<5, 0x25> > (work / 32);
+   benchmark_fwht<gf<6, 0x43> > (work / 64);
+   benchmark_fwht<gf<7, 0x89> > (work / 128);
+   benchmark_fwht<gf<8, 0x11D> > (work / 256);
+   }
+
 void compute_dual()
    {
    matrix<gf<1, 0x3> > test;
@@ -409,6 +458,11 @@ void test_cc_code()
 
 int main(int argc, char *argv[])
    {
+   if (argc > 1 && string(argv[1]) == "--fwht")
+      {
+      benchmark_fwht();
+      return 0;
+      }
    test_ra_code();
    return 0;
    //test_cc_code();